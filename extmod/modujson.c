@@ -25,15 +25,108 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "py/objlist.h"
-#include "py/objstringio.h"
+#include "py/objstr.h"
 #include "py/parsenum.h"
 #include "py/runtime.h"
 #include "py/stream.h"
 
 #if MICROPY_PY_UJSON
 
+// dump() renders into this small buffer and writes it to the stream each
+// time it fills, so the encoded text never has to be held in the heap.
+#define UJSON_DUMP_BUF_SIZE (64)
+
+typedef struct _ujson_dump_t {
+    mp_obj_t stream;
+    size_t len;
+    char buf[UJSON_DUMP_BUF_SIZE];
+} ujson_dump_t;
+
+STATIC void ujson_dump_flush(ujson_dump_t *d) {
+    if (d->len != 0) {
+        mp_stream_write(d->stream, d->buf, d->len, MP_STREAM_RW_WRITE);
+        d->len = 0;
+    }
+}
+
+STATIC void ujson_dump_strn(void *data, const char *str, size_t len) {
+    ujson_dump_t *d = data;
+    if (d->len + len > UJSON_DUMP_BUF_SIZE) {
+        ujson_dump_flush(d);
+        if (len >= UJSON_DUMP_BUF_SIZE) {
+            mp_stream_write(d->stream, str, len, MP_STREAM_RW_WRITE);
+            return;
+        }
+    }
+    memcpy(d->buf + d->len, str, len);
+    d->len += len;
+}
+
+#if MICROPY_PY_UJSON_SEPARATORS
+
+// The separators keyword is a (item_separator, key_separator) pair as in
+// CPython, e.g. (',', ':') for the most compact output.
+STATIC void ujson_parse_separators(mp_print_ext_t *print_ext, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, size_t n_pos) {
+    enum { ARG_separators };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_separators, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - n_pos, pos_args + n_pos, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (args[ARG_separators].u_obj == mp_const_none) {
+        print_ext->item_separator = ", ";
+        print_ext->key_separator = ": ";
+    } else {
+        mp_obj_t *items;
+        mp_obj_get_array_fixed_n(args[ARG_separators].u_obj, 2, &items);
+        print_ext->item_separator = mp_obj_str_get_str(items[0]);
+        print_ext->key_separator = mp_obj_str_get_str(items[1]);
+    }
+}
+
+STATIC mp_obj_t mod_ujson_dump(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    mp_get_stream_raise(pos_args[1], MP_STREAM_OP_WRITE);
+    ujson_dump_t d;
+    d.stream = pos_args[1];
+    d.len = 0;
+    mp_print_ext_t print_ext;
+    ujson_parse_separators(&print_ext, n_args, pos_args, kw_args, 2);
+    print_ext.base.data = &d;
+    print_ext.base.print_strn = ujson_dump_strn;
+    mp_obj_print_helper(&print_ext.base, pos_args[0], PRINT_JSON);
+    ujson_dump_flush(&d);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_dump_obj, 2, mod_ujson_dump);
+
+STATIC mp_obj_t mod_ujson_dumps(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    vstr_t vstr;
+    mp_print_ext_t print_ext;
+    ujson_parse_separators(&print_ext, n_args, pos_args, kw_args, 1);
+    vstr_init_print(&vstr, 8, &print_ext.base);
+    mp_obj_print_helper(&print_ext.base, pos_args[0], PRINT_JSON);
+    return mp_obj_new_str_from_vstr(&mp_type_str, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_dumps_obj, 1, mod_ujson_dumps);
+
+#else
+
+STATIC mp_obj_t mod_ujson_dump(mp_obj_t obj, mp_obj_t stream) {
+    mp_get_stream_raise(stream, MP_STREAM_OP_WRITE);
+    ujson_dump_t d;
+    d.stream = stream;
+    d.len = 0;
+    mp_print_t print = {&d, ujson_dump_strn};
+    mp_obj_print_helper(&print, obj, PRINT_JSON);
+    ujson_dump_flush(&d);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_ujson_dump_obj, mod_ujson_dump);
+
 STATIC mp_obj_t mod_ujson_dumps(mp_obj_t obj) {
     vstr_t vstr;
     mp_print_t print;
@@ -43,6 +136,8 @@ STATIC mp_obj_t mod_ujson_dumps(mp_obj_t obj) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_dumps_obj, mod_ujson_dumps);
 
+#endif
+
 // The function below implements a simple non-recursive JSON parser.
 //
 // The JSON specification is at http://www.ietf.org/rfc/rfc4627.txt
@@ -56,48 +151,88 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_dumps_obj, mod_ujson_dumps);
 // strings).  It does 1 pass over the input stream.  It tries to be fast and
 // small in code size, while not using more RAM than necessary.
 
+// Input is read from the stream in blocks of this size, so the parser makes
+// one stream call per block rather than one per character.
+#define UJSON_LOAD_BUF_SIZE (128)
+
 typedef struct _ujson_stream_t {
     mp_obj_t stream_obj;
     mp_uint_t (*read)(mp_obj_t obj, void *buf, mp_uint_t size, int *errcode);
+    const byte *pos; // next unread char, up to end
+    const byte *end;
     int errcode;
     byte cur;
+    byte buf[UJSON_LOAD_BUF_SIZE];
 } ujson_stream_t;
 
 #define S_EOF (0) // null is not allowed in json stream so is ok as EOF marker
-#define S_END(s) ((s).cur == S_EOF)
-#define S_CUR(s) ((s).cur)
-#define S_NEXT(s) (ujson_stream_next(&(s)))
-
-STATIC byte ujson_stream_next(ujson_stream_t *s) {
-    mp_uint_t ret = s->read(s->stream_obj, &s->cur, 1, &s->errcode);
-    if (s->errcode != 0) {
-        mp_raise_OSError(s->errcode);
+#define S_END(s) ((s)->cur == S_EOF)
+#define S_CUR(s) ((s)->cur)
+#define S_NEXT(s) (ujson_stream_next(s))
+
+// A str or bytes object is parsed in place; anything else must be a stream.
+STATIC void ujson_stream_init(ujson_stream_t *s, mp_obj_t obj) {
+    s->stream_obj = obj;
+    if (MP_OBJ_IS_STR_OR_BYTES(obj)) {
+        size_t len;
+        s->pos = (const byte*)mp_obj_str_get_data(obj, &len);
+        s->end = s->pos + len;
+        s->read = NULL;
+    } else {
+        const mp_stream_p_t *stream_p = mp_get_stream_raise(obj, MP_STREAM_OP_READ);
+        s->pos = s->end = s->buf;
+        s->read = stream_p->read;
+    }
+    s->errcode = 0;
+    s->cur = 0;
+}
+
+STATIC byte ujson_stream_fill(ujson_stream_t *s) {
+    mp_uint_t ret = 0;
+    if (s->read != NULL) {
+        ret = s->read(s->stream_obj, s->buf, UJSON_LOAD_BUF_SIZE, &s->errcode);
+        if (ret == MP_STREAM_ERROR) {
+            mp_raise_OSError(s->errcode);
+        }
     }
     if (ret == 0) {
+        s->read = NULL;
         s->cur = S_EOF;
+        return S_EOF;
     }
-    return s->cur;
+    s->pos = s->buf + 1;
+    s->end = s->buf + ret;
+    return s->cur = s->buf[0];
 }
 
-STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
-    const mp_stream_p_t *stream_p = mp_get_stream_raise(stream_obj, MP_STREAM_OP_READ);
-    ujson_stream_t s = {stream_obj, stream_p->read, 0, 0};
-    vstr_t vstr;
-    vstr_init(&vstr, 8);
-    mp_obj_list_t stack; // we use a list as a simple stack for nested JSON
-    stack.len = 0;
-    stack.items = NULL;
-    mp_obj_t stack_top = MP_OBJ_NULL;
-    mp_obj_type_t *stack_top_type = NULL;
-    mp_obj_t stack_key = MP_OBJ_NULL;
-    S_NEXT(s);
+static inline byte ujson_stream_next(ujson_stream_t *s) {
+    if (s->pos < s->end) {
+        return s->cur = *s->pos++;
+    }
+    return ujson_stream_fill(s);
+}
+
+enum {
+    UJSON_TOK_EOF,
+    UJSON_TOK_VALUE,
+    UJSON_TOK_START_LIST,
+    UJSON_TOK_START_DICT,
+    UJSON_TOK_END_LIST,
+    UJSON_TOK_END_DICT,
+};
+
+STATIC NORETURN void ujson_syntax_error(void) {
+    mp_raise_ValueError("syntax error in JSON");
+}
+
+// Scan the next token.  Primitives (null, false, true, numbers, strings) are
+// returned as UJSON_TOK_VALUE with the object in *value.  vstr is scratch
+// space for building strings and numbers.
+STATIC int ujson_next_token(ujson_stream_t *s, vstr_t *vstr, mp_obj_t *value) {
     for (;;) {
-        cont:
         if (S_END(s)) {
-            break;
+            return UJSON_TOK_EOF;
         }
-        mp_obj_t next = MP_OBJ_NULL;
-        bool enter = false;
         byte cur = S_CUR(s);
         S_NEXT(s);
         switch (cur) {
@@ -107,33 +242,30 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
             case '\t':
             case '\n':
             case '\r':
-                goto cont;
+                continue;
             case 'n':
                 if (S_CUR(s) == 'u' && S_NEXT(s) == 'l' && S_NEXT(s) == 'l') {
                     S_NEXT(s);
-                    next = mp_const_none;
-                } else {
-                    goto fail;
+                    *value = mp_const_none;
+                    return UJSON_TOK_VALUE;
                 }
-                break;
+                ujson_syntax_error();
             case 'f':
                 if (S_CUR(s) == 'a' && S_NEXT(s) == 'l' && S_NEXT(s) == 's' && S_NEXT(s) == 'e') {
                     S_NEXT(s);
-                    next = mp_const_false;
-                } else {
-                    goto fail;
+                    *value = mp_const_false;
+                    return UJSON_TOK_VALUE;
                 }
-                break;
+                ujson_syntax_error();
             case 't':
                 if (S_CUR(s) == 'r' && S_NEXT(s) == 'u' && S_NEXT(s) == 'e') {
                     S_NEXT(s);
-                    next = mp_const_true;
-                } else {
-                    goto fail;
+                    *value = mp_const_true;
+                    return UJSON_TOK_VALUE;
                 }
-                break;
+                ujson_syntax_error();
             case '"':
-                vstr_reset(&vstr);
+                vstr_reset(vstr);
                 for (; !S_END(s) && S_CUR(s) != '"';) {
                     byte c = S_CUR(s);
                     if (c == '\\') {
@@ -153,27 +285,27 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                                     }
                                     num = (num << 4) | c;
                                 }
-                                vstr_add_char(&vstr, num);
+                                vstr_add_char(vstr, num);
                                 goto str_cont;
                             }
                         }
                     }
-                    vstr_add_byte(&vstr, c);
+                    vstr_add_byte(vstr, c);
                 str_cont:
                     S_NEXT(s);
                 }
                 if (S_END(s)) {
-                    goto fail;
+                    ujson_syntax_error();
                 }
                 S_NEXT(s);
-                next = mp_obj_new_str(vstr.buf, vstr.len, false);
-                break;
+                *value = mp_obj_new_str(vstr->buf, vstr->len, false);
+                return UJSON_TOK_VALUE;
             case '-':
             case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9': {
                 bool flt = false;
-                vstr_reset(&vstr);
+                vstr_reset(vstr);
                 for (;;) {
-                    vstr_add_byte(&vstr, cur);
+                    vstr_add_byte(vstr, cur);
                     cur = S_CUR(s);
                     if (cur == '.' || cur == 'E' || cur == 'e') {
                         flt = true;
@@ -185,22 +317,63 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                     S_NEXT(s);
                 }
                 if (flt) {
-                    next = mp_parse_num_decimal(vstr.buf, vstr.len, false, false, NULL);
+                    *value = mp_parse_num_decimal(vstr->buf, vstr->len, false, false, NULL);
                 } else {
-                    next = mp_parse_num_integer(vstr.buf, vstr.len, 10, NULL);
+                    *value = mp_parse_num_integer(vstr->buf, vstr->len, 10, NULL);
                 }
-                break;
+                return UJSON_TOK_VALUE;
             }
             case '[':
+                return UJSON_TOK_START_LIST;
+            case '{':
+                return UJSON_TOK_START_DICT;
+            case ']':
+                return UJSON_TOK_END_LIST;
+            case '}':
+                return UJSON_TOK_END_DICT;
+            default:
+                ujson_syntax_error();
+        }
+    }
+}
+
+// After the single top-level object only whitespace may follow.
+STATIC void ujson_check_trailing(ujson_stream_t *s) {
+    while (unichar_isspace(S_CUR(s))) {
+        S_NEXT(s);
+    }
+    if (!S_END(s)) {
+        // unexpected chars
+        ujson_syntax_error();
+    }
+}
+
+STATIC mp_obj_t ujson_load(ujson_stream_t *s) {
+    vstr_t vstr;
+    vstr_init(&vstr, 8);
+    mp_obj_list_t stack; // we use a list as a simple stack for nested JSON
+    stack.len = 0;
+    stack.items = NULL;
+    mp_obj_t stack_top = MP_OBJ_NULL;
+    mp_obj_type_t *stack_top_type = NULL;
+    mp_obj_t stack_key = MP_OBJ_NULL;
+    S_NEXT(s);
+    for (;;) {
+        mp_obj_t next = MP_OBJ_NULL;
+        bool enter = false;
+        switch (ujson_next_token(s, &vstr, &next)) {
+            case UJSON_TOK_EOF:
+                goto success;
+            case UJSON_TOK_START_LIST:
                 next = mp_obj_new_list(0, NULL);
                 enter = true;
                 break;
-            case '{':
+            case UJSON_TOK_START_DICT:
                 next = mp_obj_new_dict(0);
                 enter = true;
                 break;
-            case '}':
-            case ']': {
+            case UJSON_TOK_END_LIST:
+            case UJSON_TOK_END_DICT:
                 if (stack_top == MP_OBJ_NULL) {
                     // no object at all
                     goto fail;
@@ -212,10 +385,7 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                 stack.len -= 1;
                 stack_top = stack.items[stack.len];
                 stack_top_type = mp_obj_get_type(stack_top);
-                goto cont;
-            }
-            default:
-                goto fail;
+                continue;
         }
         if (stack_top == MP_OBJ_NULL) {
             stack_top = next;
@@ -252,14 +422,7 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
         }
     }
     success:
-    // eat trailing whitespace
-    while (unichar_isspace(S_CUR(s))) {
-        S_NEXT(s);
-    }
-    if (!S_END(s)) {
-        // unexpected chars
-        goto fail;
-    }
+    ujson_check_trailing(s);
     if (stack_top == MP_OBJ_NULL || stack.len != 0) {
         // not exactly 1 object
         goto fail;
@@ -268,24 +431,137 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
     return stack_top;
 
     fail:
-    mp_raise_ValueError("syntax error in JSON");
+    ujson_syntax_error();
+}
+
+STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
+    ujson_stream_t s;
+    ujson_stream_init(&s, stream_obj);
+    return ujson_load(&s);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_load_obj, mod_ujson_load);
 
 STATIC mp_obj_t mod_ujson_loads(mp_obj_t obj) {
     size_t len;
-    const char *buf = mp_obj_str_get_data(obj, &len);
-    vstr_t vstr = {len, len, (char*)buf, true};
-    mp_obj_stringio_t sio = {{&mp_type_stringio}, &vstr, 0, MP_OBJ_NULL};
-    return mod_ujson_load(MP_OBJ_FROM_PTR(&sio));
+    mp_obj_str_get_data(obj, &len); // raise if not str or bytes
+    ujson_stream_t s;
+    ujson_stream_init(&s, obj);
+    return ujson_load(&s);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_loads_obj, mod_ujson_loads);
 
+#if MICROPY_PY_UJSON_ITERPARSE
+
+// iterparse(stream_or_str) yields (event, value) pairs without building the
+// object tree, so a huge document can be processed in bounded memory.  The
+// events are those of ijson's basic_parse: start_map, map_key, end_map,
+// start_array, end_array, null, boolean, number and string.  value is None
+// for the start and end events.
+typedef struct _mp_obj_ujson_iter_t {
+    mp_obj_base_t base;
+    vstr_t vstr;
+    vstr_t nest; // one byte per open container, 1 for a map and 0 for an array
+    bool started;
+    bool expect_key;
+    ujson_stream_t s;
+} mp_obj_ujson_iter_t;
+
+STATIC mp_obj_t ujson_event(qstr event, mp_obj_t value) {
+    mp_obj_t items[2] = {MP_OBJ_NEW_QSTR(event), value};
+    return mp_obj_new_tuple(2, items);
+}
+
+STATIC mp_obj_t ujson_iter_iternext(mp_obj_t self_in) {
+    mp_obj_ujson_iter_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->started) {
+        S_NEXT(&self->s);
+        self->started = true;
+    } else if (self->nest.len == 0) {
+        // the top-level object is complete
+        if (!S_END(&self->s)) {
+            ujson_check_trailing(&self->s);
+        }
+        return MP_OBJ_STOP_ITERATION;
+    }
+
+    mp_obj_t value = mp_const_none;
+    int tok = ujson_next_token(&self->s, &self->vstr, &value);
+    bool in_map = self->nest.len != 0 && self->nest.buf[self->nest.len - 1];
+    qstr event;
+    switch (tok) {
+        case UJSON_TOK_EOF:
+            // EOF before anything, or inside an unclosed container
+            ujson_syntax_error();
+        case UJSON_TOK_START_LIST:
+        case UJSON_TOK_START_DICT:
+            if (in_map && self->expect_key) {
+                ujson_syntax_error();
+            }
+            vstr_add_byte(&self->nest, tok == UJSON_TOK_START_DICT);
+            self->expect_key = tok == UJSON_TOK_START_DICT;
+            return ujson_event(tok == UJSON_TOK_START_DICT ? MP_QSTR_start_map : MP_QSTR_start_array, mp_const_none);
+        case UJSON_TOK_END_LIST:
+        case UJSON_TOK_END_DICT:
+            if (self->nest.len == 0) {
+                ujson_syntax_error();
+            }
+            self->nest.len -= 1;
+            self->expect_key = true;
+            return ujson_event(tok == UJSON_TOK_END_DICT ? MP_QSTR_end_map : MP_QSTR_end_array, mp_const_none);
+    }
+
+    if (in_map && self->expect_key) {
+        event = MP_QSTR_map_key;
+        self->expect_key = false;
+    } else {
+        if (value == mp_const_none) {
+            event = MP_QSTR_null;
+        } else if (value == mp_const_false || value == mp_const_true) {
+            event = MP_QSTR_boolean;
+        } else if (MP_OBJ_IS_STR(value)) {
+            event = MP_QSTR_string;
+        } else {
+            event = MP_QSTR_number;
+        }
+        self->expect_key = true;
+    }
+    if (self->nest.len == 0) {
+        // a single primitive is the whole document
+        ujson_check_trailing(&self->s);
+    }
+    return ujson_event(event, value);
+}
+
+STATIC const mp_obj_type_t ujson_iter_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_iterator,
+    .getiter = mp_identity_getiter,
+    .iternext = ujson_iter_iternext,
+};
+
+STATIC mp_obj_t mod_ujson_iterparse(mp_obj_t obj) {
+    mp_obj_ujson_iter_t *o = m_new_obj(mp_obj_ujson_iter_t);
+    o->base.type = &ujson_iter_type;
+    vstr_init(&o->vstr, 8);
+    vstr_init(&o->nest, 8);
+    o->started = false;
+    o->expect_key = false;
+    ujson_stream_init(&o->s, obj);
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_iterparse_obj, mod_ujson_iterparse);
+
+#endif
+
 STATIC const mp_rom_map_elem_t mp_module_ujson_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ujson) },
+    { MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&mod_ujson_dump_obj) },
     { MP_ROM_QSTR(MP_QSTR_dumps), MP_ROM_PTR(&mod_ujson_dumps_obj) },
     { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&mod_ujson_load_obj) },
     { MP_ROM_QSTR(MP_QSTR_loads), MP_ROM_PTR(&mod_ujson_loads_obj) },
+    #if MICROPY_PY_UJSON_ITERPARSE
+    { MP_ROM_QSTR(MP_QSTR_iterparse), MP_ROM_PTR(&mod_ujson_iterparse_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_ujson_globals, mp_module_ujson_globals_table);
@@ -199,10 +199,186 @@ error:
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_decompress_obj, 1, 3, mod_uzlib_decompress);
 
+#if MICROPY_PY_UZLIB_COMPRESS
+
+// wbits follows CPython: 9..15 gives zlib framing, -9..-15 raw deflate and
+// 25..31 gzip.  Returns the window bits and sets the checksum type.
+STATIC int compress_parse_wbits(mp_int_t wbits, int *checksum_type) {
+    if (wbits >= 9 && wbits <= 15) {
+        *checksum_type = TINF_CHKSUM_ADLER;
+    } else if (wbits >= -15 && wbits <= -9) {
+        *checksum_type = TINF_CHKSUM_NONE;
+        wbits = -wbits;
+    } else if (wbits >= 25 && wbits <= 31) {
+        *checksum_type = TINF_CHKSUM_CRC;
+        wbits -= 16;
+    } else {
+        mp_raise_ValueError("invalid wbits");
+    }
+    return wbits;
+}
+
+// level 1..9 sets how many earlier matches are tried at each position;
+// 0 disables matching and -1 is the default.
+STATIC unsigned int compress_chain_for_level(mp_int_t level) {
+    if (level < 0) {
+        level = 6;
+    } else if (level > 9) {
+        mp_raise_ValueError("invalid level");
+    }
+    return level == 0 ? 0 : 1 << (level - 1);
+}
+
+typedef struct _mp_obj_compio_t {
+    mp_obj_base_t base;
+    mp_obj_t dest_stream;
+    UZLIB_COMP comp;
+    bool finished;
+} mp_obj_compio_t;
+
+STATIC void write_dest_stream(UZLIB_COMP *comp, const unsigned char *buf, unsigned int len) {
+    byte *p = (void*)comp;
+    p -= offsetof(mp_obj_compio_t, comp);
+    mp_obj_compio_t *self = (mp_obj_compio_t*)p;
+    mp_stream_write(self->dest_stream, buf, len, MP_STREAM_RW_WRITE);
+}
+
+STATIC mp_obj_t compio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 3, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_WRITE);
+    int checksum_type;
+    int wbits = compress_parse_wbits(n_args > 1 ? mp_obj_get_int(args[1]) : 15, &checksum_type);
+    unsigned int chain = compress_chain_for_level(n_args > 2 ? mp_obj_get_int(args[2]) : -1);
+
+    mp_obj_compio_t *o = m_new_obj(mp_obj_compio_t);
+    o->base.type = type;
+    o->dest_stream = args[0];
+    o->finished = false;
+    uzlib_compress_init(&o->comp, wbits, checksum_type, m_new(byte, UZLIB_COMP_MEM_SIZE(wbits)));
+    o->comp.writeDest = write_dest_stream;
+    o->comp.max_chain = chain;
+    uzlib_compress_start(&o->comp);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_uint_t compio_write(mp_obj_t o_in, const void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (o->finished) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    uzlib_compress(&o->comp, buf, size);
+    return size;
+}
+
+STATIC mp_uint_t compio_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    (void)arg;
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (request == MP_STREAM_FLUSH) {
+        if (!o->finished) {
+            uzlib_compress_flush(&o->comp);
+        }
+        return 0;
+    }
+    *errcode = MP_EINVAL;
+    return MP_STREAM_ERROR;
+}
+
+// Finishes the compressed stream; the destination stream is left open.
+STATIC mp_obj_t compio_close(mp_obj_t self_in) {
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(self_in);
+    if (!o->finished) {
+        o->finished = true;
+        uzlib_compress_finish(&o->comp);
+        m_del(byte, o->comp.window, UZLIB_COMP_MEM_SIZE(o->comp.wbits));
+        o->comp.window = NULL;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(compio_close_obj, compio_close);
+
+STATIC mp_obj_t compio___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return compio_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(compio___exit___obj, 4, 4, compio___exit__);
+
+STATIC const mp_rom_map_elem_t compio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mp_stream_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&compio_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&compio___exit___obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(compio_locals_dict, compio_locals_dict_table);
+
+STATIC const mp_stream_p_t compio_stream_p = {
+    .write = compio_write,
+    .ioctl = compio_ioctl,
+};
+
+STATIC const mp_obj_type_t compio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CompIO,
+    .make_new = compio_make_new,
+    .protocol = &compio_stream_p,
+    .locals_dict = (void*)&compio_locals_dict,
+};
+
+typedef struct _compress_buf_t {
+    UZLIB_COMP comp;
+    vstr_t vstr;
+} compress_buf_t;
+
+STATIC void write_dest_vstr(UZLIB_COMP *comp, const unsigned char *buf, unsigned int len) {
+    compress_buf_t *cb = (compress_buf_t*)comp;
+    vstr_add_strn(&cb->vstr, (const char*)buf, len);
+}
+
+STATIC mp_obj_t mod_uzlib_compress(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    unsigned int chain = compress_chain_for_level(n_args > 1 ? mp_obj_get_int(args[1]) : -1);
+    int checksum_type;
+    int wbits = compress_parse_wbits(n_args > 2 ? mp_obj_get_int(args[2]) : 15, &checksum_type);
+
+    // The header advertises wbits, but a smaller window is enough for short
+    // input and needs less memory.
+    int header_wbits = wbits;
+    while (wbits > 9 && (1u << (wbits - 1)) >= bufinfo.len) {
+        wbits -= 1;
+    }
+
+    compress_buf_t cb;
+    byte *mem = m_new(byte, UZLIB_COMP_MEM_SIZE(wbits));
+    uzlib_compress_init(&cb.comp, wbits, checksum_type, mem);
+    cb.comp.writeDest = write_dest_vstr;
+    cb.comp.max_chain = chain;
+    cb.comp.last_block = 1;
+    vstr_init(&cb.vstr, bufinfo.len / 2 + 16);
+
+    cb.comp.wbits = header_wbits;
+    uzlib_compress_start(&cb.comp);
+    cb.comp.wbits = wbits;
+    uzlib_compress(&cb.comp, bufinfo.buf, bufinfo.len);
+    uzlib_compress_finish(&cb.comp);
+
+    m_del(byte, mem, UZLIB_COMP_MEM_SIZE(wbits));
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &cb.vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_compress_obj, 1, 3, mod_uzlib_compress);
+
+#endif // MICROPY_PY_UZLIB_COMPRESS
+
 STATIC const mp_rom_map_elem_t mp_module_uzlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uzlib) },
     { MP_ROM_QSTR(MP_QSTR_decompress), MP_ROM_PTR(&mod_uzlib_decompress_obj) },
     { MP_ROM_QSTR(MP_QSTR_DecompIO), MP_ROM_PTR(&decompio_type) },
+    #if MICROPY_PY_UZLIB_COMPRESS
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&mod_uzlib_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_CompIO), MP_ROM_PTR(&compio_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_uzlib_globals, mp_module_uzlib_globals_table);
@@ -218,6 +394,9 @@ const mp_obj_module_t mp_module_uzlib = {
 #include "uzlib/tinflate.c"
 #include "uzlib/tinfzlib.c"
 #include "uzlib/tinfgzip.c"
+#if MICROPY_PY_UZLIB_COMPRESS
+#include "uzlib/tdeflate.c"
+#endif
 #include "uzlib/adler32.c"
 #include "uzlib/crc32.c"
 
@@ -0,0 +1,349 @@
+/*
+ * tdeflate  -  tiny streaming deflate compressor (deflate, zlib, gzip)
+ *
+ * This software is provided 'as-is', without any express
+ * or implied warranty.  In no event will the authors be
+ * held liable for any damages arising from the use of
+ * this software.
+ *
+ * Permission is granted to anyone to use this software
+ * for any purpose, including commercial applications,
+ * and to alter it and redistribute it freely, subject to
+ * the following restrictions:
+ *
+ * 1. The origin of this software must not be
+ *    misrepresented; you must not claim that you
+ *    wrote the original software. If you use this
+ *    software in a product, an acknowledgment in
+ *    the product documentation would be appreciated
+ *    but is not required.
+ *
+ * 2. Altered source versions must be plainly marked
+ *    as such, and must not be misrepresented as
+ *    being the original software.
+ *
+ * 3. This notice may not be removed or altered from
+ *    any source distribution.
+ */
+
+/*
+ * Matches are found with a hash chain over the last 1 << wbits bytes and
+ * coded greedily with the fixed Huffman codes of RFC 1951, so no code
+ * tables have to be built or sent.  Input is buffered in a window of
+ * twice that size which slides down by half when full, as in zlib.
+ */
+
+#include <string.h>
+#include "tinf.h"
+
+/* -- output -- */
+
+static void outflush(UZLIB_COMP *c)
+{
+   if (c->outlen) {
+      c->writeDest(c, c->outbuf, c->outlen);
+      c->outlen = 0;
+   }
+}
+
+static void outbyte(UZLIB_COMP *c, unsigned char b)
+{
+   c->outbuf[c->outlen++] = b;
+   if (c->outlen == sizeof(c->outbuf)) outflush(c);
+}
+
+/* append nbits (at most 24) of bits, least significant first */
+static void outbits(UZLIB_COMP *c, uint32_t bits, int nbits)
+{
+   c->outbits |= bits << c->noutbits;
+   c->noutbits += nbits;
+   while (c->noutbits >= 8) {
+      outbyte(c, c->outbits & 0xff);
+      c->outbits >>= 8;
+      c->noutbits -= 8;
+   }
+}
+
+/* pad to a byte boundary with zero bits */
+static void outalign(UZLIB_COMP *c)
+{
+   if (c->noutbits) outbits(c, 0, 8 - c->noutbits);
+}
+
+/* Huffman codes are packed starting from their most significant bit */
+static const unsigned char rev4[16] = {
+   0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf
+};
+
+static void outcode(UZLIB_COMP *c, unsigned int code, int nbits)
+{
+   unsigned int r = (rev4[code & 15] << 8) | (rev4[(code >> 4) & 15] << 4) | rev4[code >> 8];
+   outbits(c, r >> (12 - nbits), nbits);
+}
+
+/* -- fixed Huffman blocks -- */
+
+static void start_block(UZLIB_COMP *c)
+{
+   if (!c->block_open) {
+      /* BFINAL, then BTYPE 01 */
+      outbits(c, c->last_block | 2, 3);
+      c->block_open = 1;
+   }
+}
+
+static void end_block(UZLIB_COMP *c)
+{
+   if (c->block_open) {
+      /* symbol 256 is seven zero bits */
+      outbits(c, 0, 7);
+      c->block_open = 0;
+   }
+}
+
+static void out_literal(UZLIB_COMP *c, unsigned char ch)
+{
+   start_block(c);
+   if (ch < 144) {
+      outcode(c, 0x30 + ch, 8);
+   } else {
+      outcode(c, 0x190 + ch - 144, 9);
+   }
+}
+
+static int highbit(unsigned int x)
+{
+   int n = 0;
+   while (x >>= 1) n++;
+   return n;
+}
+
+static void out_match(UZLIB_COMP *c, unsigned int dist, unsigned int len)
+{
+   unsigned int x, code;
+   int n;
+
+   start_block(c);
+
+   /* length: symbols 257..285, the ones from 265 with extra bits */
+   x = len - UZLIB_MIN_MATCH;
+   if (len == UZLIB_MAX_MATCH) {
+      code = 28;
+      n = 0;
+   } else if (x < 8) {
+      code = x;
+      n = 0;
+   } else {
+      n = highbit(x) - 2;
+      code = 4 * (n + 1) + ((x >> n) & 3);
+   }
+   if (code < 280 - 257) {
+      outcode(c, code + 1, 7);
+   } else {
+      outcode(c, 0xc0 + code + 257 - 280, 8);
+   }
+   if (n) outbits(c, x & ((1 << n) - 1), n);
+
+   /* distance: 5 bit codes 0..29, from 4 on with extra bits */
+   x = dist - 1;
+   if (x < 4) {
+      outcode(c, x, 5);
+   } else {
+      n = highbit(x) - 1;
+      outcode(c, 2 * (n + 1) + ((x >> n) & 1), 5);
+      outbits(c, x & ((1 << n) - 1), n);
+   }
+}
+
+/* -- LZ77 -- */
+
+static unsigned int lz_hash(const UZLIB_COMP *c, const unsigned char *p)
+{
+   uint32_t v = p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16);
+   return (v * 2654435761u) >> (32 - c->hash_bits);
+}
+
+/* add pos to its hash chain and return the previous head of the chain */
+static unsigned int lz_insert(UZLIB_COMP *c, unsigned int pos)
+{
+   unsigned int h = lz_hash(c, c->window + pos);
+   unsigned int prev = c->hash_head[h];
+   c->hash_prev[pos & ((1u << c->wbits) - 1)] = prev;
+   c->hash_head[h] = pos;
+   return prev;
+}
+
+static unsigned int lz_longest_match(UZLIB_COMP *c, unsigned int cand, unsigned int *dist)
+{
+   const unsigned char *scan = c->window + c->strstart;
+   unsigned int wsize = 1u << c->wbits;
+   unsigned int max_len = c->lookahead < UZLIB_MAX_MATCH ? c->lookahead : UZLIB_MAX_MATCH;
+   /* a candidate a whole window back would share its chain slot with strstart */
+   unsigned int limit = c->strstart > wsize ? c->strstart - wsize : 0;
+   unsigned int best = UZLIB_MIN_MATCH - 1;
+   unsigned int chain = c->max_chain;
+
+   while (cand > limit && chain-- > 0) {
+      const unsigned char *m = c->window + cand;
+      if (m[best] == scan[best] && m[0] == scan[0] && m[1] == scan[1]) {
+         unsigned int len = 2;
+         while (len < max_len && m[len] == scan[len]) len++;
+         if (len > best) {
+            best = len;
+            *dist = c->strstart - cand;
+            if (len == max_len) break;
+         }
+      }
+      cand = c->hash_prev[cand & (wsize - 1)];
+   }
+   return best >= UZLIB_MIN_MATCH ? best : 0;
+}
+
+/* drop the older half of the window, rebasing all stored positions */
+static void lz_slide(UZLIB_COMP *c)
+{
+   unsigned int wsize = 1u << c->wbits;
+   unsigned int i;
+   memcpy(c->window, c->window + wsize, wsize);
+   c->strstart -= wsize;
+   for (i = 0; i < (1u << c->hash_bits); i++) {
+      c->hash_head[i] = c->hash_head[i] >= wsize ? c->hash_head[i] - wsize : 0;
+   }
+   for (i = 0; i < wsize; i++) {
+      c->hash_prev[i] = c->hash_prev[i] >= wsize ? c->hash_prev[i] - wsize : 0;
+   }
+}
+
+/* encode buffered input, keeping a full match length of lookahead unless
+   flushing */
+static void lz_process(UZLIB_COMP *c, int flush)
+{
+   unsigned int need = flush ? 1 : UZLIB_MAX_MATCH;
+   while (c->lookahead >= need) {
+      unsigned int len = 0, dist = 0;
+      if (c->lookahead >= UZLIB_MIN_MATCH) {
+         unsigned int cand = lz_insert(c, c->strstart);
+         if (c->max_chain) len = lz_longest_match(c, cand, &dist);
+      }
+      if (len) {
+         unsigned int end = c->strstart + len;
+         unsigned int last = c->strstart + c->lookahead - UZLIB_MIN_MATCH;
+         unsigned int p;
+         out_match(c, dist, len);
+         for (p = c->strstart + 1; p < end && p <= last; p++) lz_insert(c, p);
+         c->strstart = end;
+         c->lookahead -= len;
+      } else {
+         out_literal(c, c->window[c->strstart]);
+         c->strstart++;
+         c->lookahead--;
+      }
+   }
+}
+
+/* -- public API -- */
+
+/* wbits is 9..15; mem must be UZLIB_COMP_MEM_SIZE(wbits) bytes, 2-byte aligned */
+void uzlib_compress_init(UZLIB_COMP *c, int wbits, int checksum_type, void *mem)
+{
+   unsigned int wsize = 1u << wbits;
+   memset(c, 0, sizeof(*c));
+   c->wbits = wbits;
+   c->hash_bits = wbits - 1;
+   c->max_chain = 32;
+   c->window = mem;
+   c->hash_prev = (unsigned short *)(c->window + 2 * wsize);
+   c->hash_head = c->hash_prev + wsize;
+   memset(c->hash_head, 0, sizeof(unsigned short) << c->hash_bits);
+   c->checksum_type = checksum_type;
+   if (checksum_type == TINF_CHKSUM_ADLER) {
+      c->checksum = 1;
+   } else if (checksum_type == TINF_CHKSUM_CRC) {
+      c->checksum = 0xffffffff;
+   }
+}
+
+/* write the zlib or gzip header */
+void uzlib_compress_start(UZLIB_COMP *c)
+{
+   if (c->checksum_type == TINF_CHKSUM_ADLER) {
+      unsigned int cmf = ((c->wbits - 8) << 4) | 8;
+      unsigned int flg = 2 << 6; /* default compression level */
+      flg += 31 - (cmf * 256 + flg) % 31;
+      outbyte(c, cmf);
+      outbyte(c, flg);
+   } else if (c->checksum_type == TINF_CHKSUM_CRC) {
+      /* magic, deflate, no flags, no mtime, no extra flags, unknown OS */
+      static const unsigned char gzip_header[10] = {
+         0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff
+      };
+      unsigned int i;
+      for (i = 0; i < sizeof(gzip_header); i++) outbyte(c, gzip_header[i]);
+   }
+}
+
+void uzlib_compress(UZLIB_COMP *c, const void *src_, unsigned int len)
+{
+   const unsigned char *src = src_;
+   unsigned int wsize = 1u << c->wbits;
+
+   if (c->checksum_type == TINF_CHKSUM_ADLER) {
+      c->checksum = uzlib_adler32(src, len, c->checksum);
+   } else if (c->checksum_type == TINF_CHKSUM_CRC) {
+      c->checksum = uzlib_crc32(src, len, c->checksum);
+   }
+   c->total_in += len;
+
+   while (len) {
+      unsigned int room = 2 * wsize - (c->strstart + c->lookahead);
+      if (room == 0) {
+         lz_slide(c);
+         continue;
+      }
+      if (room > len) room = len;
+      memcpy(c->window + c->strstart + c->lookahead, src, room);
+      c->lookahead += room;
+      src += room;
+      len -= room;
+      lz_process(c, 0);
+   }
+}
+
+/* Encode all input so far and end on a byte boundary with an empty stored
+   block, so that a decompressor can produce everything written (as
+   Z_SYNC_FLUSH in zlib). */
+void uzlib_compress_flush(UZLIB_COMP *c)
+{
+   lz_process(c, 1);
+   end_block(c);
+   outbits(c, 0, 3);
+   outalign(c);
+   outbyte(c, 0);
+   outbyte(c, 0);
+   outbyte(c, 0xff);
+   outbyte(c, 0xff);
+   outflush(c);
+}
+
+/* encode the rest of the input and write the final block and trailer */
+void uzlib_compress_finish(UZLIB_COMP *c)
+{
+   lz_process(c, 1);
+   if (!c->last_block) {
+      end_block(c);
+      c->last_block = 1;
+   }
+   start_block(c);
+   end_block(c);
+   outalign(c);
+   if (c->checksum_type == TINF_CHKSUM_ADLER) {
+      int i;
+      for (i = 24; i >= 0; i -= 8) outbyte(c, c->checksum >> i);
+   } else if (c->checksum_type == TINF_CHKSUM_CRC) {
+      uint32_t crc = c->checksum ^ 0xffffffff;
+      int i;
+      for (i = 0; i < 32; i += 8) outbyte(c, crc >> i);
+      for (i = 0; i < 32; i += 8) outbyte(c, c->total_in >> i);
+   }
+   outflush(c);
+}
@@ -101,7 +101,48 @@ int TINFCC uzlib_gzip_parse_header(TINF_DATA *d);
 
 /* Compression API */
 
-void TINFCC uzlib_compress(void *data, const uint8_t *src, unsigned slen);
+#define UZLIB_MIN_MATCH 3
+#define UZLIB_MAX_MATCH 258
+
+/* Size of the memory block given to uzlib_compress_init: the window holds
+   2 << wbits bytes, followed by (1 << wbits) hash chain links and
+   (1 << (wbits - 1)) hash heads, both 16 bit. */
+#define UZLIB_COMP_MEM_SIZE(wbits) (5u << (wbits))
+
+struct UZLIB_COMP;
+typedef struct UZLIB_COMP {
+   /* Called with each chunk of compressed output */
+   void (*writeDest)(struct UZLIB_COMP *c, const unsigned char *buf, unsigned int len);
+
+   /* Bit accumulator and output staging buffer */
+   uint32_t outbits;
+   int noutbits;
+   unsigned int outlen;
+   unsigned char outbuf[64];
+   char block_open;  /* a fixed Huffman block has been started */
+   char last_block;  /* the next block started is the final one */
+
+   /* LZ77 state; positions index into window, 0 doubles as "none" */
+   unsigned char *window;
+   unsigned short *hash_prev;
+   unsigned short *hash_head;
+   unsigned int wbits;
+   unsigned int hash_bits;
+   unsigned int max_chain;
+   unsigned int strstart;   /* next byte to encode */
+   unsigned int lookahead;  /* bytes buffered at strstart */
+
+   /* Framing; checksum_type selects raw, zlib or gzip as for TINF_DATA */
+   uint32_t checksum;
+   uint32_t total_in;
+   char checksum_type;
+} UZLIB_COMP;
+
+void TINFCC uzlib_compress_init(UZLIB_COMP *c, int wbits, int checksum_type, void *mem);
+void TINFCC uzlib_compress_start(UZLIB_COMP *c);
+void TINFCC uzlib_compress(UZLIB_COMP *c, const void *src, unsigned int len);
+void TINFCC uzlib_compress_flush(UZLIB_COMP *c);
+void TINFCC uzlib_compress_finish(UZLIB_COMP *c);
 
 /* Checksum API */
 
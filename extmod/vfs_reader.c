@@ -63,6 +63,31 @@ STATIC mp_uint_t mp_reader_vfs_readbyte(void *data) {
     return reader->buf[reader->pos++];
 }
 
+STATIC size_t mp_reader_vfs_readinto(void *data, byte *buf, size_t len) {
+    mp_reader_vfs_t *reader = (mp_reader_vfs_t*)data;
+    if (reader->pos < reader->len) {
+        // hand out what was buffered by an earlier read
+        if (len > (size_t)(reader->len - reader->pos)) {
+            len = reader->len - reader->pos;
+        }
+        memcpy(buf, reader->buf + reader->pos, len);
+        reader->pos += len;
+        return len;
+    }
+    if (reader->len < sizeof(reader->buf)) {
+        return 0;
+    }
+    int errcode;
+    len = mp_stream_rw(reader->file, buf, len, &errcode, MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
+    if (errcode != 0 || len == 0) {
+        // TODO handle errors properly
+        reader->len = 0;
+        reader->pos = 0;
+        return 0;
+    }
+    return len;
+}
+
 STATIC void mp_reader_vfs_close(void *data) {
     mp_reader_vfs_t *reader = (mp_reader_vfs_t*)data;
     mp_stream_close(reader->file);
@@ -82,6 +107,7 @@ void mp_reader_new_file(mp_reader_t *reader, const char *filename) {
     reader->data = rf;
     reader->readbyte = mp_reader_vfs_readbyte;
     reader->close = mp_reader_vfs_close;
+    reader->readinto = mp_reader_vfs_readinto;
 }
 
 #endif // MICROPY_READER_VFS
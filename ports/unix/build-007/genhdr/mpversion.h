@@ -0,0 +1,9 @@
+// This file was generated by py/makeversionhdr.py
+#define MICROPY_GIT_TAG "d7b3b0a"
+#define MICROPY_GIT_HASH "d7b3b0a"
+#define MICROPY_BUILD_DATE "2026-10-17"
+#define MICROPY_VERSION_MAJOR (0)
+#define MICROPY_VERSION_MINOR (0)
+#define MICROPY_VERSION_MICRO (0)
+#define MICROPY_VERSION_STRING "d7b3b0a"
+#define MICROPY_FULL_VERSION_INFO ("Adafruit CircuitPython " MICROPY_GIT_TAG " on " MICROPY_BUILD_DATE "; " MICROPY_HW_BOARD_NAME " with " MICROPY_HW_MCU_NAME)
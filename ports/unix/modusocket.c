@@ -185,13 +185,13 @@ STATIC mp_obj_t socket_recv(size_t n_args, const mp_obj_t *args) {
         flags = MP_OBJ_SMALL_INT_VALUE(args[2]);
     }
 
-    byte *buf = m_new(byte, sz);
-    int out_sz = recv(self->fd, buf, sz, flags);
+    vstr_t vstr;
+    vstr_init_len(&vstr, sz);
+    int out_sz = recv(self->fd, vstr.buf, sz, flags);
     RAISE_ERRNO(out_sz, errno);
 
-    mp_obj_t ret = mp_obj_new_str_of_type(&mp_type_bytes, buf, out_sz);
-    m_del(char, buf, sz);
-    return ret;
+    vstr.len = out_sz;
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recv_obj, 2, 3, socket_recv);
 
@@ -207,21 +207,76 @@ STATIC mp_obj_t socket_recvfrom(size_t n_args, const mp_obj_t *args) {
     struct sockaddr_storage addr;
     socklen_t addr_len = sizeof(addr);
 
-    byte *buf = m_new(byte, sz);
-    int out_sz = recvfrom(self->fd, buf, sz, flags, (struct sockaddr*)&addr, &addr_len);
+    vstr_t vstr;
+    vstr_init_len(&vstr, sz);
+    int out_sz = recvfrom(self->fd, vstr.buf, sz, flags, (struct sockaddr*)&addr, &addr_len);
     RAISE_ERRNO(out_sz, errno);
 
-    mp_obj_t buf_o = mp_obj_new_str_of_type(&mp_type_bytes, buf, out_sz);
-    m_del(char, buf, sz);
-
+    vstr.len = out_sz;
     mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(2, NULL));
-    t->items[0] = buf_o;
+    t->items[0] = mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
     t->items[1] = mp_obj_from_sockaddr((struct sockaddr*)&addr, addr_len);
 
     return MP_OBJ_FROM_PTR(t);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recvfrom_obj, 2, 3, socket_recvfrom);
 
+// Receive into the caller's buffer, which may be a bytearray, array or
+// memoryview slice, so a receive loop does not touch the heap.  Arguments
+// are (buf[, nbytes[, flags]]) as in CPython; nbytes of 0 means all of buf.
+STATIC byte *socket_get_into_buf(size_t n_args, const mp_obj_t *args, size_t *len, int *flags) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    *len = bufinfo.len;
+    if (n_args > 2) {
+        mp_int_t sz = mp_obj_get_int(args[2]);
+        if (sz < 0 || (size_t)sz > bufinfo.len) {
+            mp_raise_ValueError("nbytes is greater than the length of the buffer");
+        }
+        if (sz != 0) {
+            *len = sz;
+        }
+    }
+    *flags = 0;
+    if (n_args > 3) {
+        *flags = MP_OBJ_SMALL_INT_VALUE(args[3]);
+    }
+    return bufinfo.buf;
+}
+
+STATIC mp_obj_t socket_recv_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    size_t len;
+    int flags;
+    byte *buf = socket_get_into_buf(n_args, args, &len, &flags);
+
+    int out_sz = recv(self->fd, buf, len, flags);
+    RAISE_ERRNO(out_sz, errno);
+
+    return MP_OBJ_NEW_SMALL_INT(out_sz);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recv_into_obj, 2, 4, socket_recv_into);
+
+STATIC mp_obj_t socket_recvfrom_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    size_t len;
+    int flags;
+    byte *buf = socket_get_into_buf(n_args, args, &len, &flags);
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+
+    int out_sz = recvfrom(self->fd, buf, len, flags, (struct sockaddr*)&addr, &addr_len);
+    RAISE_ERRNO(out_sz, errno);
+
+    mp_obj_t items[2] = {
+        MP_OBJ_NEW_SMALL_INT(out_sz),
+        mp_obj_from_sockaddr((struct sockaddr*)&addr, addr_len),
+    };
+    return mp_obj_new_tuple(2, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recvfrom_into_obj, 2, 4, socket_recvfrom_into);
+
 // Note: besides flag param, this differs from write() in that
 // this does not swallow blocking errors (EAGAIN, EWOULDBLOCK) -
 // these would be thrown as exceptions.
@@ -355,6 +410,8 @@ STATIC const mp_rom_map_elem_t usocket_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_accept), MP_ROM_PTR(&socket_accept_obj) },
     { MP_ROM_QSTR(MP_QSTR_recv), MP_ROM_PTR(&socket_recv_obj) },
     { MP_ROM_QSTR(MP_QSTR_recvfrom), MP_ROM_PTR(&socket_recvfrom_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recv_into), MP_ROM_PTR(&socket_recv_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recvfrom_into), MP_ROM_PTR(&socket_recvfrom_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_send), MP_ROM_PTR(&socket_send_obj) },
     { MP_ROM_QSTR(MP_QSTR_sendto), MP_ROM_PTR(&socket_sendto_obj) },
     { MP_ROM_QSTR(MP_QSTR_setsockopt), MP_ROM_PTR(&socket_setsockopt_obj) },
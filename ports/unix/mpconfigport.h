@@ -27,6 +27,7 @@
 // options to control how MicroPython is built
 
 #define MICROPY_ALLOC_PATH_MAX      (PATH_MAX)
+#define MICROPY_ALLOC_LEXER_BUF     (512)
 #define MICROPY_PERSISTENT_CODE_LOAD (1)
 #if !defined(MICROPY_EMIT_X64) && defined(__x86_64__)
     #define MICROPY_EMIT_X64        (1)
@@ -48,6 +49,17 @@
 #define MICROPY_COMP_RETURN_IF_EXPR (1)
 #define MICROPY_ENABLE_GC           (1)
 #define MICROPY_ENABLE_FINALISER    (1)
+#define MICROPY_GC_SIZE_CLASSES     (4)
+#define MICROPY_GC_SIZE_CLASS_LEN   (256)
+#define MICROPY_GC_LEAF_BLOCKS      (1)
+#define MICROPY_GC_LAZY_SWEEP       (1)
+#define MICROPY_GC_PAUSE_STATS      (1)
+#define MICROPY_GC_COMPACT          (1)
+#if MICROPY_PY_THREAD
+#define MICROPY_GC_PARALLEL_MARK    (8)
+#define MICROPY_GC_MARK_IDLE_HOOK() sched_yield()
+#define MICROPY_GC_TLAB             (!MICROPY_PY_THREAD_GIL)
+#endif
 #define MICROPY_STACK_CHECK         (1)
 #define MICROPY_MALLOC_USES_ALLOCATED_SIZE (1)
 #define MICROPY_MEM_STATS           (1)
@@ -63,13 +75,22 @@
 #define MICROPY_HELPER_LEXER_UNIX   (1)
 #define MICROPY_ENABLE_SOURCE_LINE  (1)
 #define MICROPY_FLOAT_IMPL          (MICROPY_FLOAT_IMPL_DOUBLE)
+#define MICROPY_FLOAT_FAST_CONV     (1)
 #define MICROPY_LONGINT_IMPL        (MICROPY_LONGINT_IMPL_MPZ)
+#define MICROPY_OPT_MPZ_KARATSUBA   (1)
+#define MICROPY_OPT_MPZ_MONTGOMERY  (1)
+#define MICROPY_OPT_MPZ_DIVCONQ_STR (1)
 #define MICROPY_STREAMS_NON_BLOCK   (1)
 #define MICROPY_STREAMS_POSIX_API   (1)
 #define MICROPY_OPT_COMPUTED_GOTO   (1)
 #ifndef MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (1)
 #endif
+#define MICROPY_OPT_QUICKEN_BYTECODE (1)
+#define MICROPY_OPT_ATTR_INLINE_CACHE (1)
+#define MICROPY_OPT_QSTR_HASH_INDEX (1)
+#define MICROPY_OPT_MAP_LOOKUP_CACHE (1)
+#define MICROPY_OPT_STR_INPLACE_ADD (1)
 #define MICROPY_CAN_OVERRIDE_BUILTINS (1)
 #define MICROPY_PY_FUNCTION_ATTRS   (1)
 #define MICROPY_PY_DESCRIPTORS      (1)
@@ -104,6 +125,8 @@
 #define MICROPY_PY_CMATH            (1)
 #define MICROPY_PY_IO_FILEIO        (1)
 #define MICROPY_PY_IO_RESOURCE_STREAM (1)
+#define MICROPY_PY_IO_BUFFEREDWRITER (1)
+#define MICROPY_PY_IO_BUFFEREDREADER (1)
 #define MICROPY_PY_GC_COLLECT_RETVAL (1)
 #define MICROPY_MODULE_FROZEN_STR   (1)
 
@@ -116,7 +139,9 @@
 #define MICROPY_PY_UERRNO           (1)
 #define MICROPY_PY_UCTYPES          (1)
 #define MICROPY_PY_UZLIB            (1)
+#define MICROPY_PY_UZLIB_COMPRESS   (1)
 #define MICROPY_PY_UJSON            (1)
+#define MICROPY_PY_UJSON_ITERPARSE  (1)
 #define MICROPY_PY_URE              (1)
 #define MICROPY_PY_UHEAPQ           (1)
 #define MICROPY_PY_UTIMEQ           (1)
@@ -316,6 +341,10 @@ void mp_unix_mark_exec(void);
 #define _DIRENT_HAVE_D_INO (1)
 #endif
 
+#if MICROPY_GC_PARALLEL_MARK
+#include <sched.h>
+#endif
+
 #ifndef __APPLE__
 // For debugging purposes, make printf() available to any source file.
 #include <stdio.h>
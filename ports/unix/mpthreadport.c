@@ -197,6 +197,76 @@ void mp_thread_finish(void) {
     pthread_mutex_unlock(&thread_mutex);
 }
 
+#if MICROPY_GC_PARALLEL_MARK
+// Helper threads for the mark phase of the GC.  They are started when first
+// needed and then sleep until the next collection.  They never run Python
+// code, so they aren't in the list of threads and their stacks aren't roots.
+STATIC pthread_mutex_t gc_worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+STATIC pthread_cond_t gc_worker_start_cond = PTHREAD_COND_INITIALIZER;
+STATIC pthread_cond_t gc_worker_done_cond = PTHREAD_COND_INITIALIZER;
+STATIC size_t gc_worker_started; // number of helper threads running
+STATIC size_t gc_worker_n; // threads taking part in the current run
+STATIC size_t gc_worker_pending; // helper threads yet to finish the current run
+STATIC size_t gc_worker_run; // incremented for each run
+STATIC void (*gc_worker_fun)(size_t, size_t);
+
+STATIC void *gc_worker_entry(void *arg) {
+    size_t id = (size_t)arg;
+    size_t run = 0;
+
+    // signals are handled by the Python threads
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&gc_worker_mutex);
+    for (;;) {
+        while (gc_worker_run == run) {
+            pthread_cond_wait(&gc_worker_start_cond, &gc_worker_mutex);
+        }
+        run = gc_worker_run;
+        if (id < gc_worker_n) {
+            void (*fun)(size_t, size_t) = gc_worker_fun;
+            size_t n = gc_worker_n;
+            pthread_mutex_unlock(&gc_worker_mutex);
+            fun(id, n);
+            pthread_mutex_lock(&gc_worker_mutex);
+            if (--gc_worker_pending == 0) {
+                pthread_cond_signal(&gc_worker_done_cond);
+            }
+        }
+    }
+    return NULL;
+}
+
+void mp_thread_gc_run_workers(size_t n_threads, void (*fun)(size_t id, size_t n)) {
+    pthread_mutex_lock(&gc_worker_mutex);
+    while (gc_worker_started + 1 < n_threads) {
+        pthread_t id;
+        if (pthread_create(&id, NULL, gc_worker_entry, (void*)(gc_worker_started + 1)) != 0) {
+            break;
+        }
+        pthread_detach(id);
+        gc_worker_started += 1;
+    }
+    gc_worker_n = MIN(n_threads, gc_worker_started + 1);
+    gc_worker_pending = gc_worker_n - 1;
+    gc_worker_fun = fun;
+    gc_worker_run += 1;
+    pthread_cond_broadcast(&gc_worker_start_cond);
+    size_t n = gc_worker_n;
+    pthread_mutex_unlock(&gc_worker_mutex);
+
+    fun(0, n);
+
+    pthread_mutex_lock(&gc_worker_mutex);
+    while (gc_worker_pending != 0) {
+        pthread_cond_wait(&gc_worker_done_cond, &gc_worker_mutex);
+    }
+    pthread_mutex_unlock(&gc_worker_mutex);
+}
+#endif
+
 void mp_thread_mutex_init(mp_thread_mutex_t *mutex) {
     pthread_mutex_init(mutex, NULL);
 }
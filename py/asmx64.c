@@ -73,6 +73,7 @@
 #define OPCODE_CMP_R64_WITH_RM64 (0x39) /* /r */
 //#define OPCODE_CMP_RM32_WITH_R32 (0x3b)
 #define OPCODE_TEST_R8_WITH_RM8  (0x84) /* /r */
+#define OPCODE_TEST_I8_WITH_RM8  (0xf6) /* /0 */
 #define OPCODE_JMP_REL8          (0xeb)
 #define OPCODE_JMP_REL32         (0xe9)
 #define OPCODE_JCC_REL8          (0x70) /* | jcc type */
@@ -190,7 +191,8 @@ STATIC void asm_x64_write_r64_disp(asm_x64_t *as, int r64, int disp_r64, int dis
         return;
     }
 
-    if (disp_offset == 0 && disp_r64 != ASM_X64_REG_RBP) {
+    // rbp and r13 can't be encoded without a displacement
+    if (disp_offset == 0 && (disp_r64 & 7) != ASM_X64_REG_RBP) {
         asm_x64_write_byte_1(as, MODRM_R64(r64) | MODRM_RM_DISP0 | MODRM_RM_R64(disp_r64));
     } else if (SIGNED_FIT8(disp_offset)) {
         asm_x64_write_byte_2(as, MODRM_R64(r64) | MODRM_RM_DISP8 | MODRM_RM_R64(disp_r64), IMM32_L0(disp_offset));
@@ -248,7 +250,8 @@ void asm_x64_mov_r64_r64(asm_x64_t *as, int dest_r64, int src_r64) {
 }
 
 void asm_x64_mov_r8_to_mem8(asm_x64_t *as, int src_r64, int dest_r64, int dest_disp) {
-    if (src_r64 < 8 && dest_r64 < 8) {
+    // without a REX prefix registers 4-7 encode ah, ch, dh, bh
+    if (src_r64 < 4 && dest_r64 < 8) {
         asm_x64_write_byte_1(as, OPCODE_MOV_R8_TO_RM8);
     } else {
         asm_x64_write_byte_2(as, REX_PREFIX | REX_R_FROM_R64(src_r64) | REX_B_FROM_R64(dest_r64), OPCODE_MOV_R8_TO_RM8);
@@ -281,31 +284,28 @@ void asm_x64_mov_r64_to_mem64(asm_x64_t *as, int src_r64, int dest_r64, int dest
 }
 
 void asm_x64_mov_mem8_to_r64zx(asm_x64_t *as, int src_r64, int src_disp, int dest_r64) {
-    assert(src_r64 < 8);
-    if (dest_r64 < 8) {
+    if (src_r64 < 8 && dest_r64 < 8) {
         asm_x64_write_byte_2(as, 0x0f, OPCODE_MOVZX_RM8_TO_R64);
     } else {
-        asm_x64_write_byte_3(as, REX_PREFIX | REX_R, 0x0f, OPCODE_MOVZX_RM8_TO_R64);
+        asm_x64_write_byte_3(as, REX_PREFIX | REX_R_FROM_R64(dest_r64) | REX_B_FROM_R64(src_r64), 0x0f, OPCODE_MOVZX_RM8_TO_R64);
     }
     asm_x64_write_r64_disp(as, dest_r64, src_r64, src_disp);
 }
 
 void asm_x64_mov_mem16_to_r64zx(asm_x64_t *as, int src_r64, int src_disp, int dest_r64) {
-    assert(src_r64 < 8);
-    if (dest_r64 < 8) {
+    if (src_r64 < 8 && dest_r64 < 8) {
         asm_x64_write_byte_2(as, 0x0f, OPCODE_MOVZX_RM16_TO_R64);
     } else {
-        asm_x64_write_byte_3(as, REX_PREFIX | REX_R, 0x0f, OPCODE_MOVZX_RM16_TO_R64);
+        asm_x64_write_byte_3(as, REX_PREFIX | REX_R_FROM_R64(dest_r64) | REX_B_FROM_R64(src_r64), 0x0f, OPCODE_MOVZX_RM16_TO_R64);
     }
     asm_x64_write_r64_disp(as, dest_r64, src_r64, src_disp);
 }
 
 void asm_x64_mov_mem32_to_r64zx(asm_x64_t *as, int src_r64, int src_disp, int dest_r64) {
-    assert(src_r64 < 8);
-    if (dest_r64 < 8) {
+    if (src_r64 < 8 && dest_r64 < 8) {
         asm_x64_write_byte_1(as, OPCODE_MOV_RM64_TO_R64);
     } else {
-        asm_x64_write_byte_2(as, REX_PREFIX | REX_R, OPCODE_MOV_RM64_TO_R64);
+        asm_x64_write_byte_2(as, REX_PREFIX | REX_R_FROM_R64(dest_r64) | REX_B_FROM_R64(src_r64), OPCODE_MOV_RM64_TO_R64);
     }
     asm_x64_write_r64_disp(as, dest_r64, src_r64, src_disp);
 }
@@ -418,7 +418,7 @@ void asm_x64_sub_i32_from_r32(asm_x64_t *as, int src_i32, int dest_r32) {
 }
 */
 
-STATIC void asm_x64_sub_r64_i32(asm_x64_t *as, int dest_r64, int src_i32) {
+void asm_x64_sub_r64_i32(asm_x64_t *as, int dest_r64, int src_i32) {
     assert(dest_r64 < 8);
     if (SIGNED_FIT8(src_i32)) {
         // use REX prefix for 64 bit operation
@@ -471,6 +471,12 @@ void asm_x64_test_r8_with_r8(asm_x64_t *as, int src_r64_a, int src_r64_b) {
     asm_x64_write_byte_2(as, OPCODE_TEST_R8_WITH_RM8, MODRM_R64(src_r64_a) | MODRM_RM_REG | MODRM_RM_R64(src_r64_b));
 }
 
+void asm_x64_test_r8_with_i8(asm_x64_t *as, int src_r64, int src_i8) {
+    // only AL, CL, DL and BL can be encoded without a REX prefix
+    assert(src_r64 < 4);
+    asm_x64_write_byte_3(as, OPCODE_TEST_I8_WITH_RM8, MODRM_R64(0) | MODRM_RM_REG | MODRM_RM_R64(src_r64), src_i8);
+}
+
 void asm_x64_setcc_r8(asm_x64_t *as, int jcc_type, int dest_r8) {
     assert(dest_r8 < 8);
     asm_x64_write_byte_3(as, OPCODE_SETCC_RM8_A, OPCODE_SETCC_RM8_B | jcc_type, MODRM_R64(0) | MODRM_RM_REG | MODRM_RM_R64(dest_r8));
@@ -536,10 +542,14 @@ void asm_x64_entry(asm_x64_t *as, int num_locals) {
     asm_x64_push_r64(as, ASM_X64_REG_RBX);
     asm_x64_push_r64(as, ASM_X64_REG_R12);
     asm_x64_push_r64(as, ASM_X64_REG_R13);
+    asm_x64_push_r64(as, ASM_X64_REG_R14);
+    asm_x64_push_r64(as, ASM_X64_REG_R15);
     as->num_locals = num_locals;
 }
 
 void asm_x64_exit(asm_x64_t *as) {
+    asm_x64_pop_r64(as, ASM_X64_REG_R15);
+    asm_x64_pop_r64(as, ASM_X64_REG_R14);
     asm_x64_pop_r64(as, ASM_X64_REG_R13);
     asm_x64_pop_r64(as, ASM_X64_REG_R12);
     asm_x64_pop_r64(as, ASM_X64_REG_RBX);
@@ -629,4 +639,55 @@ void asm_x64_call_ind(asm_x64_t *as, void *ptr, int temp_r64) {
     */
 }
 
+/* SSE2 */
+
+#define OPCODE_SSE_PREFIX_66     (0x66)
+#define OPCODE_SSE_PREFIX_F3     (0xf3)
+#define OPCODE_SSE_ESCAPE        (0x0f)
+#define OPCODE_PSHUFD            (0x70) /* 0x66 0x0f 0x70 /r ib */
+#define OPCODE_MOVQ_RM64_TO_XMM  (0x6e) /* 0x66 REX.W 0x0f 0x6e /r */
+#define OPCODE_MOVQ_XMM_TO_RM64  (0x7e) /* 0x66 REX.W 0x0f 0x7e /r */
+#define OPCODE_MOVDQU_M_TO_XMM   (0x6f) /* 0xf3 0x0f 0x6f /r */
+#define OPCODE_MOVDQU_XMM_TO_M   (0x7f) /* 0xf3 0x0f 0x7f /r */
+
+void asm_x64_sse_op_xmm_xmm(asm_x64_t *as, int op, int dest_xmm, int src_xmm) {
+    assert(dest_xmm < 8 && src_xmm < 8);
+    asm_x64_write_byte_2(as, OPCODE_SSE_PREFIX_66, OPCODE_SSE_ESCAPE);
+    asm_x64_write_byte_2(as, op, MODRM_R64(dest_xmm) | MODRM_RM_REG | MODRM_RM_R64(src_xmm));
+}
+
+void asm_x64_sse_pshufd(asm_x64_t *as, int dest_xmm, int src_xmm, int order) {
+    asm_x64_sse_op_xmm_xmm(as, OPCODE_PSHUFD, dest_xmm, src_xmm);
+    asm_x64_write_byte_1(as, order);
+}
+
+void asm_x64_sse_movq_r64_to_xmm(asm_x64_t *as, int src_r64, int dest_xmm) {
+    assert(dest_xmm < 8);
+    asm_x64_write_byte_3(as, OPCODE_SSE_PREFIX_66, REX_PREFIX | REX_W | REX_B_FROM_R64(src_r64), OPCODE_SSE_ESCAPE);
+    asm_x64_write_byte_2(as, OPCODE_MOVQ_RM64_TO_XMM, MODRM_R64(dest_xmm) | MODRM_RM_REG | MODRM_RM_R64(src_r64));
+}
+
+void asm_x64_sse_movq_xmm_to_r64(asm_x64_t *as, int src_xmm, int dest_r64) {
+    assert(src_xmm < 8);
+    asm_x64_write_byte_3(as, OPCODE_SSE_PREFIX_66, REX_PREFIX | REX_W | REX_B_FROM_R64(dest_r64), OPCODE_SSE_ESCAPE);
+    asm_x64_write_byte_2(as, OPCODE_MOVQ_XMM_TO_RM64, MODRM_R64(src_xmm) | MODRM_RM_REG | MODRM_RM_R64(dest_r64));
+}
+
+// scale is 1, 2, 4 or 8; the base can't be rbp because that needs a displacement
+STATIC void asm_x64_sse_movdqu(asm_x64_t *as, int op, int xmm, int base_r64, int index_r64, int scale) {
+    assert(xmm < 8 && base_r64 < 8 && index_r64 < 8);
+    assert(base_r64 != ASM_X64_REG_RBP && index_r64 != ASM_X64_REG_RSP);
+    int ss = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+    asm_x64_write_byte_3(as, OPCODE_SSE_PREFIX_F3, OPCODE_SSE_ESCAPE, op);
+    asm_x64_write_byte_2(as, MODRM_R64(xmm) | MODRM_RM_DISP0 | MODRM_RM_R64(ASM_X64_REG_RSP), ss << 6 | index_r64 << 3 | base_r64);
+}
+
+void asm_x64_sse_movdqu_mem_to_xmm(asm_x64_t *as, int base_r64, int index_r64, int scale, int dest_xmm) {
+    asm_x64_sse_movdqu(as, OPCODE_MOVDQU_M_TO_XMM, dest_xmm, base_r64, index_r64, scale);
+}
+
+void asm_x64_sse_movdqu_xmm_to_mem(asm_x64_t *as, int src_xmm, int base_r64, int index_r64, int scale) {
+    asm_x64_sse_movdqu(as, OPCODE_MOVDQU_XMM_TO_M, src_xmm, base_r64, index_r64, scale);
+}
+
 #endif // MICROPY_EMIT_X64
@@ -60,6 +60,7 @@
 #define ASM_X64_REG_R15 (15)
 
 // condition codes, used for jcc and setcc (despite their j-name!)
+#define ASM_X64_CC_JO  (0x0) // overflow, signed
 #define ASM_X64_CC_JB  (0x2) // below, unsigned
 #define ASM_X64_CC_JZ  (0x4)
 #define ASM_X64_CC_JE  (0x4)
@@ -70,6 +71,21 @@
 #define ASM_X64_CC_JLE (0xe) // less or equal, signed
 #define ASM_X64_CC_JG  (0xf) // greater, signed
 
+// SSE2 integer ops on xmm registers, for use with asm_x64_sse_op_xmm_xmm
+#define ASM_X64_SSE_PUNPCKLBW (0x60)
+#define ASM_X64_SSE_PUNPCKLWD (0x61)
+#define ASM_X64_SSE_PADDQ     (0xd4)
+#define ASM_X64_SSE_PAND      (0xdb)
+#define ASM_X64_SSE_POR       (0xeb)
+#define ASM_X64_SSE_PXOR      (0xef)
+#define ASM_X64_SSE_PSADBW    (0xf6)
+#define ASM_X64_SSE_PSUBB     (0xf8)
+#define ASM_X64_SSE_PSUBW     (0xf9)
+#define ASM_X64_SSE_PSUBD     (0xfa)
+#define ASM_X64_SSE_PADDB     (0xfc)
+#define ASM_X64_SSE_PADDW     (0xfd)
+#define ASM_X64_SSE_PADDD     (0xfe)
+
 typedef struct _asm_x64_t {
     mp_asm_base_t base;
     int num_locals;
@@ -101,9 +117,11 @@ void asm_x64_shl_r64_cl(asm_x64_t* as, int dest_r64);
 void asm_x64_sar_r64_cl(asm_x64_t* as, int dest_r64);
 void asm_x64_add_r64_r64(asm_x64_t* as, int dest_r64, int src_r64);
 void asm_x64_sub_r64_r64(asm_x64_t* as, int dest_r64, int src_r64);
+void asm_x64_sub_r64_i32(asm_x64_t *as, int dest_r64, int src_i32);
 void asm_x64_mul_r64_r64(asm_x64_t* as, int dest_r64, int src_r64);
 void asm_x64_cmp_r64_with_r64(asm_x64_t* as, int src_r64_a, int src_r64_b);
 void asm_x64_test_r8_with_r8(asm_x64_t* as, int src_r64_a, int src_r64_b);
+void asm_x64_test_r8_with_i8(asm_x64_t *as, int src_r64, int src_i8);
 void asm_x64_setcc_r8(asm_x64_t* as, int jcc_type, int dest_r8);
 void asm_x64_jmp_label(asm_x64_t* as, mp_uint_t label);
 void asm_x64_jcc_label(asm_x64_t* as, int jcc_type, mp_uint_t label);
@@ -114,6 +132,14 @@ void asm_x64_mov_r64_to_local(asm_x64_t* as, int src_r64, int dest_local_num);
 void asm_x64_mov_local_addr_to_r64(asm_x64_t* as, int local_num, int dest_r64);
 void asm_x64_call_ind(asm_x64_t* as, void* ptr, int temp_r32);
 
+// SSE2; only xmm0-xmm7 are supported, and memory operands are [base + index * scale]
+void asm_x64_sse_op_xmm_xmm(asm_x64_t *as, int op, int dest_xmm, int src_xmm);
+void asm_x64_sse_pshufd(asm_x64_t *as, int dest_xmm, int src_xmm, int order);
+void asm_x64_sse_movq_r64_to_xmm(asm_x64_t *as, int src_r64, int dest_xmm);
+void asm_x64_sse_movq_xmm_to_r64(asm_x64_t *as, int src_xmm, int dest_r64);
+void asm_x64_sse_movdqu_mem_to_xmm(asm_x64_t *as, int base_r64, int index_r64, int scale, int dest_xmm);
+void asm_x64_sse_movdqu_xmm_to_mem(asm_x64_t *as, int src_xmm, int base_r64, int index_r64, int scale);
+
 #ifdef GENERIC_ASM_API
 
 // The following macros provide a (mostly) arch-independent API to
@@ -137,7 +163,9 @@ void asm_x64_call_ind(asm_x64_t* as, void* ptr, int temp_r32);
 #define REG_LOCAL_1 ASM_X64_REG_RBX
 #define REG_LOCAL_2 ASM_X64_REG_R12
 #define REG_LOCAL_3 ASM_X64_REG_R13
-#define REG_LOCAL_NUM (3)
+#define REG_LOCAL_4 ASM_X64_REG_R14
+#define REG_LOCAL_5 ASM_X64_REG_R15
+#define REG_LOCAL_NUM (5)
 
 #define ASM_T               asm_x64_t
 #define ASM_END_PASS        asm_x64_end_pass
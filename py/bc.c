@@ -285,7 +285,7 @@ continue2:;
     dump_args(code_state->state, n_state);
 }
 
-#if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
+#if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE || MICROPY_OPT_QUICKEN_BYTECODE
 
 // The following table encodes the number of bytes that a specific opcode
 // takes up.  There are 3 special opcodes that always have an extra byte:
@@ -323,7 +323,7 @@ STATIC const byte opcode_format_table[64] = {
     OC4(U, O, B, O), // 0x3c-0x3f
     OC4(O, B, B, O), // 0x40-0x43
     OC4(B, B, O, B), // 0x44-0x47
-    OC4(U, U, U, U), // 0x48-0x4b
+    OC4(B, B, O, U), // 0x48-0x4b
     OC4(U, U, U, U), // 0x4c-0x4f
     OC4(V, V, U, V), // 0x50-0x53
     OC4(B, U, V, V), // 0x54-0x57
@@ -386,20 +386,20 @@ STATIC const byte opcode_format_table[64] = {
 uint mp_opcode_format(const byte *ip, size_t *opcode_size) {
     uint f = (opcode_format_table[*ip >> 2] >> (2 * (*ip & 3))) & 3;
     const byte *ip_start = ip;
+    int extra_byte = (
+        *ip == MP_BC_RAISE_VARARGS
+        || *ip == MP_BC_MAKE_CLOSURE
+        || *ip == MP_BC_MAKE_CLOSURE_DEFARGS
+        #if MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
+        || *ip == MP_BC_LOAD_NAME
+        || *ip == MP_BC_LOAD_GLOBAL
+        || *ip == MP_BC_LOAD_ATTR
+        || *ip == MP_BC_STORE_ATTR
+        #endif
+    );
     if (f == MP_OPCODE_QSTR) {
         ip += 3;
     } else {
-        int extra_byte = (
-            *ip == MP_BC_RAISE_VARARGS
-            || *ip == MP_BC_MAKE_CLOSURE
-            || *ip == MP_BC_MAKE_CLOSURE_DEFARGS
-            #if MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
-            || *ip == MP_BC_LOAD_NAME
-            || *ip == MP_BC_LOAD_GLOBAL
-            || *ip == MP_BC_LOAD_ATTR
-            || *ip == MP_BC_STORE_ATTR
-            #endif
-        );
         ip += 1;
         if (f == MP_OPCODE_VAR_UINT) {
             while ((*ip++ & 0x80) != 0) {
@@ -407,10 +407,102 @@ uint mp_opcode_format(const byte *ip, size_t *opcode_size) {
         } else if (f == MP_OPCODE_OFFSET) {
             ip += 2;
         }
-        ip += extra_byte;
     }
+    ip += extra_byte;
     *opcode_size = ip - ip_start;
     return f;
 }
 
-#endif // MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
+#endif // MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE || MICROPY_OPT_QUICKEN_BYTECODE
+
+#if MICROPY_OPT_QUICKEN_BYTECODE
+
+#if MICROPY_PERSISTENT_CODE_SAVE
+#error "MICROPY_OPT_QUICKEN_BYTECODE is incompatible with MICROPY_PERSISTENT_CODE_SAVE"
+#endif
+
+// The binary operations that have a small-int specialised opcode
+const byte mp_bc_quick_binary_op[MP_BC_QUICK_BINARY_OP_NUM] = {
+    MP_BINARY_OP_LESS,
+    MP_BINARY_OP_MORE,
+    MP_BINARY_OP_LESS_EQUAL,
+    MP_BINARY_OP_MORE_EQUAL,
+    MP_BINARY_OP_INPLACE_ADD,
+    MP_BINARY_OP_INPLACE_SUBTRACT,
+    MP_BINARY_OP_ADD,
+    MP_BINARY_OP_SUBTRACT,
+};
+
+#define IS_LOAD_FAST_MULTI(b) ((b) >= MP_BC_LOAD_FAST_MULTI && (b) < MP_BC_LOAD_FAST_MULTI + 16)
+#define IS_LOAD_CONST_SMALL_INT_MULTI(b) ((b) >= MP_BC_LOAD_CONST_SMALL_INT_MULTI && (b) < MP_BC_LOAD_CONST_SMALL_INT_MULTI + 64)
+#define IS_POP_JUMP(b) ((b) == MP_BC_POP_JUMP_IF_TRUE || (b) == MP_BC_POP_JUMP_IF_FALSE)
+
+STATIC bool is_compare_op(byte b) {
+    return b >= MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_LESS && b <= MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_NOT_EQUAL;
+}
+
+STATIC bool is_add_sub_op(byte b) {
+    return b == MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_ADD
+        || b == MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_SUBTRACT
+        || b == MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_INPLACE_ADD
+        || b == MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_INPLACE_SUBTRACT;
+}
+
+// Rewrite the bytecode of a function, starting at its prelude, to use the
+// quickened opcodes.  Only the first byte of each matched sequence changes,
+// so any jump into the middle of a sequence still finds the original code.
+void mp_bytecode_quicken(byte *code, const byte *top) {
+    // skip the prelude
+    const byte *ip_prelude = code;
+    mp_decode_uint(&ip_prelude); // n_state
+    mp_decode_uint(&ip_prelude); // n_exc_stack
+    ip_prelude += 4; // scope_flags, n_pos_args, n_kwonly_args, n_def_pos_args
+    const byte *ip2 = ip_prelude;
+    ip_prelude += mp_decode_uint(&ip2); // code_info_size
+    while (*ip_prelude++ != 255) { // local_num of cells
+    }
+    byte *ip = code + (ip_prelude - code);
+
+    while (ip < top) {
+        byte op = ip[0];
+        size_t avail = top - ip;
+        if (IS_LOAD_FAST_MULTI(op) && avail >= 4
+            && IS_LOAD_CONST_SMALL_INT_MULTI(ip[1]) && is_add_sub_op(ip[2])
+            && ip[3] == MP_BC_STORE_FAST_MULTI + (op - MP_BC_LOAD_FAST_MULTI)) {
+            // x += c
+            ip[0] = MP_BC_QUICK_FAST_INPLACE_CONST;
+            ip += 4;
+            continue;
+        }
+        if (IS_LOAD_FAST_MULTI(op) && avail >= 6
+            && (IS_LOAD_FAST_MULTI(ip[1]) || IS_LOAD_CONST_SMALL_INT_MULTI(ip[1]))
+            && is_compare_op(ip[2]) && IS_POP_JUMP(ip[3])) {
+            // while x < y
+            ip[0] = MP_BC_QUICK_FAST_CMP_JUMP_MULTI + (op - MP_BC_LOAD_FAST_MULTI);
+            ip += 6;
+            continue;
+        }
+        if (op == MP_BC_DUP_TOP_TWO && avail >= 6
+            && ip[1] == MP_BC_ROT_TWO && is_compare_op(ip[2]) && IS_POP_JUMP(ip[3])) {
+            // end condition of an optimised "for x in range(...)" loop
+            ip[0] = MP_BC_QUICK_RANGE_CMP_JUMP;
+            ip += 6;
+            continue;
+        }
+        size_t sz;
+        mp_opcode_format(ip, &sz);
+        if (op == MP_BC_FOR_ITER) {
+            ip[0] = MP_BC_QUICK_FOR_ITER_RANGE;
+        } else if (op >= MP_BC_BINARY_OP_MULTI && op < MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_NUM_BYTECODE) {
+            for (size_t i = 0; i < MP_BC_QUICK_BINARY_OP_NUM; ++i) {
+                if (op == MP_BC_BINARY_OP_MULTI + mp_bc_quick_binary_op[i]) {
+                    ip[0] = MP_BC_QUICK_BINARY_OP_MULTI + i;
+                    break;
+                }
+            }
+        }
+        ip += sz;
+    }
+}
+
+#endif // MICROPY_OPT_QUICKEN_BYTECODE
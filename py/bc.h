@@ -107,7 +107,7 @@ const byte *mp_bytecode_print_str(const byte *ip);
 #define MP_TAGPTR_TAG1(x) ((uintptr_t)(x) & 2)
 #define MP_TAGPTR_MAKE(ptr, tag) ((void*)((uintptr_t)(ptr) | (tag)))
 
-#if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
+#if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE || MICROPY_OPT_QUICKEN_BYTECODE
 
 #define MP_OPCODE_BYTE (0)
 #define MP_OPCODE_QSTR (1)
@@ -118,4 +118,10 @@ uint mp_opcode_format(const byte *ip, size_t *opcode_size);
 
 #endif
 
+#if MICROPY_OPT_QUICKEN_BYTECODE
+#define MP_BC_QUICK_BINARY_OP_NUM (8)
+extern const byte mp_bc_quick_binary_op[MP_BC_QUICK_BINARY_OP_NUM];
+void mp_bytecode_quicken(byte *code, const byte *top);
+#endif
+
 #endif // MICROPY_INCLUDED_PY_BC_H
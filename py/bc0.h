@@ -116,4 +116,14 @@
 #define MP_BC_UNARY_OP_MULTI             (0xd0) // + op(<MP_UNARY_OP_NUM_BYTECODE)
 #define MP_BC_BINARY_OP_MULTI            (0xd7) // + op(<MP_BINARY_OP_NUM_BYTECODE)
 
+// Quickened byte-codes.  These are never emitted by the compiler, they are
+// only written over the first byte of an existing sequence by
+// mp_bytecode_quicken(), and the original byte can always be recovered from
+// the rest of the sequence.  The arguments are those of the sequence.
+#define MP_BC_QUICK_FAST_CMP_JUMP_MULTI  (0x00) // + N(16); LOAD_FAST_MULTI N; LOAD_FAST_MULTI/LOAD_CONST_SMALL_INT_MULTI; BINARY_OP_MULTI cmp; POP_JUMP_IF_TRUE/FALSE
+#define MP_BC_QUICK_FAST_INPLACE_CONST   (0x48) // LOAD_FAST_MULTI N; LOAD_CONST_SMALL_INT_MULTI; BINARY_OP_MULTI add/sub; STORE_FAST_MULTI N
+#define MP_BC_QUICK_RANGE_CMP_JUMP       (0x49) // DUP_TOP_TWO; ROT_TWO; BINARY_OP_MULTI cmp; POP_JUMP_IF_TRUE/FALSE
+#define MP_BC_QUICK_FOR_ITER_RANGE       (0x4a) // FOR_ITER
+#define MP_BC_QUICK_BINARY_OP_MULTI      (0xf8) // + N(MP_BC_QUICK_BINARY_OP_NUM); BINARY_OP_MULTI mp_bc_quick_binary_op[N]
+
 #endif // MICROPY_INCLUDED_PY_BC0_H
@@ -1348,6 +1348,166 @@ STATIC void compile_while_stmt(compiler_t *comp, mp_parse_node_struct_t *pns) {
 //  - assignments to <var>, <end> or <step> in the body do not alter the loop
 //    (<step> is a constant for us, so no need to worry about it changing)
 //
+#if MICROPY_EMIT_NATIVE
+// Helpers to match the body of a viper for-loop that can be handed to the
+// emitter's vector_loop.  An element is <name>[<var>] and a scalar is a
+// small-int or a name other than <var>.
+STATIC bool vector_loop_is_elem(mp_parse_node_t pn, qstr var, mp_parse_node_t *pn_base) {
+    if (!MP_PARSE_NODE_IS_STRUCT_KIND(pn, PN_atom_expr_normal)) {
+        return false;
+    }
+    mp_parse_node_struct_t *pns = (mp_parse_node_struct_t*)pn;
+    if (!MP_PARSE_NODE_IS_ID(pns->nodes[0]) || MP_PARSE_NODE_LEAF_ARG(pns->nodes[0]) == var
+        || !MP_PARSE_NODE_IS_STRUCT_KIND(pns->nodes[1], PN_trailer_bracket)) {
+        return false;
+    }
+    mp_parse_node_t pn_index = ((mp_parse_node_struct_t*)pns->nodes[1])->nodes[0];
+    if (!MP_PARSE_NODE_IS_ID(pn_index) || MP_PARSE_NODE_LEAF_ARG(pn_index) != var) {
+        return false;
+    }
+    *pn_base = pns->nodes[0];
+    return true;
+}
+
+STATIC bool vector_loop_is_scalar(mp_parse_node_t pn, qstr var) {
+    return MP_PARSE_NODE_IS_SMALL_INT(pn) || (MP_PARSE_NODE_IS_ID(pn) && MP_PARSE_NODE_LEAF_ARG(pn) != var);
+}
+
+// Match one of:
+//  <dst>[<var>] <op>= <k> or <src>[<var>]
+//  <dst>[<var>] = <src>[<var>] <op> <k> or <src2>[<var>]
+//  <dst>[<var>] = <src>[<var>]
+//  <acc> += <src>[<var>]
+// where <op> is one of + - & | ^.  Fills in pn_opnd[] with the operands as
+// given by MP_EMIT_VECTOR_xxx, a null <k> meaning zero.
+STATIC bool vector_loop_match(mp_parse_node_t pn_body, qstr var, mp_uint_t *kind, mp_binary_op_t *op, mp_parse_node_t *pn_opnd) {
+    mp_parse_node_t *nodes;
+    if (mp_parse_node_extract_list(&pn_body, PN_suite_block_stmts, &nodes) != 1
+        || !MP_PARSE_NODE_IS_STRUCT_KIND(nodes[0], PN_expr_stmt)) {
+        return false;
+    }
+    mp_parse_node_struct_t *pns = (mp_parse_node_struct_t*)nodes[0];
+    mp_parse_node_t pn_lhs = pns->nodes[0];
+
+    if (MP_PARSE_NODE_IS_STRUCT_KIND(pns->nodes[1], PN_expr_stmt_augassign)) {
+        mp_parse_node_struct_t *pns1 = (mp_parse_node_struct_t*)pns->nodes[1];
+        mp_parse_node_t pn_rhs = pns1->nodes[1];
+        switch (MP_PARSE_NODE_LEAF_ARG(pns1->nodes[0])) {
+            case MP_TOKEN_DEL_PLUS_EQUAL: *op = MP_BINARY_OP_ADD; break;
+            case MP_TOKEN_DEL_MINUS_EQUAL: *op = MP_BINARY_OP_SUBTRACT; break;
+            case MP_TOKEN_DEL_AMPERSAND_EQUAL: *op = MP_BINARY_OP_AND; break;
+            case MP_TOKEN_DEL_PIPE_EQUAL: *op = MP_BINARY_OP_OR; break;
+            case MP_TOKEN_DEL_CARET_EQUAL: *op = MP_BINARY_OP_XOR; break;
+            default: return false;
+        }
+        if (MP_PARSE_NODE_IS_ID(pn_lhs) && MP_PARSE_NODE_LEAF_ARG(pn_lhs) != var
+            && *op == MP_BINARY_OP_ADD && vector_loop_is_elem(pn_rhs, var, &pn_opnd[1])) {
+            *kind = MP_EMIT_VECTOR_SUM;
+            pn_opnd[0] = pn_lhs;
+            return true;
+        }
+        if (!vector_loop_is_elem(pn_lhs, var, &pn_opnd[0])) {
+            return false;
+        }
+        pn_opnd[1] = pn_opnd[0];
+        if (vector_loop_is_elem(pn_rhs, var, &pn_opnd[2])) {
+            *kind = MP_EMIT_VECTOR_MAP_PTR;
+        } else if (vector_loop_is_scalar(pn_rhs, var)) {
+            *kind = MP_EMIT_VECTOR_MAP_SCALAR;
+            pn_opnd[2] = pn_rhs;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // a single plain assignment has the rhs directly in the expr_stmt
+    if (MP_PARSE_NODE_IS_NULL(pns->nodes[1])
+        || MP_PARSE_NODE_IS_STRUCT_KIND(pns->nodes[1], PN_expr_stmt_assign_list)
+        || !vector_loop_is_elem(pn_lhs, var, &pn_opnd[0])) {
+        return false;
+    }
+    mp_parse_node_t pn_rhs = pns->nodes[1];
+    if (vector_loop_is_elem(pn_rhs, var, &pn_opnd[1])) {
+        // a copy is done as an or with zero
+        *kind = MP_EMIT_VECTOR_MAP_SCALAR;
+        *op = MP_BINARY_OP_OR;
+        pn_opnd[2] = MP_PARSE_NODE_NULL;
+        return true;
+    }
+    if (!MP_PARSE_NODE_IS_STRUCT(pn_rhs)) {
+        return false;
+    }
+    mp_parse_node_struct_t *pns_rhs = (mp_parse_node_struct_t*)pn_rhs;
+    mp_parse_node_t pn_a, pn_b;
+    switch (MP_PARSE_NODE_STRUCT_KIND(pns_rhs)) {
+        case PN_arith_expr:
+            if (MP_PARSE_NODE_STRUCT_NUM_NODES(pns_rhs) != 3) {
+                return false;
+            }
+            *op = MP_PARSE_NODE_LEAF_ARG(pns_rhs->nodes[1]) == MP_TOKEN_OP_PLUS ? MP_BINARY_OP_ADD : MP_BINARY_OP_SUBTRACT;
+            pn_a = pns_rhs->nodes[0];
+            pn_b = pns_rhs->nodes[2];
+            break;
+        case PN_and_expr: *op = MP_BINARY_OP_AND; goto two_nodes;
+        case PN_xor_expr: *op = MP_BINARY_OP_XOR; goto two_nodes;
+        case PN_expr: *op = MP_BINARY_OP_OR;
+        two_nodes:
+            if (MP_PARSE_NODE_STRUCT_NUM_NODES(pns_rhs) != 2) {
+                return false;
+            }
+            pn_a = pns_rhs->nodes[0];
+            pn_b = pns_rhs->nodes[1];
+            break;
+        default:
+            return false;
+    }
+    if (!vector_loop_is_elem(pn_a, var, &pn_opnd[1])) {
+        return false;
+    }
+    if (vector_loop_is_elem(pn_b, var, &pn_opnd[2])) {
+        *kind = MP_EMIT_VECTOR_MAP_PTR;
+    } else if (vector_loop_is_scalar(pn_b, var)) {
+        *kind = MP_EMIT_VECTOR_MAP_SCALAR;
+        pn_opnd[2] = pn_b;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// With the stack as for the loop below, let the emitter run as much of the
+// loop as it can, leaving the stack with the value of <var> to continue from.
+// The final iteration is always left to the loop itself.
+STATIC void compile_for_stmt_vector_loop(compiler_t *comp, qstr var, mp_parse_node_t pn_end, mp_parse_node_t pn_body, bool end_on_stack) {
+    mp_uint_t kind;
+    mp_binary_op_t op;
+    mp_parse_node_t pn_opnd[3];
+    if (!vector_loop_match(pn_body, var, &kind, &op, pn_opnd)) {
+        return;
+    }
+    if (end_on_stack) {
+        EMIT(rot_two);
+        EMIT(dup_top);
+        EMIT(rot_three);
+    } else {
+        compile_node(comp, pn_end);
+    }
+    int n_opnd = kind == MP_EMIT_VECTOR_SUM ? 2 : 3;
+    for (int i = 0; i < n_opnd; i++) {
+        if (MP_PARSE_NODE_IS_NULL(pn_opnd[i])) {
+            EMIT_ARG(load_const_small_int, 0);
+        } else {
+            compile_node(comp, pn_opnd[i]);
+        }
+    }
+    EMIT_ARG(vector_loop, kind, op);
+    if (kind == MP_EMIT_VECTOR_SUM) {
+        compile_store_id(comp, MP_PARSE_NODE_LEAF_ARG(pn_opnd[0]));
+    }
+}
+#endif
+
 // If <end> is a small-int, then the stack during the for-loop contains just
 // the current value of <var>.  Otherwise, the stack contains <end> then the
 // current value of <var>.
@@ -1366,6 +1526,14 @@ STATIC void compile_for_stmt_optimised_range(compiler_t *comp, mp_parse_node_t p
     // compile: start
     compile_node(comp, pn_start);
 
+    #if MICROPY_EMIT_NATIVE
+    if (comp->pass > MP_PASS_SCOPE && comp->scope_cur->emit_options == MP_EMIT_OPT_VIPER
+        && MP_PARSE_NODE_IS_ID(pn_var) && MP_PARSE_NODE_IS_SMALL_INT(pn_step)
+        && MP_PARSE_NODE_LEAF_SMALL_INT(pn_step) == 1) {
+        compile_for_stmt_vector_loop(comp, MP_PARSE_NODE_LEAF_ARG(pn_var), pn_end, pn_body, end_on_stack);
+    }
+    #endif
+
     EMIT_ARG(jump, entry_label);
     EMIT_ARG(label_assign, top_label);
 
@@ -55,6 +55,12 @@ typedef enum {
 #define MP_EMIT_NATIVE_TYPE_RETURN (1)
 #define MP_EMIT_NATIVE_TYPE_ARG    (2)
 
+// kinds of loop for vector_loop, which is only used by the viper emitter;
+// the stack holds start and end of the range followed by the operands
+#define MP_EMIT_VECTOR_MAP_PTR    (0) // operands dst, src1, src2: dst[i] = src1[i] op src2[i]
+#define MP_EMIT_VECTOR_MAP_SCALAR (1) // operands dst, src, k: dst[i] = src[i] op k
+#define MP_EMIT_VECTOR_SUM        (2) // operands acc, src: acc += src[i]
+
 typedef struct _emit_t emit_t;
 
 typedef struct _mp_emit_method_table_id_ops_t {
@@ -66,6 +72,7 @@ typedef struct _mp_emit_method_table_id_ops_t {
 
 typedef struct _emit_method_table_t {
     void (*set_native_type)(emit_t *emit, mp_uint_t op, mp_uint_t arg1, qstr arg2);
+    void (*vector_loop)(emit_t *emit, mp_uint_t kind, mp_binary_op_t op);
     void (*start_pass)(emit_t *emit, pass_kind_t pass, scope_t *scope);
     void (*end_pass)(emit_t *emit);
     bool (*last_emit_was_return_value)(emit_t *emit);
@@ -80,6 +80,11 @@ void mp_emit_glue_assign_bytecode(mp_raw_code_t *rc, const byte *code, mp_uint_t
         mp_bytecode_print(rc, code, len, const_table);
     }
 #endif
+
+#if MICROPY_OPT_QUICKEN_BYTECODE
+    // bytecode passed in here is always in RAM
+    mp_bytecode_quicken((byte*)code, code + len);
+#endif
 }
 
 #if MICROPY_EMIT_NATIVE || MICROPY_EMIT_INLINE_ASM
@@ -154,6 +154,21 @@ STATIC byte mp_f_n_args[MP_F_NUMBER_OF] = {
 
 #endif
 
+// On x64 with the default object representation the add/subtract and compare
+// binary ops get an inline fast path for the case of two small ints.
+#define NATIVE_INLINE_SMALL_INT (N_X64 && MICROPY_OBJ_REPR == MICROPY_OBJ_REPR_A)
+
+// callee-save registers available to hold locals, in order of preference
+STATIC const byte reg_local_table[REG_LOCAL_NUM] = {
+    REG_LOCAL_1, REG_LOCAL_2, REG_LOCAL_3,
+    #if REG_LOCAL_NUM > 3
+    REG_LOCAL_4, REG_LOCAL_5,
+    #endif
+};
+
+// marks a local that is not held in a register
+#define LOCAL_IN_MEMORY (0xff)
+
 #define EMIT_NATIVE_VIPER_TYPE_ERROR(emit, ...) do { \
         *emit->error_slot = mp_obj_new_exception_msg_varg(&mp_type_ViperTypeError, __VA_ARGS__); \
     } while (0)
@@ -215,6 +230,8 @@ struct _emit_t {
 
     mp_uint_t local_vtype_alloc;
     vtype_kind_t *local_vtype;
+    byte *local_reg; // register holding each local, or LOCAL_IN_MEMORY
+    uint16_t *local_use; // number of loads/stores of each local, counted in stack-size pass
 
     mp_uint_t stack_info_alloc;
     stack_info_t *stack_info;
@@ -228,6 +245,10 @@ struct _emit_t {
 
     bool last_emit_was_return_value;
 
+    // labels private to the emitter are numbered after those of the compiler
+    mp_uint_t label_base;
+    mp_uint_t label_next;
+
     scope_t *scope;
 
     ASM_T *as;
@@ -238,6 +259,7 @@ emit_t *EXPORT_FUN(new)(mp_obj_t *error_slot, mp_uint_t max_num_labels) {
     emit->error_slot = error_slot;
     emit->as = m_new0(ASM_T, 1);
     mp_asm_base_init(&emit->as->base, max_num_labels);
+    emit->label_base = max_num_labels;
     return emit;
 }
 
@@ -245,6 +267,8 @@ void EXPORT_FUN(free)(emit_t *emit) {
     mp_asm_base_deinit(&emit->as->base, false);
     m_del_obj(ASM_T, emit->as);
     m_del(vtype_kind_t, emit->local_vtype, emit->local_vtype_alloc);
+    m_del(byte, emit->local_reg, emit->local_vtype_alloc);
+    m_del(uint16_t, emit->local_use, emit->local_vtype_alloc);
     m_del(stack_info_t, emit->stack_info, emit->stack_info_alloc);
     m_del_obj(emit_t, emit);
 }
@@ -286,6 +310,45 @@ STATIC void emit_native_store_fast(emit_t *emit, qstr qst, mp_uint_t local_num);
 
 #define STATE_START (sizeof(mp_code_state_t) / sizeof(mp_uint_t))
 
+// Assign the callee-save registers to locals.  There is no liveness analysis:
+// every local is live for the whole function, so a linear scan over the live
+// ranges reduces to giving the registers to the locals with the most uses.
+// Functions with an exception handler keep all locals in memory because
+// nlr_jump restores the callee-save registers to their values at nlr_push.
+STATIC void emit_native_alloc_local_regs(emit_t *emit) {
+    scope_t *scope = emit->scope;
+    memset(emit->local_reg, LOCAL_IN_MEMORY, scope->num_locals);
+    if (emit->pass == MP_PASS_STACK_SIZE) {
+        // this pass counts the uses, the allocation is done for later passes
+        memset(emit->local_use, 0, scope->num_locals * sizeof(uint16_t));
+        return;
+    }
+    if (scope->exc_stack_size > 0) {
+        return;
+    }
+    for (int r = 0; r < REG_LOCAL_NUM; r++) {
+        mp_uint_t best = scope->num_locals;
+        for (mp_uint_t i = 0; i < scope->num_locals; i++) {
+            if (emit->local_reg[i] == LOCAL_IN_MEMORY && emit->local_use[i] > 0
+                && (best == scope->num_locals || emit->local_use[i] > emit->local_use[best])) {
+                best = i;
+            }
+        }
+        if (best == scope->num_locals) {
+            break;
+        }
+        emit->local_reg[best] = reg_local_table[r];
+    }
+}
+
+// returns the register holding the given local, or LOCAL_IN_MEMORY
+STATIC int emit_native_local_reg(emit_t *emit, mp_uint_t local_num) {
+    if (emit->pass == MP_PASS_STACK_SIZE && emit->local_use[local_num] < UINT16_MAX) {
+        emit->local_use[local_num] += 1;
+    }
+    return emit->local_reg[local_num];
+}
+
 STATIC void emit_native_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scope) {
     DEBUG_printf("start_pass(pass=%u, scope=%p)\n", pass, scope);
 
@@ -293,13 +356,19 @@ STATIC void emit_native_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scop
     emit->stack_start = 0;
     emit->stack_size = 0;
     emit->last_emit_was_return_value = false;
+    emit->label_next = emit->label_base;
     emit->scope = scope;
 
-    // allocate memory for keeping track of the types of locals
+    // allocate memory for keeping track of the types and registers of locals
     if (emit->local_vtype_alloc < scope->num_locals) {
         emit->local_vtype = m_renew(vtype_kind_t, emit->local_vtype, emit->local_vtype_alloc, scope->num_locals);
+        emit->local_reg = m_renew(byte, emit->local_reg, emit->local_vtype_alloc, scope->num_locals);
+        emit->local_use = m_renew(uint16_t, emit->local_use, emit->local_vtype_alloc, scope->num_locals);
         emit->local_vtype_alloc = scope->num_locals;
     }
+    if (pass == MP_PASS_STACK_SIZE || pass == MP_PASS_CODE_SIZE) {
+        emit_native_alloc_local_regs(emit);
+    }
 
     // allocate memory for keeping track of the objects on the stack
     // XXX don't know stack size on entry, and it should be maximum over all scopes
@@ -347,13 +416,10 @@ STATIC void emit_native_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scop
             return;
         }
 
-        // entry to function
+        // entry to function; every local gets a slot, whether it is used or not
         int num_locals = 0;
         if (pass > MP_PASS_SCOPE) {
-            num_locals = scope->num_locals - REG_LOCAL_NUM;
-            if (num_locals < 0) {
-                num_locals = 0;
-            }
+            num_locals = scope->num_locals;
             emit->stack_start = num_locals;
             num_locals += scope->stack_size;
         }
@@ -368,28 +434,22 @@ STATIC void emit_native_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scop
 
         #if N_X86
         for (int i = 0; i < scope->num_pos_args; i++) {
-            if (i == 0) {
-                asm_x86_mov_arg_to_r32(emit->as, i, REG_LOCAL_1);
-            } else if (i == 1) {
-                asm_x86_mov_arg_to_r32(emit->as, i, REG_LOCAL_2);
-            } else if (i == 2) {
-                asm_x86_mov_arg_to_r32(emit->as, i, REG_LOCAL_3);
+            int reg = emit->local_reg[i];
+            if (reg != LOCAL_IN_MEMORY) {
+                asm_x86_mov_arg_to_r32(emit->as, i, reg);
             } else {
                 asm_x86_mov_arg_to_r32(emit->as, i, REG_TEMP0);
-                asm_x86_mov_r32_to_local(emit->as, REG_TEMP0, i - REG_LOCAL_NUM);
+                asm_x86_mov_r32_to_local(emit->as, REG_TEMP0, i);
             }
         }
         #else
+        static const byte reg_arg_table[4] = {REG_ARG_1, REG_ARG_2, REG_ARG_3, REG_ARG_4};
         for (int i = 0; i < scope->num_pos_args; i++) {
-            if (i == 0) {
-                ASM_MOV_REG_REG(emit->as, REG_LOCAL_1, REG_ARG_1);
-            } else if (i == 1) {
-                ASM_MOV_REG_REG(emit->as, REG_LOCAL_2, REG_ARG_2);
-            } else if (i == 2) {
-                ASM_MOV_REG_REG(emit->as, REG_LOCAL_3, REG_ARG_3);
+            int reg = emit->local_reg[i];
+            if (reg != LOCAL_IN_MEMORY) {
+                ASM_MOV_REG_REG(emit->as, reg, reg_arg_table[i]);
             } else {
-                assert(i == 3); // should be true; max 4 args is checked above
-                ASM_MOV_REG_TO_LOCAL(emit->as, REG_ARG_4, i - REG_LOCAL_NUM);
+                ASM_MOV_REG_TO_LOCAL(emit->as, reg_arg_table[i], i);
             }
         }
         #endif
@@ -436,14 +496,10 @@ STATIC void emit_native_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scop
         ASM_CALL_IND(emit->as, mp_fun_table[MP_F_SETUP_CODE_STATE], MP_F_SETUP_CODE_STATE);
         #endif
 
-        // cache some locals in registers
-        if (scope->num_locals > 0) {
-            ASM_MOV_LOCAL_TO_REG(emit->as, STATE_START + emit->n_state - 1 - 0, REG_LOCAL_1);
-            if (scope->num_locals > 1) {
-                ASM_MOV_LOCAL_TO_REG(emit->as, STATE_START + emit->n_state - 1 - 1, REG_LOCAL_2);
-                if (scope->num_locals > 2) {
-                    ASM_MOV_LOCAL_TO_REG(emit->as, STATE_START + emit->n_state - 1 - 2, REG_LOCAL_3);
-                }
+        // cache the register-allocated locals
+        for (mp_uint_t i = 0; i < scope->num_locals; i++) {
+            if (emit->local_reg[i] != LOCAL_IN_MEMORY) {
+                ASM_MOV_LOCAL_TO_REG(emit->as, STATE_START + emit->n_state - 1 - i, emit->local_reg[i]);
             }
         }
 
@@ -862,6 +918,23 @@ STATIC void emit_get_stack_pointer_to_reg_for_push(emit_t *emit, mp_uint_t reg_d
     adjust_stack(emit, n_push);
 }
 
+#if N_X64
+// Allocate a label for use within the code of a single operation.  These are
+// handed out in the same order in each pass, so they get the same number in
+// each pass, and the label table is grown on the first pass that needs them.
+STATIC mp_uint_t emit_native_new_label(emit_t *emit) {
+    mp_asm_base_t *as = &emit->as->base;
+    mp_uint_t l = emit->label_next++;
+    if (l >= as->max_num_labels) {
+        size_t n = l + 8;
+        as->label_offsets = m_renew(size_t, as->label_offsets, as->max_num_labels, n);
+        memset(as->label_offsets + as->max_num_labels, -1, (n - as->max_num_labels) * sizeof(size_t));
+        as->max_num_labels = n;
+    }
+    return l;
+}
+#endif
+
 STATIC void emit_native_label_assign(emit_t *emit, mp_uint_t l) {
     DEBUG_printf("label_assign(" UINT_FMT ")\n", l);
     emit_native_pre(emit);
@@ -997,16 +1070,13 @@ STATIC void emit_native_load_fast(emit_t *emit, qstr qst, mp_uint_t local_num) {
         EMIT_NATIVE_VIPER_TYPE_ERROR(emit, "local '%q' used before type known", qst);
     }
     emit_native_pre(emit);
-    if (local_num == 0) {
-        emit_post_push_reg(emit, vtype, REG_LOCAL_1);
-    } else if (local_num == 1) {
-        emit_post_push_reg(emit, vtype, REG_LOCAL_2);
-    } else if (local_num == 2) {
-        emit_post_push_reg(emit, vtype, REG_LOCAL_3);
+    int reg = emit_native_local_reg(emit, local_num);
+    if (reg != LOCAL_IN_MEMORY) {
+        emit_post_push_reg(emit, vtype, reg);
     } else {
         need_reg_single(emit, REG_TEMP0, 0);
         if (emit->do_viper_types) {
-            ASM_MOV_LOCAL_TO_REG(emit->as, local_num - REG_LOCAL_NUM, REG_TEMP0);
+            ASM_MOV_LOCAL_TO_REG(emit->as, local_num, REG_TEMP0);
         } else {
             ASM_MOV_LOCAL_TO_REG(emit->as, STATE_START + emit->n_state - 1 - local_num, REG_TEMP0);
         }
@@ -1122,6 +1192,8 @@ STATIC void emit_native_load_subscr(emit_t *emit) {
             int reg_base = REG_ARG_1;
             int reg_index = REG_ARG_2;
             emit_pre_pop_reg_flexible(emit, &vtype_base, &reg_base, reg_index, reg_index);
+            need_reg_single(emit, reg_index, 0);
+            need_reg_single(emit, REG_RET, 0);
             switch (vtype_base) {
                 case VTYPE_PTR8: {
                     // pointer to 8-bit memory
@@ -1185,6 +1257,7 @@ STATIC void emit_native_load_subscr(emit_t *emit) {
             int reg_index = REG_ARG_2;
             emit_pre_pop_reg_flexible(emit, &vtype_index, &reg_index, REG_ARG_1, REG_ARG_1);
             emit_pre_pop_reg(emit, &vtype_base, REG_ARG_1);
+            need_reg_single(emit, REG_RET, 0);
             if (vtype_index != VTYPE_INT && vtype_index != VTYPE_UINT) {
                 EMIT_NATIVE_VIPER_TYPE_ERROR(emit,
                     "can't load with '%q' index", vtype_to_qstr(vtype_index));
@@ -1224,16 +1297,13 @@ STATIC void emit_native_load_subscr(emit_t *emit) {
 
 STATIC void emit_native_store_fast(emit_t *emit, qstr qst, mp_uint_t local_num) {
     vtype_kind_t vtype;
-    if (local_num == 0) {
-        emit_pre_pop_reg(emit, &vtype, REG_LOCAL_1);
-    } else if (local_num == 1) {
-        emit_pre_pop_reg(emit, &vtype, REG_LOCAL_2);
-    } else if (local_num == 2) {
-        emit_pre_pop_reg(emit, &vtype, REG_LOCAL_3);
+    int reg = emit_native_local_reg(emit, local_num);
+    if (reg != LOCAL_IN_MEMORY) {
+        emit_pre_pop_reg(emit, &vtype, reg);
     } else {
         emit_pre_pop_reg(emit, &vtype, REG_TEMP0);
         if (emit->do_viper_types) {
-            ASM_MOV_REG_TO_LOCAL(emit->as, REG_TEMP0, local_num - REG_LOCAL_NUM);
+            ASM_MOV_REG_TO_LOCAL(emit->as, REG_TEMP0, local_num);
         } else {
             ASM_MOV_REG_TO_LOCAL(emit->as, REG_TEMP0, STATE_START + emit->n_state - 1 - local_num);
         }
@@ -1338,6 +1408,7 @@ STATIC void emit_native_store_subscr(emit_t *emit) {
             #else
             emit_pre_pop_reg_flexible(emit, &vtype_value, &reg_value, reg_base, reg_index);
             #endif
+            need_reg_single(emit, reg_index, 0);
             if (vtype_value != VTYPE_BOOL && vtype_value != VTYPE_INT && vtype_value != VTYPE_UINT) {
                 EMIT_NATIVE_VIPER_TYPE_ERROR(emit,
                     "can't store '%q'", vtype_to_qstr(vtype_value));
@@ -1570,7 +1641,22 @@ STATIC void emit_native_jump_helper(emit_t *emit, bool pop) {
         if (!pop) {
             adjust_stack(emit, 1);
         }
+        #if NATIVE_INLINE_SMALL_INT
+        // the result of a comparison is True or False so test for those
+        // directly; the stack is settled first so both paths agree on it
+        need_reg_all(emit);
+        mp_uint_t l_done = emit_native_new_label(emit);
+        ASM_MOV_IMM_TO_REG(emit->as, (mp_uint_t)mp_const_true, REG_ARG_2);
+        ASM_MOV_IMM_TO_REG(emit->as, 1, REG_RET);
+        ASM_JUMP_IF_REG_EQ(emit->as, REG_ARG_1, REG_ARG_2, l_done);
+        ASM_MOV_IMM_TO_REG(emit->as, (mp_uint_t)mp_const_false, REG_ARG_2);
+        ASM_MOV_IMM_TO_REG(emit->as, 0, REG_RET);
+        ASM_JUMP_IF_REG_EQ(emit->as, REG_ARG_1, REG_ARG_2, l_done);
         emit_call(emit, MP_F_OBJ_IS_TRUE);
+        mp_asm_base_label_assign(&emit->as->base, l_done);
+        #else
+        emit_call(emit, MP_F_OBJ_IS_TRUE);
+        #endif
     } else {
         emit_pre_pop_reg(emit, &vtype, REG_RET);
         if (!pop) {
@@ -1820,6 +1906,70 @@ STATIC void emit_native_unary_op(emit_t *emit, mp_unary_op_t op) {
     }
 }
 
+#if NATIVE_INLINE_SMALL_INT
+// Inline code for a binary op on two objects, for the case that both are small
+// ints, with a fall back to mp_binary_op.  The lhs is in REG_ARG_2 and the rhs
+// in REG_ARG_3, and on success the result is pushed from REG_RET.  A small int
+// is stored as (value << 1) | 1 so the tagged values can be added, subtracted
+// and compared directly, with the overflow flag detecting results that don't
+// fit in a small int.
+STATIC bool emit_native_binary_op_small_int(emit_t *emit, mp_binary_op_t op) {
+    int cc = -1;
+    switch (op) {
+        case MP_BINARY_OP_LESS: cc = ASM_X64_CC_JL; break;
+        case MP_BINARY_OP_MORE: cc = ASM_X64_CC_JG; break;
+        case MP_BINARY_OP_EQUAL: cc = ASM_X64_CC_JE; break;
+        case MP_BINARY_OP_LESS_EQUAL: cc = ASM_X64_CC_JLE; break;
+        case MP_BINARY_OP_MORE_EQUAL: cc = ASM_X64_CC_JGE; break;
+        case MP_BINARY_OP_NOT_EQUAL: cc = ASM_X64_CC_JNE; break;
+        case MP_BINARY_OP_ADD:
+        case MP_BINARY_OP_INPLACE_ADD:
+        case MP_BINARY_OP_SUBTRACT:
+        case MP_BINARY_OP_INPLACE_SUBTRACT:
+            break;
+        default:
+            return false;
+    }
+
+    // the slow path calls out so the stack must be settled before branching
+    need_reg_all(emit);
+    mp_uint_t l_slow = emit_native_new_label(emit);
+    mp_uint_t l_done = emit_native_new_label(emit);
+
+    // both tag bits set means both are small ints
+    ASM_MOV_REG_REG(emit->as, REG_RET, REG_ARG_2);
+    ASM_AND_REG_REG(emit->as, REG_RET, REG_ARG_3);
+    asm_x64_test_r8_with_i8(emit->as, REG_RET, 1);
+    asm_x64_jcc_label(emit->as, ASM_X64_CC_JZ, l_slow);
+
+    if (cc >= 0) {
+        asm_x64_cmp_r64_with_r64(emit->as, REG_ARG_3, REG_ARG_2);
+        ASM_MOV_IMM_TO_REG(emit->as, (mp_uint_t)mp_const_true, REG_RET);
+        asm_x64_jcc_label(emit->as, cc, l_done);
+        ASM_MOV_IMM_TO_REG(emit->as, (mp_uint_t)mp_const_false, REG_RET);
+    } else if (op == MP_BINARY_OP_ADD || op == MP_BINARY_OP_INPLACE_ADD) {
+        // (2a + 1) - 1 + (2b + 1)
+        ASM_MOV_REG_REG(emit->as, REG_RET, REG_ARG_2);
+        asm_x64_sub_r64_i32(emit->as, REG_RET, 1);
+        ASM_ADD_REG_REG(emit->as, REG_RET, REG_ARG_3);
+        asm_x64_jcc_label(emit->as, ASM_X64_CC_JO, l_slow);
+    } else {
+        // (2a + 1) - (2b + 1) + 1, where the final step can't overflow
+        ASM_MOV_REG_REG(emit->as, REG_RET, REG_ARG_2);
+        ASM_SUB_REG_REG(emit->as, REG_RET, REG_ARG_3);
+        asm_x64_jcc_label(emit->as, ASM_X64_CC_JO, l_slow);
+        asm_x64_sub_r64_i32(emit->as, REG_RET, -1);
+    }
+    ASM_JUMP(emit->as, l_done);
+
+    mp_asm_base_label_assign(&emit->as->base, l_slow);
+    emit_call_with_imm_arg(emit, MP_F_BINARY_OP, op, REG_ARG_1);
+    mp_asm_base_label_assign(&emit->as->base, l_done);
+    emit_post_push_reg(emit, VTYPE_PYOBJ, REG_RET);
+    return true;
+}
+#endif
+
 STATIC void emit_native_binary_op(emit_t *emit, mp_binary_op_t op) {
     DEBUG_printf("binary_op(" UINT_FMT ")\n", op);
     vtype_kind_t vtype_lhs = peek_vtype(emit, 1);
@@ -1976,6 +2126,11 @@ STATIC void emit_native_binary_op(emit_t *emit, mp_binary_op_t op) {
         }
     } else if (vtype_lhs == VTYPE_PYOBJ && vtype_rhs == VTYPE_PYOBJ) {
         emit_pre_pop_reg_reg(emit, &vtype_rhs, REG_ARG_3, &vtype_lhs, REG_ARG_2);
+        #if NATIVE_INLINE_SMALL_INT
+        if (emit_native_binary_op_small_int(emit, op)) {
+            return;
+        }
+        #endif
         bool invert = false;
         if (op == MP_BINARY_OP_NOT_IN) {
             invert = true;
@@ -1998,6 +2153,156 @@ STATIC void emit_native_binary_op(emit_t *emit, mp_binary_op_t op) {
     }
 }
 
+STATIC bool vtype_is_int(vtype_kind_t vtype) {
+    return vtype == VTYPE_INT || vtype == VTYPE_UINT;
+}
+
+#if N_X64
+// Emit SSE2 code for a viper loop over the range start:end-1, see emit_native_vector_loop.
+// The operands are in registers: start in RAX, end in RCX, and for the map kinds
+// dst in RDI, src in RSI and src2 or k in RDX, or for a sum acc in RDX and src in RSI.
+// The stack is settled.  The new start is left in RAX and the new acc in RDX.
+STATIC void emit_native_vector_loop_x64(emit_t *emit, mp_uint_t kind, mp_binary_op_t op, vtype_kind_t vtype_ptr) {
+    ASM_T *as = emit->as;
+    int scale = vtype_ptr == VTYPE_PTR8 ? 1 : vtype_ptr == VTYPE_PTR16 ? 2 : 4;
+    int n_lanes = 16 / scale;
+    mp_uint_t l_loop = emit_native_new_label(emit);
+    mp_uint_t l_done = emit_native_new_label(emit);
+    mp_uint_t l_skip = emit_native_new_label(emit);
+
+    if (kind != MP_EMIT_VECTOR_SUM) {
+        // a block of 16 bytes is loaded before any of it is stored, which is
+        // only the same as the scalar loop if no source starts within the
+        // 15 bytes before dst
+        for (int i = 0; i < (kind == MP_EMIT_VECTOR_MAP_PTR ? 2 : 1); i++) {
+            ASM_MOV_REG_REG(as, ASM_X64_REG_R08, ASM_X64_REG_RDI);
+            ASM_SUB_REG_REG(as, ASM_X64_REG_R08, i == 0 ? ASM_X64_REG_RSI : ASM_X64_REG_RDX);
+            ASM_MOV_IMM_TO_REG(as, 1, ASM_X64_REG_R09);
+            ASM_SUB_REG_REG(as, ASM_X64_REG_R08, ASM_X64_REG_R09);
+            ASM_MOV_IMM_TO_REG(as, 15, ASM_X64_REG_R09);
+            asm_x64_cmp_r64_with_r64(as, ASM_X64_REG_R09, ASM_X64_REG_R08);
+            asm_x64_jcc_label(as, ASM_X64_CC_JB, l_skip);
+        }
+    }
+
+    // xmm1 holds the scalar operand in every lane, xmm2 is zero and xmm3 is the sum
+    if (kind == MP_EMIT_VECTOR_MAP_SCALAR) {
+        asm_x64_sse_movq_r64_to_xmm(as, ASM_X64_REG_RDX, 1);
+        if (scale == 1) {
+            asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PUNPCKLBW, 1, 1);
+        }
+        if (scale <= 2) {
+            asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PUNPCKLWD, 1, 1);
+        }
+        asm_x64_sse_pshufd(as, 1, 1, 0);
+    } else if (kind == MP_EMIT_VECTOR_SUM) {
+        asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PXOR, 2, 2);
+        asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PXOR, 3, 3);
+    }
+
+    int sse_op = 0;
+    switch (op) {
+        case MP_BINARY_OP_ADD: sse_op = ASM_X64_SSE_PADDB + (scale >> 1); break;
+        case MP_BINARY_OP_SUBTRACT: sse_op = ASM_X64_SSE_PSUBB + (scale >> 1); break;
+        case MP_BINARY_OP_AND: sse_op = ASM_X64_SSE_PAND; break;
+        case MP_BINARY_OP_OR: sse_op = ASM_X64_SSE_POR; break;
+        default: sse_op = ASM_X64_SSE_PXOR; break;
+    }
+
+    // leave at least one element for the scalar loop, so it assigns the
+    // final value of the loop variable
+    ASM_SUB_REG_REG(as, ASM_X64_REG_RCX, ASM_X64_REG_RAX);
+    asm_x64_sub_r64_i32(as, ASM_X64_REG_RCX, 1);
+    ASM_MOV_IMM_TO_REG(as, n_lanes, ASM_X64_REG_R09);
+    mp_asm_base_label_assign(&as->base, l_loop);
+    asm_x64_cmp_r64_with_r64(as, ASM_X64_REG_R09, ASM_X64_REG_RCX);
+    asm_x64_jcc_label(as, ASM_X64_CC_JL, l_done);
+    asm_x64_sse_movdqu_mem_to_xmm(as, ASM_X64_REG_RSI, ASM_X64_REG_RAX, scale, 0);
+    if (kind == MP_EMIT_VECTOR_SUM) {
+        asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PSADBW, 0, 2);
+        asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PADDQ, 3, 0);
+    } else {
+        if (kind == MP_EMIT_VECTOR_MAP_PTR) {
+            asm_x64_sse_movdqu_mem_to_xmm(as, ASM_X64_REG_RDX, ASM_X64_REG_RAX, scale, 1);
+        }
+        asm_x64_sse_op_xmm_xmm(as, sse_op, 0, 1);
+        asm_x64_sse_movdqu_xmm_to_mem(as, 0, ASM_X64_REG_RDI, ASM_X64_REG_RAX, scale);
+    }
+    asm_x64_sub_r64_i32(as, ASM_X64_REG_RAX, -n_lanes);
+    ASM_SUB_REG_REG(as, ASM_X64_REG_RCX, ASM_X64_REG_R09);
+    ASM_JUMP(as, l_loop);
+    mp_asm_base_label_assign(&as->base, l_done);
+
+    if (kind == MP_EMIT_VECTOR_SUM) {
+        // add the two 64-bit halves of the sum to acc
+        asm_x64_sse_pshufd(as, 0, 3, 0x4e);
+        asm_x64_sse_op_xmm_xmm(as, ASM_X64_SSE_PADDQ, 3, 0);
+        asm_x64_sse_movq_xmm_to_r64(as, 3, ASM_X64_REG_R08);
+        ASM_ADD_REG_REG(as, ASM_X64_REG_RDX, ASM_X64_REG_R08);
+    }
+    mp_asm_base_label_assign(&as->base, l_skip);
+}
+#endif
+
+// Process a prefix of the range of a viper for loop whose body is one of the
+// forms given by MP_EMIT_VECTOR_xxx, leaving the remaining iterations to the
+// scalar loop that the compiler emits after this.  The stack holds start, end
+// and the operands; on exit it holds the new start and, for a sum, the new acc.
+// Where the types or the architecture don't allow it no elements are done.
+STATIC void emit_native_vector_loop(emit_t *emit, mp_uint_t kind, mp_binary_op_t op) {
+    emit_native_pre(emit);
+    int n_opnd = kind == MP_EMIT_VECTOR_SUM ? 2 : 3;
+    vtype_kind_t vtype_start = peek_vtype(emit, n_opnd + 1);
+    vtype_kind_t vtype_end = peek_vtype(emit, n_opnd);
+    vtype_kind_t vtype_ptr = peek_vtype(emit, n_opnd - 2);
+    bool ok = vtype_is_int(vtype_start) && vtype_is_int(vtype_end);
+    if (kind == MP_EMIT_VECTOR_SUM) {
+        ok = ok && vtype_ptr == VTYPE_PTR8 && vtype_is_int(peek_vtype(emit, 1));
+    } else {
+        vtype_kind_t vtype_src2 = peek_vtype(emit, 0);
+        ok = ok && (vtype_ptr == VTYPE_PTR8 || vtype_ptr == VTYPE_PTR16 || vtype_ptr == VTYPE_PTR32)
+            && peek_vtype(emit, 2) == vtype_ptr
+            && (kind == MP_EMIT_VECTOR_MAP_PTR ? vtype_src2 == vtype_ptr : vtype_is_int(vtype_src2));
+    }
+
+    #if N_X64
+    if (ok) {
+        vtype_kind_t vtype_acc;
+        // the loop uses registers beyond those popped into, so spill them all first
+        need_reg_all(emit);
+        if (kind == MP_EMIT_VECTOR_SUM) {
+            emit_pre_pop_reg_reg(emit, &vtype_ptr, ASM_X64_REG_RSI, &vtype_acc, ASM_X64_REG_RDX);
+        } else {
+            emit_pre_pop_reg_reg_reg(emit, &vtype_acc, ASM_X64_REG_RDX, &vtype_ptr, ASM_X64_REG_RSI, &vtype_ptr, ASM_X64_REG_RDI);
+        }
+        emit_pre_pop_reg_reg(emit, &vtype_end, ASM_X64_REG_RCX, &vtype_start, ASM_X64_REG_RAX);
+        emit_native_vector_loop_x64(emit, kind, op, vtype_ptr);
+        emit_post_push_reg(emit, vtype_start, ASM_X64_REG_RAX);
+        if (kind == MP_EMIT_VECTOR_SUM) {
+            emit_post_push_reg(emit, vtype_acc, ASM_X64_REG_RDX);
+        }
+        return;
+    }
+    #else
+    (void)op;
+    (void)ok;
+    #endif
+
+    // do no elements: drop the operands and end, keeping start (and acc)
+    if (kind == MP_EMIT_VECTOR_SUM) {
+        vtype_kind_t vtype_acc;
+        emit_pre_pop_discard(emit);
+        emit_pre_pop_reg(emit, &vtype_acc, REG_RET);
+        emit_pre_pop_discard(emit);
+        emit_post_push_reg(emit, vtype_acc, REG_RET);
+    } else {
+        for (int i = 0; i < n_opnd + 1; i++) {
+            emit_pre_pop_discard(emit);
+        }
+        emit_post(emit);
+    }
+}
+
 STATIC void emit_native_build_tuple(emit_t *emit, mp_uint_t n_args) {
     // for viper: call runtime, with types of args
     //   if wrapped in byte_array, or something, allocates memory and fills it
@@ -2273,6 +2578,7 @@ STATIC void emit_native_end_except_handler(emit_t *emit) {
 
 const emit_method_table_t EXPORT_FUN(method_table) = {
     emit_native_set_native_type,
+    emit_native_vector_loop,
     emit_native_start_pass,
     emit_native_end_pass,
     emit_native_last_emit_was_return_value,
@@ -26,10 +26,41 @@
 #ifndef MICROPY_INCLUDED_PY_FORMATFLOAT_H
 #define MICROPY_INCLUDED_PY_FORMATFLOAT_H
 
+#include <stdint.h>
+
 #include "py/mpconfig.h"
 
 #if MICROPY_PY_BUILTINS_FLOAT
 int mp_format_float(mp_float_t f, char *buf, size_t bufSize, char fmt, int prec, char sign);
+
+#if MICROPY_FLOAT_FAST_CONV
+// 128-bit approximations of 5^q, normalised so the top bit is set, stored as
+// {high, low} pairs for q from MP_FLOAT_POW5_MIN to MP_FLOAT_POW5_MAX.
+#if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
+#define MP_FLOAT_POW5_MIN (-342)
+#define MP_FLOAT_POW5_MAX (325)
+#else
+#define MP_FLOAT_POW5_MIN (-65)
+#define MP_FLOAT_POW5_MAX (47)
+#endif
+extern const uint64_t mp_float_pow5_128[MP_FLOAT_POW5_MAX - MP_FLOAT_POW5_MIN + 1][2];
+
+// Returns the low 64 bits of a * b and stores the high 64 bits in *hi.
+static inline uint64_t mp_float_umul128(uint64_t a, uint64_t b, uint64_t *hi) {
+    #if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)a * b;
+    *hi = (uint64_t)(p >> 64);
+    return (uint64_t)p;
+    #else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t p00 = a_lo * b_lo, p01 = a_lo * b_hi, p10 = a_hi * b_lo, p11 = a_hi * b_hi;
+    uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+    *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    return (mid << 32) | (uint32_t)p00;
+    #endif
+}
+#endif
 #endif
 
 #endif // MICROPY_INCLUDED_PY_FORMATFLOAT_H
@@ -30,6 +30,16 @@
 
 #include "py/gc.h"
 #include "py/runtime.h"
+#if MICROPY_GC_PAUSE_STATS
+#include "py/mphal.h"
+#endif
+#if MICROPY_GC_COMPACT
+#include "py/objstr.h"
+#include "py/objint.h"
+#include "py/objlist.h"
+#include "py/objtuple.h"
+#include "py/objarray.h"
+#endif
 
 #if MICROPY_ENABLE_GC
 
@@ -69,18 +79,44 @@
 #define ATB_2_IS_FREE(a) (((a) & ATB_MASK_2) == 0)
 #define ATB_3_IS_FREE(a) (((a) & ATB_MASK_3) == 0)
 
+#if MICROPY_GC_TLAB
+// Table bytes covering a thread's allocation buffer are updated by that thread
+// without holding the GC mutex, so all updates to them are atomic
+#define TB_OR(tb, v) ((void)__atomic_fetch_or(&(tb), (v), __ATOMIC_RELAXED))
+#define TB_AND(tb, v) ((void)__atomic_fetch_and(&(tb), (v), __ATOMIC_RELAXED))
+#define TB_XOR(tb, v) ((void)__atomic_fetch_xor(&(tb), (v), __ATOMIC_RELAXED))
+#else
+#define TB_OR(tb, v) ((tb) |= (v))
+#define TB_AND(tb, v) ((tb) &= (v))
+#define TB_XOR(tb, v) ((tb) ^= (v))
+#endif
+
 #define BLOCK_SHIFT(block) (2 * ((block) & (BLOCKS_PER_ATB - 1)))
 #define ATB_GET_KIND(block) ((MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] >> BLOCK_SHIFT(block)) & 3)
-#define ATB_ANY_TO_FREE(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_MARK << BLOCK_SHIFT(block))); } while (0)
-#define ATB_FREE_TO_HEAD(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_HEAD << BLOCK_SHIFT(block)); } while (0)
-#define ATB_FREE_TO_TAIL(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_TAIL << BLOCK_SHIFT(block)); } while (0)
-#define ATB_HEAD_TO_MARK(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_MARK << BLOCK_SHIFT(block)); } while (0)
-#define ATB_MARK_TO_HEAD(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_TAIL << BLOCK_SHIFT(block))); } while (0)
+#define ATB_ANY_TO_FREE(block) do { TB_AND(MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (byte)~(AT_MARK << BLOCK_SHIFT(block))); } while (0)
+#define ATB_FREE_TO_HEAD(block) do { TB_OR(MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (AT_HEAD << BLOCK_SHIFT(block))); } while (0)
+#define ATB_FREE_TO_TAIL(block) do { TB_OR(MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (AT_TAIL << BLOCK_SHIFT(block))); } while (0)
+#define ATB_HEAD_TO_MARK(block) do { TB_OR(MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (AT_MARK << BLOCK_SHIFT(block))); } while (0)
+#define ATB_MARK_TO_HEAD(block) do { TB_AND(MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (byte)~(AT_TAIL << BLOCK_SHIFT(block))); } while (0)
+#define ATB_TAIL_TO_HEAD(block) do { TB_XOR(MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], ((AT_TAIL ^ AT_HEAD) << BLOCK_SHIFT(block))); } while (0)
+
+// Plain updates for the mark and sweep, which never run while a thread
+// allocates from its buffer
+#define ATB_ANY_TO_FREE_NOSYNC(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_MARK << BLOCK_SHIFT(block))); } while (0)
+#define ATB_HEAD_TO_MARK_NOSYNC(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_MARK << BLOCK_SHIFT(block)); } while (0)
+#define ATB_MARK_TO_HEAD_NOSYNC(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_TAIL << BLOCK_SHIFT(block))); } while (0)
 
 #define BLOCK_FROM_PTR(ptr) (((byte*)(ptr) - MP_STATE_MEM(gc_pool_start)) / BYTES_PER_BLOCK)
 #define PTR_FROM_BLOCK(block) (((block) * BYTES_PER_BLOCK + (uintptr_t)MP_STATE_MEM(gc_pool_start)))
 #define ATB_FROM_BLOCK(bl) ((bl) / BLOCKS_PER_ATB)
 
+#if MICROPY_GC_LAZY_SWEEP
+// Live heads in the part of the heap not yet swept are still marked
+#define ATB_IS_HEAD(block) (ATB_GET_KIND(block) == AT_HEAD || ATB_GET_KIND(block) == AT_MARK)
+#else
+#define ATB_IS_HEAD(block) (ATB_GET_KIND(block) == AT_HEAD)
+#endif
+
 #if MICROPY_ENABLE_FINALISER
 // FTB = finaliser table byte
 // if set, then the corresponding block may have a finaliser
@@ -88,8 +124,65 @@
 #define BLOCKS_PER_FTB (8)
 
 #define FTB_GET(block) ((MP_STATE_MEM(gc_finaliser_table_start)[(block) / BLOCKS_PER_FTB] >> ((block) & 7)) & 1)
-#define FTB_SET(block) do { MP_STATE_MEM(gc_finaliser_table_start)[(block) / BLOCKS_PER_FTB] |= (1 << ((block) & 7)); } while (0)
-#define FTB_CLEAR(block) do { MP_STATE_MEM(gc_finaliser_table_start)[(block) / BLOCKS_PER_FTB] &= (~(1 << ((block) & 7))); } while (0)
+#define FTB_SET(block) do { TB_OR(MP_STATE_MEM(gc_finaliser_table_start)[(block) / BLOCKS_PER_FTB], (1 << ((block) & 7))); } while (0)
+#define FTB_CLEAR(block) do { TB_AND(MP_STATE_MEM(gc_finaliser_table_start)[(block) / BLOCKS_PER_FTB], (byte)~(1 << ((block) & 7))); } while (0)
+#endif
+
+#if MICROPY_GC_LEAF_BLOCKS
+// LTB = leaf table byte
+// if set, then the corresponding head block contains no heap pointers and
+// its contents are not scanned by the mark phase
+
+#define BLOCKS_PER_LTB (8)
+
+#define LTB_GET(block) ((MP_STATE_MEM(gc_leaf_table_start)[(block) / BLOCKS_PER_LTB] >> ((block) & 7)) & 1)
+#define LTB_SET(block) do { TB_OR(MP_STATE_MEM(gc_leaf_table_start)[(block) / BLOCKS_PER_LTB], (1 << ((block) & 7))); } while (0)
+#define LTB_CLEAR(block) do { TB_AND(MP_STATE_MEM(gc_leaf_table_start)[(block) / BLOCKS_PER_LTB], (byte)~(1 << ((block) & 7))); } while (0)
+#endif
+
+#if MICROPY_GC_COMPACT
+#if !MICROPY_GC_LEAF_BLOCKS
+#error MICROPY_GC_COMPACT requires MICROPY_GC_LEAF_BLOCKS
+#endif
+#if !MICROPY_ENABLE_FINALISER
+#error MICROPY_GC_COMPACT requires MICROPY_ENABLE_FINALISER
+#endif
+#if MICROPY_OBJ_REPR == MICROPY_OBJ_REPR_D
+#error MICROPY_GC_COMPACT requires objects to be pointer sized
+#endif
+
+// During a compacting collection the compact table holds bitmaps with one bit
+// per block, for head blocks:
+// - PIN: referenced from outside the heap, or from a word which may not be a
+//   pointer, or already moved; it must stay where it is
+// - FWD: has been moved, its first word holding the new address
+// - OBJ: an object whose layout is known, see gc_compact_layout
+// - RAW: raw data pointed to by a known object, never taken for an object
+// - ARR: an array of objects belonging to a known list or dict
+
+#define BITS_PER_CTB (8)
+#define CTB_LEN() ((MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB + BITS_PER_CTB - 1) / BITS_PER_CTB)
+#define CTB_NUM_TABLES (5)
+#define PIN_TABLE() (MP_STATE_MEM(gc_compact_table))
+#define FWD_TABLE() (MP_STATE_MEM(gc_compact_table) + CTB_LEN())
+#define OBJ_TABLE() (MP_STATE_MEM(gc_compact_table) + 2 * CTB_LEN())
+#define RAW_TABLE() (MP_STATE_MEM(gc_compact_table) + 3 * CTB_LEN())
+#define ARR_TABLE() (MP_STATE_MEM(gc_compact_table) + 4 * CTB_LEN())
+
+#define CTB_GET(table, block) (((table)[(block) / BITS_PER_CTB] >> ((block) & 7)) & 1)
+#define CTB_SET(table, block) do { (table)[(block) / BITS_PER_CTB] |= (1 << ((block) & 7)); } while (0)
+#define CTB_CLEAR(table, block) do { (table)[(block) / BITS_PER_CTB] &= ~(1 << ((block) & 7)); } while (0)
+#endif
+
+#if MICROPY_GC_PARALLEL_MARK && !MICROPY_PY_THREAD
+#error MICROPY_GC_PARALLEL_MARK requires MICROPY_PY_THREAD
+#endif
+
+#if MICROPY_GC_TLAB
+#if !MICROPY_PY_THREAD
+#error MICROPY_GC_TLAB requires MICROPY_PY_THREAD
+#endif
+#define GC_TLAB_MAX_OBJ_BLOCKS (MICROPY_GC_TLAB_BLOCKS / 8)
 #endif
 
 #if MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL
@@ -117,32 +210,44 @@ void gc_init(void *start, void *end) {
     end = (void*)((uintptr_t)end & (~(BYTES_PER_BLOCK - 1)));
     DEBUG_printf("Initializing GC heap: %p..%p = " UINT_FMT " bytes\n", start, end, (byte*)end - (byte*)start);
 
-    // calculate parameters for GC (T=total, A=alloc table, F=finaliser table, P=pool; all in bytes):
-    // T = A + F + P
+    // calculate parameters for GC (T=total, A=alloc table, F=finaliser table, L=leaf table, P=pool; all in bytes):
+    // T = A + F + L + P
     //     F = A * BLOCKS_PER_ATB / BLOCKS_PER_FTB
+    //     L = A * BLOCKS_PER_ATB / BLOCKS_PER_LTB
     //     P = A * BLOCKS_PER_ATB * BYTES_PER_BLOCK
-    // => T = A * (1 + BLOCKS_PER_ATB / BLOCKS_PER_FTB + BLOCKS_PER_ATB * BYTES_PER_BLOCK)
+    // => T = A * (1 + BLOCKS_PER_ATB / BLOCKS_PER_FTB + BLOCKS_PER_ATB / BLOCKS_PER_LTB + BLOCKS_PER_ATB * BYTES_PER_BLOCK)
     size_t total_byte_len = (byte*)end - (byte*)start;
-#if MICROPY_ENABLE_FINALISER
+#if MICROPY_ENABLE_FINALISER && MICROPY_GC_LEAF_BLOCKS
+    MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len * BITS_PER_BYTE / (BITS_PER_BYTE + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_FTB + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_LTB + BITS_PER_BYTE * BLOCKS_PER_ATB * BYTES_PER_BLOCK);
+#elif MICROPY_ENABLE_FINALISER
     MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len * BITS_PER_BYTE / (BITS_PER_BYTE + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_FTB + BITS_PER_BYTE * BLOCKS_PER_ATB * BYTES_PER_BLOCK);
+#elif MICROPY_GC_LEAF_BLOCKS
+    MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len * BITS_PER_BYTE / (BITS_PER_BYTE + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_LTB + BITS_PER_BYTE * BLOCKS_PER_ATB * BYTES_PER_BLOCK);
 #else
     MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len / (1 + BITS_PER_BYTE / 2 * BYTES_PER_BLOCK);
 #endif
 
     MP_STATE_MEM(gc_alloc_table_start) = (byte*)start;
+    byte *table_end = MP_STATE_MEM(gc_alloc_table_start) + MP_STATE_MEM(gc_alloc_table_byte_len);
 
 #if MICROPY_ENABLE_FINALISER
     size_t gc_finaliser_table_byte_len = (MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB + BLOCKS_PER_FTB - 1) / BLOCKS_PER_FTB;
-    MP_STATE_MEM(gc_finaliser_table_start) = MP_STATE_MEM(gc_alloc_table_start) + MP_STATE_MEM(gc_alloc_table_byte_len);
+    MP_STATE_MEM(gc_finaliser_table_start) = table_end;
+    table_end += gc_finaliser_table_byte_len;
+#endif
+
+#if MICROPY_GC_LEAF_BLOCKS
+    size_t gc_leaf_table_byte_len = (MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB + BLOCKS_PER_LTB - 1) / BLOCKS_PER_LTB;
+    MP_STATE_MEM(gc_leaf_table_start) = table_end;
+    table_end += gc_leaf_table_byte_len;
 #endif
 
     size_t gc_pool_block_len = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
     MP_STATE_MEM(gc_pool_start) = (byte*)end - gc_pool_block_len * BYTES_PER_BLOCK;
     MP_STATE_MEM(gc_pool_end) = end;
 
-#if MICROPY_ENABLE_FINALISER
-    assert(MP_STATE_MEM(gc_pool_start) >= MP_STATE_MEM(gc_finaliser_table_start) + gc_finaliser_table_byte_len);
-#endif
+    assert(MP_STATE_MEM(gc_pool_start) >= table_end);
+    (void)table_end;
 
     // clear ATBs
     memset(MP_STATE_MEM(gc_alloc_table_start), 0, MP_STATE_MEM(gc_alloc_table_byte_len));
@@ -152,9 +257,36 @@ void gc_init(void *start, void *end) {
     memset(MP_STATE_MEM(gc_finaliser_table_start), 0, gc_finaliser_table_byte_len);
 #endif
 
+#if MICROPY_GC_LEAF_BLOCKS
+    // clear LTBs
+    memset(MP_STATE_MEM(gc_leaf_table_start), 0, gc_leaf_table_byte_len);
+#endif
+
     // set last free ATB index to start of heap
     MP_STATE_MEM(gc_last_free_atb_index) = 0;
 
+    #if MICROPY_GC_LAZY_SWEEP
+    // nothing to sweep until the first collection
+    MP_STATE_MEM(gc_sweep_block) = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    MP_STATE_MEM(gc_sweep_slice_blocks) = MICROPY_GC_SWEEP_SLICE / BYTES_PER_BLOCK;
+    #endif
+
+    #if MICROPY_GC_COMPACT
+    MP_STATE_MEM(gc_compact_table) = NULL;
+    #endif
+
+    #if MICROPY_GC_PAUSE_STATS
+    MP_STATE_MEM(gc_pause_last_us) = 0;
+    MP_STATE_MEM(gc_pause_max_us) = 0;
+    #endif
+
+    #if MICROPY_GC_SIZE_CLASSES
+    // size class lists are filled in by the first sweep
+    memset(MP_STATE_MEM(gc_size_class_len), 0, sizeof(MP_STATE_MEM(gc_size_class_len)));
+    MP_STATE_MEM(gc_size_class_hits) = 0;
+    MP_STATE_MEM(gc_size_class_misses) = 0;
+    #endif
+
     // unlock the GC
     MP_STATE_MEM(gc_lock_depth) = 0;
 
@@ -171,10 +303,25 @@ void gc_init(void *start, void *end) {
     mp_thread_mutex_init(&MP_STATE_MEM(gc_mutex));
     #endif
 
+    #if MICROPY_GC_TLAB
+    // epoch 0 is never current, so zeroed thread state has no buffer
+    MP_STATE_MEM(gc_tlab_epoch) = 1;
+    MP_STATE_MEM(gc_tlab_stop) = 0;
+    memset(MP_STATE_MEM(gc_tlab_slot), 0, sizeof(MP_STATE_MEM(gc_tlab_slot)));
+    #endif
+
+    #if MICROPY_GC_PARALLEL_MARK
+    MP_STATE_MEM(gc_mark_threads) = 1;
+    mp_thread_mutex_init(&MP_STATE_MEM(gc_mark_mutex));
+    #endif
+
     DEBUG_printf("GC layout:\n");
     DEBUG_printf("  alloc table at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_alloc_table_start), MP_STATE_MEM(gc_alloc_table_byte_len), MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB);
 #if MICROPY_ENABLE_FINALISER
     DEBUG_printf("  finaliser table at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_finaliser_table_start), gc_finaliser_table_byte_len, gc_finaliser_table_byte_len * BLOCKS_PER_FTB);
+#endif
+#if MICROPY_GC_LEAF_BLOCKS
+    DEBUG_printf("  leaf table at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_leaf_table_start), gc_leaf_table_byte_len, gc_leaf_table_byte_len * BLOCKS_PER_LTB);
 #endif
     DEBUG_printf("  pool at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_pool_start), gc_pool_block_len * BYTES_PER_BLOCK, gc_pool_block_len);
 }
@@ -210,7 +357,7 @@ bool gc_is_locked(void) {
             if (ATB_GET_KIND(_block) == AT_HEAD) { \
                 /* an unmarked head, mark it, and push it on gc stack */ \
                 DEBUG_printf("gc_mark(%p)\n", ptr); \
-                ATB_HEAD_TO_MARK(_block); \
+                ATB_HEAD_TO_MARK_NOSYNC(_block); \
                 if (MP_STATE_MEM(gc_sp) < &MP_STATE_MEM(gc_stack)[MICROPY_ALLOC_GC_STACK_SIZE]) { \
                     *MP_STATE_MEM(gc_sp)++ = _block; \
                 } else { \
@@ -225,6 +372,13 @@ STATIC void gc_drain_stack(void) {
         // pop the next block off the stack
         size_t block = *--MP_STATE_MEM(gc_sp);
 
+        #if MICROPY_GC_LEAF_BLOCKS
+        if (LTB_GET(block)) {
+            // no pointers in this chain, nothing to trace
+            continue;
+        }
+        #endif
+
         // work out number of consecutive blocks in the chain starting with this one
         size_t n_blocks = 0;
         do {
@@ -256,13 +410,237 @@ STATIC void gc_deal_with_stack_overflow(void) {
     }
 }
 
-STATIC void gc_sweep(void) {
-    #if MICROPY_PY_GC_COLLECT_RETVAL
-    MP_STATE_MEM(gc_collected) = 0;
+#if MICROPY_GC_PARALLEL_MARK
+// Parallel marking.  Each mark thread traces blocks from its own stack and
+// the threads share work through a pool protected by gc_mark_mutex: a thread
+// with work to spare hands half of its stack to the pool when the pool is
+// empty and another thread is idle, and an idle thread takes work from it.
+// Marking finishes when all threads are idle and the pool is empty.  Heads
+// are marked with an atomic compare-and-swap on their ATB, so exactly one
+// thread traces each head.  If a thread's stack overflows then the head is
+// left marked but untraced, and the heap is rescanned by all threads.
+
+#define GC_MARK_STACK_SIZE (256)
+
+STATIC bool gc_mark_head_atomic(size_t block) {
+    byte *atb = &MP_STATE_MEM(gc_alloc_table_start)[block / BLOCKS_PER_ATB];
+    byte shift = BLOCK_SHIFT(block);
+    byte a = __atomic_load_n(atb, __ATOMIC_RELAXED);
+    do {
+        if (((a >> shift) & 3) != AT_HEAD) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(atb, &a, a | (AT_MARK << shift), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return true;
+}
+
+// Move up to n entries from the bottom of stack to the pool, returning the
+// number moved.  Must be called with gc_mark_mutex held.
+STATIC size_t gc_mark_pool_put(size_t *stack, size_t n) {
+    size_t room = MICROPY_GC_MARK_POOL_SIZE - MP_STATE_MEM(gc_mark_pool_len);
+    if (n > room) {
+        n = room;
+    }
+    memcpy(&MP_STATE_MEM(gc_mark_pool)[MP_STATE_MEM(gc_mark_pool_len)], stack, n * sizeof(size_t));
+    __atomic_store_n(&MP_STATE_MEM(gc_mark_pool_len), MP_STATE_MEM(gc_mark_pool_len) + n, __ATOMIC_RELAXED);
+    return n;
+}
+
+STATIC size_t gc_mark_share(size_t *stack, size_t sp, size_t n) {
+    mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    n = gc_mark_pool_put(stack, n);
+    mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+    memmove(stack, stack + n, (sp - n) * sizeof(size_t));
+    return sp - n;
+}
+
+STATIC void gc_mark_drain_local(size_t *stack, size_t sp) {
+    while (sp > 0) {
+        size_t block = stack[--sp];
+
+        #if MICROPY_GC_LEAF_BLOCKS
+        if (LTB_GET(block)) {
+            continue;
+        }
+        #endif
+
+        size_t n_blocks = 0;
+        do {
+            n_blocks += 1;
+        } while (ATB_GET_KIND(block + n_blocks) == AT_TAIL);
+
+        void **ptrs = (void**)PTR_FROM_BLOCK(block);
+        for (size_t i = n_blocks * BYTES_PER_BLOCK / sizeof(void*); i > 0; i--, ptrs++) {
+            void *ptr = *ptrs;
+            if (VERIFY_PTR(ptr) && gc_mark_head_atomic(BLOCK_FROM_PTR(ptr))) {
+                if (sp == GC_MARK_STACK_SIZE) {
+                    sp = gc_mark_share(stack, sp, GC_MARK_STACK_SIZE / 2);
+                }
+                if (sp < GC_MARK_STACK_SIZE) {
+                    stack[sp++] = BLOCK_FROM_PTR(ptr);
+                } else {
+                    __atomic_store_n(&MP_STATE_MEM(gc_stack_overflow), 1, __ATOMIC_RELAXED);
+                }
+            }
+        }
+
+        if (sp > 1 && __atomic_load_n(&MP_STATE_MEM(gc_mark_idle), __ATOMIC_RELAXED) != 0
+            && __atomic_load_n(&MP_STATE_MEM(gc_mark_pool_len), __ATOMIC_RELAXED) == 0) {
+            sp = gc_mark_share(stack, sp, sp / 2);
+        }
+    }
+}
+
+STATIC void gc_mark_worker(size_t id, size_t n_threads) {
+    size_t stack[GC_MARK_STACK_SIZE];
+
+    if (MP_STATE_MEM(gc_mark_rescan)) {
+        // retrace the marked heads in this thread's share of the heap
+        size_t max_block = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+        size_t share = max_block / n_threads;
+        size_t end = id == n_threads - 1 ? max_block : (id + 1) * share;
+        for (size_t block = id * share; block < end; block++) {
+            if (ATB_GET_KIND(block) == AT_MARK) {
+                stack[0] = block;
+                gc_mark_drain_local(stack, 1);
+            }
+        }
+    }
+
+    mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    for (;;) {
+        if (MP_STATE_MEM(gc_mark_pool_len) == 0) {
+            MP_STATE_MEM(gc_mark_idle) += 1;
+            while (MP_STATE_MEM(gc_mark_pool_len) == 0 && MP_STATE_MEM(gc_mark_idle) < n_threads) {
+                mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+                MICROPY_GC_MARK_IDLE_HOOK();
+                mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+            }
+            if (MP_STATE_MEM(gc_mark_pool_len) == 0) {
+                // every thread is idle so there's nothing left to mark
+                break;
+            }
+            MP_STATE_MEM(gc_mark_idle) -= 1;
+        }
+        size_t n = MIN(MP_STATE_MEM(gc_mark_pool_len), GC_MARK_STACK_SIZE / 2);
+        MP_STATE_MEM(gc_mark_pool_len) -= n;
+        memcpy(stack, &MP_STATE_MEM(gc_mark_pool)[MP_STATE_MEM(gc_mark_pool_len)], n * sizeof(size_t));
+        mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+        gc_mark_drain_local(stack, n);
+        mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    }
+    mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+}
+
+// Hand the heads pushed while scanning roots to the pool, or trace them here
+// if the pool is full.
+STATIC void gc_mark_flush_roots(void) {
+    size_t n = MP_STATE_MEM(gc_sp) - MP_STATE_MEM(gc_stack);
+    if (gc_mark_pool_put(MP_STATE_MEM(gc_stack), n) == n) {
+        MP_STATE_MEM(gc_sp) = MP_STATE_MEM(gc_stack);
+    } else {
+        gc_drain_stack();
+    }
+}
+
+STATIC void gc_mark_parallel(void) {
+    gc_mark_flush_roots();
+    MP_STATE_MEM(gc_mark_rescan) = MP_STATE_MEM(gc_stack_overflow);
+    for (;;) {
+        MP_STATE_MEM(gc_stack_overflow) = 0;
+        MP_STATE_MEM(gc_mark_idle) = 0;
+        mp_thread_gc_run_workers(MP_STATE_MEM(gc_mark_threads), gc_mark_worker);
+        if (!MP_STATE_MEM(gc_stack_overflow)) {
+            break;
+        }
+        MP_STATE_MEM(gc_mark_rescan) = 1;
+    }
+}
+#endif
+
+#if MICROPY_GC_SIZE_CLASSES
+// The size class lists hold free runs of exactly 1..MICROPY_GC_SIZE_CLASSES
+// blocks, and a final list holds the start of longer runs which small
+// allocations are carved from.  Entries are only hints: blocks may be taken
+// by the linear scan in gc_alloc or by gc_realloc, so gc_size_class_take
+// re-checks them before use.
+#define SIZE_CLASS_LONG (MICROPY_GC_SIZE_CLASSES)
+
+STATIC void gc_size_class_put(size_t block, size_t n_blocks) {
+    if (n_blocks == 0) {
+        return;
+    }
+    size_t cls = MIN(n_blocks, SIZE_CLASS_LONG + 1) - 1;
+    size_t *len = &MP_STATE_MEM(gc_size_class_len)[cls];
+    if (*len < MICROPY_GC_SIZE_CLASS_LEN) {
+        MP_STATE_MEM(gc_size_class_free)[cls][(*len)++] = block;
+    }
+}
+
+STATIC bool gc_size_class_run_is_free(size_t block, size_t n_blocks) {
+    for (size_t end = block + n_blocks; block < end; block++) {
+        if (ATB_GET_KIND(block) != AT_FREE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Take a free run of n_blocks from the size class lists, preferring an exact
+// fit, then splitting a larger small run, then carving from a long run.
+// Returns (size_t)-1 if no usable run is known.
+STATIC size_t gc_size_class_take(size_t n_blocks) {
+    for (size_t cls = n_blocks; cls <= MICROPY_GC_SIZE_CLASSES; cls++) {
+        size_t *len = &MP_STATE_MEM(gc_size_class_len)[cls - 1];
+        while (*len > 0) {
+            size_t block = MP_STATE_MEM(gc_size_class_free)[cls - 1][--(*len)];
+            if (gc_size_class_run_is_free(block, cls)) {
+                gc_size_class_put(block + n_blocks, cls - n_blocks);
+                return block;
+            }
+        }
+    }
+
+    size_t *len = &MP_STATE_MEM(gc_size_class_len)[SIZE_CLASS_LONG];
+    size_t *list = MP_STATE_MEM(gc_size_class_free)[SIZE_CLASS_LONG];
+    size_t max_block = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    while (*len > 0) {
+        size_t block = list[*len - 1];
+        if (block + n_blocks <= max_block && gc_size_class_run_is_free(block, n_blocks)) {
+            // leave the rest of the run on the list; its length is re-checked
+            // by the next allocation that uses it
+            list[*len - 1] = block + n_blocks;
+            return block;
+        }
+        // run is exhausted or was taken by someone else
+        --(*len);
+    }
+    return (size_t)-1;
+}
+#endif
+
+#if MICROPY_GC_PAUSE_STATS
+STATIC void gc_pause_record(mp_uint_t start) {
+    mp_uint_t pause = mp_hal_ticks_us() - start;
+    MP_STATE_MEM(gc_pause_last_us) = pause;
+    if (pause > MP_STATE_MEM(gc_pause_max_us)) {
+        MP_STATE_MEM(gc_pause_max_us) = pause;
+    }
+}
+#endif
+
+// Sweep at least n_blocks blocks starting at block, stopping only at the head
+// of an object or a free block so that a later call can carry on from there.
+// Returns the block following the last one swept.
+STATIC size_t gc_sweep_range(size_t block, size_t n_blocks) {
+    size_t max_block = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    size_t end_block = n_blocks < max_block - block ? block + n_blocks : max_block;
+    #if MICROPY_GC_SIZE_CLASSES
+    size_t free_run = 0;
     #endif
     // free unmarked heads and their tails
     int free_tail = 0;
-    for (size_t block = 0; block < MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB; block++) {
+    for (; block < max_block && (block < end_block || ATB_GET_KIND(block) == AT_TAIL); block++) {
         switch (ATB_GET_KIND(block)) {
             case AT_HEAD:
 #if MICROPY_ENABLE_FINALISER
@@ -300,46 +678,739 @@ STATIC void gc_sweep(void) {
 
             case AT_TAIL:
                 if (free_tail) {
-                    ATB_ANY_TO_FREE(block);
+                    ATB_ANY_TO_FREE_NOSYNC(block);
                 }
                 break;
 
             case AT_MARK:
-                ATB_MARK_TO_HEAD(block);
+                ATB_MARK_TO_HEAD_NOSYNC(block);
                 free_tail = 0;
                 break;
         }
+
+        #if MICROPY_GC_SIZE_CLASSES
+        if (ATB_GET_KIND(block) == AT_FREE) {
+            free_run += 1;
+        } else {
+            gc_size_class_put(block - free_run, free_run);
+            free_run = 0;
+        }
+        #endif
+    }
+
+    #if MICROPY_GC_SIZE_CLASSES
+    gc_size_class_put(block - free_run, free_run);
+    #endif
+
+    return block;
+}
+
+STATIC void gc_sweep_start(void) {
+    #if MICROPY_PY_GC_COLLECT_RETVAL
+    MP_STATE_MEM(gc_collected) = 0;
+    #endif
+    #if MICROPY_GC_SIZE_CLASSES
+    // rebuild the size class lists from the free runs left by this sweep
+    memset(MP_STATE_MEM(gc_size_class_len), 0, sizeof(MP_STATE_MEM(gc_size_class_len)));
+    #endif
+    MP_STATE_MEM(gc_last_free_atb_index) = 0;
+}
+
+#if MICROPY_GC_LAZY_SWEEP
+// Sweep the next slice of the heap left unswept by the last collection.  Must
+// be called with the GC mutex held.  Finalisers may run, so the GC is locked
+// to stop them allocating.
+STATIC void gc_sweep_slice(size_t n_blocks) {
+    size_t max_block = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    if (MP_STATE_MEM(gc_sweep_block) >= max_block) {
+        return;
+    }
+    #if MICROPY_GC_PAUSE_STATS
+    mp_uint_t start = mp_hal_ticks_us();
+    #endif
+    size_t block = MP_STATE_MEM(gc_sweep_block);
+    MP_STATE_MEM(gc_lock_depth)++;
+    MP_STATE_MEM(gc_sweep_block) = gc_sweep_range(block, n_blocks);
+    MP_STATE_MEM(gc_lock_depth)--;
+    // the slice may have freed blocks before the current search start
+    if (block / BLOCKS_PER_ATB < MP_STATE_MEM(gc_last_free_atb_index)) {
+        MP_STATE_MEM(gc_last_free_atb_index) = block / BLOCKS_PER_ATB;
+    }
+    #if MICROPY_GC_PAUSE_STATS
+    gc_pause_record(start);
+    #endif
+}
+
+void gc_sweep_all(void) {
+    GC_ENTER();
+    gc_sweep_slice((size_t)-1);
+    GC_EXIT();
+}
+#endif
+
+#if MICROPY_GC_COMPACT
+// Return the length in blocks of the largest free run in the heap.
+STATIC size_t gc_max_free_blocks(void) {
+    size_t max_block = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    size_t max_free = 0;
+    size_t len = 0;
+    for (size_t block = 0; block < max_block; block++) {
+        if (ATB_GET_KIND(block) == AT_FREE) {
+            len += 1;
+            if (len > max_free) {
+                max_free = len;
+            }
+        } else {
+            len = 0;
+        }
+    }
+    return max_free;
+}
+
+STATIC size_t gc_chain_len(size_t block) {
+    size_t n_blocks = 0;
+    do {
+        n_blocks += 1;
+    } while (ATB_GET_KIND(block + n_blocks) == AT_TAIL);
+    return n_blocks;
+}
+
+#define BLOCKS_FOR_BYTES(n) (((n) + BYTES_PER_BLOCK - 1) / BYTES_PER_BLOCK)
+#define BLOCKS_FOR(type) BLOCKS_FOR_BYTES(sizeof(type))
+#define WORD_OF(type, member) (offsetof(type, member) / sizeof(void*))
+
+// Return the head of the chain which ptr points into, or -1 if it doesn't
+// point into an allocated chain.
+STATIC size_t gc_compact_head(const void *ptr) {
+    if (ptr < (void*)MP_STATE_MEM(gc_pool_start) || ptr >= (void*)MP_STATE_MEM(gc_pool_end)) {
+        return (size_t)-1;
+    }
+    size_t block = BLOCK_FROM_PTR(ptr);
+    while (ATB_GET_KIND(block) == AT_TAIL) {
+        block -= 1;
+    }
+    return ATB_GET_KIND(block) == AT_FREE ? (size_t)-1 : block;
+}
+
+// The words of an object which compaction knows to hold pointers: a pointer
+// to raw data, a pointer to an array of n_arr objects, and an inline array of
+// n_inline objects.  Word 0, the type, is never a heap pointer.
+typedef struct _gc_compact_layout_t {
+    size_t raw;
+    size_t arr;
+    size_t n_arr;
+    size_t inline_first;
+    size_t n_inline;
+} gc_compact_layout_t;
+
+// Work out the layout of the object at block if it's of one of the few types
+// compaction understands.  The lengths are checked against the chain so that
+// other blocks which happen to start with one of these type pointers are, as
+// far as possible, not taken for objects.
+STATIC bool gc_compact_layout(size_t block, size_t n_blocks, gc_compact_layout_t *l) {
+    void *obj = (void*)PTR_FROM_BLOCK(block);
+    const mp_obj_type_t *type = ((mp_obj_base_t*)obj)->type;
+    memset(l, 0, sizeof(*l));
+    size_t expected;
+    if (type == &mp_type_str || type == &mp_type_bytes) {
+        expected = BLOCKS_FOR(mp_obj_str_t);
+        l->raw = WORD_OF(mp_obj_str_t, data);
+    } else if (type == &mp_type_list) {
+        const mp_obj_list_t *o = obj;
+        if (o->len > o->alloc) {
+            return false;
+        }
+        expected = BLOCKS_FOR(mp_obj_list_t);
+        l->arr = WORD_OF(mp_obj_list_t, items);
+        l->n_arr = o->alloc;
+    } else if (type == &mp_type_tuple) {
+        const mp_obj_tuple_t *o = obj;
+        if (o->len > n_blocks * WORDS_PER_BLOCK) {
+            return false;
+        }
+        expected = BLOCKS_FOR_BYTES(sizeof(mp_obj_tuple_t) + o->len * sizeof(mp_obj_t));
+        l->inline_first = WORD_OF(mp_obj_tuple_t, items);
+        l->n_inline = o->len;
+    } else if (type == &mp_type_dict) {
+        const mp_obj_dict_t *o = obj;
+        expected = BLOCKS_FOR(mp_obj_dict_t);
+        l->arr = WORD_OF(mp_obj_dict_t, map.table);
+        l->n_arr = 2 * o->map.alloc;
+    #if MICROPY_PY_BUILTINS_BYTEARRAY || MICROPY_PY_ARRAY
+    #if MICROPY_PY_BUILTINS_BYTEARRAY
+    } else if (type == &mp_type_bytearray) {
+        expected = BLOCKS_FOR(mp_obj_array_t);
+        l->raw = WORD_OF(mp_obj_array_t, items);
+    #endif
+    #if MICROPY_PY_ARRAY
+    } else if (type == &mp_type_array) {
+        expected = BLOCKS_FOR(mp_obj_array_t);
+        l->raw = WORD_OF(mp_obj_array_t, items);
+    #endif
+    #endif
+    #if MICROPY_LONGINT_IMPL == MICROPY_LONGINT_IMPL_MPZ
+    } else if (type == &mp_type_int) {
+        expected = BLOCKS_FOR(mp_obj_int_t);
+        l->raw = WORD_OF(mp_obj_int_t, mpz.dig);
+    #endif
+    #if MICROPY_PY_BUILTINS_FLOAT && MICROPY_OBJ_REPR != MICROPY_OBJ_REPR_C
+    } else if (type == &mp_type_float) {
+        expected = BLOCKS_FOR_BYTES(sizeof(mp_obj_base_t) + sizeof(mp_float_t));
+    #endif
+    #if MICROPY_PY_BUILTINS_COMPLEX
+    } else if (type == &mp_type_complex) {
+        expected = BLOCKS_FOR_BYTES(sizeof(mp_obj_base_t) + 2 * sizeof(mp_float_t));
+    #endif
+    } else {
+        return false;
+    }
+    return n_blocks == expected;
+}
+
+// Only objects of a few built-in types are moved: nothing points into the
+// middle of them and their hash doesn't depend on their address.  Lists,
+// tuples and dicts are understood but not moved.
+STATIC bool gc_compact_can_move(size_t block) {
+    if (!CTB_GET(OBJ_TABLE(), block) || CTB_GET(PIN_TABLE(), block) || FTB_GET(block)) {
+        return false;
+    }
+    const mp_obj_type_t *type = ((mp_obj_base_t*)PTR_FROM_BLOCK(block))->type;
+    return type != &mp_type_tuple && type != &mp_type_dict;
+}
+
+typedef void (*gc_compact_word_fun_t)(void **word, bool precise);
+
+// Call fun on each word of the chain at block, and on the array of a list or
+// dict, saying whether the word is known to hold a pointer.  Known arrays are
+// visited through their owner and are skipped here.
+STATIC void gc_compact_visit(size_t block, gc_compact_word_fun_t fun) {
+    if (LTB_GET(block) || CTB_GET(FWD_TABLE(), block)) {
+        return;
+    }
+    void **words = (void**)PTR_FROM_BLOCK(block);
+    size_t n_blocks = gc_chain_len(block);
+    size_t n_words = n_blocks * WORDS_PER_BLOCK;
+    if (CTB_GET(ARR_TABLE(), block)) {
+        return;
+    }
+    if (!CTB_GET(OBJ_TABLE(), block)) {
+        for (size_t i = 0; i < n_words; i++) {
+            fun(&words[i], false);
+        }
+        return;
+    }
+    gc_compact_layout_t l;
+    gc_compact_layout(block, n_blocks, &l);
+    for (size_t i = 1; i < n_words; i++) {
+        bool precise = i == l.raw || i == l.arr
+            || (i >= l.inline_first && i < l.inline_first + l.n_inline);
+        fun(&words[i], precise);
+    }
+    if (l.arr != 0 && VERIFY_PTR(words[l.arr])) {
+        size_t arr = BLOCK_FROM_PTR(words[l.arr]);
+        if (CTB_GET(ARR_TABLE(), arr)) {
+            void **items = (void**)PTR_FROM_BLOCK(arr);
+            size_t n_items = gc_chain_len(arr) * WORDS_PER_BLOCK;
+            for (size_t i = 0; i < n_items; i++) {
+                fun(&items[i], i < l.n_arr);
+            }
+        }
+    }
+}
+
+// Pin whatever a word which may not be a pointer points into.
+STATIC void gc_compact_pin_word(void **word, bool precise) {
+    if (!precise) {
+        size_t block = gc_compact_head(*word);
+        if (block != (size_t)-1) {
+            CTB_SET(PIN_TABLE(), block);
+        }
+    }
+}
+
+// Point a pointer into a moved chain at its new copy.
+STATIC void gc_compact_rewrite_word(void **word, bool precise) {
+    if (precise) {
+        size_t block = gc_compact_head(*word);
+        if (block != (size_t)-1 && CTB_GET(FWD_TABLE(), block)) {
+            byte *from = (byte*)PTR_FROM_BLOCK(block);
+            *word = *(byte**)from + ((byte*)*word - from);
+        }
+    }
+}
+
+// Find the lowest free run of n_blocks below limit, starting the search at
+// *lo which is advanced past any leading blocks that are in use.
+STATIC size_t gc_compact_find_free(size_t *lo, size_t limit, size_t n_blocks) {
+    while (*lo < limit && ATB_GET_KIND(*lo) != AT_FREE) {
+        *lo += 1;
+    }
+    size_t len = 0;
+    for (size_t block = *lo; block < limit; block++) {
+        if (ATB_GET_KIND(block) == AT_FREE) {
+            if (++len == n_blocks) {
+                return block + 1 - n_blocks;
+            }
+        } else {
+            len = 0;
+        }
+    }
+    return (size_t)-1;
+}
+
+// Called at the end of a compacting collection, once the heap has been fully
+// swept.  The collector is conservative, so only words known to be pointers
+// are ever rewritten, and anything a word of unknown meaning points to is
+// pinned.  Known objects are identified by their type and length, then the
+// raw data and object arrays they point to are recorded so that those are
+// never taken for objects themselves.  Movable objects are then copied, from
+// the top of the heap down, into the lowest free run which fits them; then
+// every known pointer to a moved object is rewritten; then the old copies are
+// freed.
+STATIC void gc_compact_heap(void) {
+    gc_compact_info_t *info = MP_STATE_MEM(gc_compact_info);
+    byte *pin = PIN_TABLE();
+    byte *fwd = FWD_TABLE();
+    byte *obj = OBJ_TABLE();
+    size_t max_block = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+
+    info->moved = 0;
+    info->max_free_before = gc_max_free_blocks() * BYTES_PER_BLOCK;
+
+    // identify known objects
+    for (size_t block = 0; block < max_block; block++) {
+        gc_compact_layout_t l;
+        if (ATB_GET_KIND(block) == AT_HEAD && !LTB_GET(block)
+            && gc_compact_layout(block, gc_chain_len(block), &l)) {
+            CTB_SET(obj, block);
+        }
+    }
+
+    // raw data is never an object, even if it starts with a type pointer
+    for (size_t block = 0; block < max_block; block++) {
+        if (CTB_GET(obj, block)) {
+            gc_compact_layout_t l;
+            gc_compact_layout(block, gc_chain_len(block), &l);
+            if (l.raw != 0) {
+                size_t raw = gc_compact_head(((void**)PTR_FROM_BLOCK(block))[l.raw]);
+                if (raw != (size_t)-1 && !LTB_GET(raw)) {
+                    CTB_SET(RAW_TABLE(), raw);
+                }
+            }
+        }
+    }
+    for (size_t block = 0; block < max_block; block++) {
+        if (CTB_GET(RAW_TABLE(), block)) {
+            CTB_CLEAR(obj, block);
+        }
+    }
+
+    // record the object arrays of lists and dicts, checking they're big enough
+    for (size_t block = 0; block < max_block; block++) {
+        gc_compact_layout_t l;
+        if (!CTB_GET(obj, block) || !gc_compact_layout(block, gc_chain_len(block), &l) || l.arr == 0) {
+            continue;
+        }
+        void *items = ((void**)PTR_FROM_BLOCK(block))[l.arr];
+        if (!VERIFY_PTR(items)) {
+            continue;
+        }
+        size_t arr = BLOCK_FROM_PTR(items);
+        if (ATB_GET_KIND(arr) != AT_HEAD || LTB_GET(arr) || CTB_GET(obj, arr) || CTB_GET(RAW_TABLE(), arr)
+            || l.n_arr > gc_chain_len(arr) * WORDS_PER_BLOCK) {
+            continue;
+        }
+        CTB_SET(ARR_TABLE(), arr);
+    }
+
+    // pin everything pointed to by a word which may not be a pointer
+    for (size_t block = 0; block < max_block; block++) {
+        if (ATB_GET_KIND(block) == AT_HEAD) {
+            gc_compact_visit(block, gc_compact_pin_word);
+        }
+    }
+
+    // move objects; free space below the current block only shrinks, so once
+    // an object of some size doesn't fit then no larger object will either
+    size_t lo = 0;
+    size_t fail_n = (size_t)-1;
+    for (size_t block = max_block; block-- > lo;) {
+        if (ATB_GET_KIND(block) != AT_HEAD || !gc_compact_can_move(block)) {
+            continue;
+        }
+        size_t n_blocks = gc_chain_len(block);
+        if (n_blocks >= fail_n) {
+            continue;
+        }
+        size_t dest = gc_compact_find_free(&lo, block, n_blocks);
+        if (dest == (size_t)-1) {
+            fail_n = n_blocks;
+            continue;
+        }
+        ATB_FREE_TO_HEAD(dest);
+        for (size_t i = 1; i < n_blocks; i++) {
+            ATB_FREE_TO_TAIL(dest + i);
+        }
+        LTB_CLEAR(dest);
+        FTB_CLEAR(dest);
+        void **from = (void**)PTR_FROM_BLOCK(block);
+        void **to = (void**)PTR_FROM_BLOCK(dest);
+        memcpy(to, from, n_blocks * BYTES_PER_BLOCK);
+        *from = to;
+        CTB_SET(fwd, block);
+        CTB_SET(pin, dest);
+        CTB_SET(obj, dest);
+        info->moved += 1;
+    }
+
+    if (info->moved != 0) {
+        // rewrite the known pointers held in the heap
+        for (size_t block = 0; block < max_block; block++) {
+            if (ATB_GET_KIND(block) == AT_HEAD) {
+                gc_compact_visit(block, gc_compact_rewrite_word);
+            }
+        }
+
+        // free the old copies
+        for (size_t block = 0; block < max_block; block++) {
+            if (CTB_GET(fwd, block)) {
+                size_t n_blocks = gc_chain_len(block);
+                for (size_t i = 0; i < n_blocks; i++) {
+                    ATB_ANY_TO_FREE(block + i);
+                }
+                block += n_blocks - 1;
+            }
+        }
+
+        #if MICROPY_GC_SIZE_CLASSES
+        // the lists no longer describe the free space, fall back to scanning
+        memset(MP_STATE_MEM(gc_size_class_len), 0, sizeof(MP_STATE_MEM(gc_size_class_len)));
+        #endif
+    }
+
+    info->max_free_after = gc_max_free_blocks() * BYTES_PER_BLOCK;
+}
+
+bool gc_compact(gc_compact_info_t *info) {
+    size_t table_len = CTB_NUM_TABLES * CTB_LEN();
+    byte *table = m_new_leaf_maybe(byte, table_len);
+    if (table == NULL) {
+        return false;
+    }
+    memset(table, 0, table_len);
+    MP_STATE_MEM(gc_compact_info) = info;
+    MP_STATE_MEM(gc_compact_table) = table;
+    gc_collect();
+    MP_STATE_MEM(gc_compact_table) = NULL;
+    m_del(byte, table, table_len);
+    return true;
+}
+
+void gc_pin(const void *ptr) {
+    if (VERIFY_PTR(ptr)) {
+        GC_ENTER();
+        size_t block = BLOCK_FROM_PTR(ptr);
+        // with a lazy sweep, live heads not yet swept are still marked
+        if (ATB_IS_HEAD(block)) {
+            // objects which may have a finaliser are never moved; one
+            // without a __del__ method only costs a lookup when it's freed
+            FTB_SET(block);
+        }
+        GC_EXIT();
+    }
+}
+#endif
+
+#if MICROPY_GC_TLAB
+// Allocation buffers.  A thread's buffer is a chain of blocks reserved under
+// the GC mutex; the unused part of it is always a single chain so the heap
+// stays consistent, and allocating from it turns the head of that chain into
+// the new object and the block after it into the head of the rest.  Nothing
+// refers to the rest of the buffer, so a collection frees it.
+//
+// A collection must not run while a thread is allocating from its buffer.
+// The collector sets gc_tlab_stop and then waits for each thread's busy flag
+// to clear, while a thread sets its busy flag and then checks gc_tlab_stop
+// before allocating.  Advancing the epoch then makes all buffers stale.
+
+STATIC void *gc_tlab_carve(mp_state_thread_t *ts, size_t n_blocks, bool leaf) {
+    size_t block = ts->gc_tlab_block;
+    size_t next = block + n_blocks;
+    if (next < ts->gc_tlab_end) {
+        ATB_TAIL_TO_HEAD(next);
+    }
+    #if MICROPY_GC_LEAF_BLOCKS
+    if (leaf) {
+        LTB_SET(block);
+    } else {
+        LTB_CLEAR(block);
+    }
+    #else
+    (void)leaf;
+    #endif
+    ts->gc_tlab_block = next;
+    return (void*)PTR_FROM_BLOCK(block);
+}
+
+// Allocate from the calling thread's buffer without the GC mutex.  Returns
+// NULL if the buffer is stale or too small, or a collection is running.
+STATIC void *gc_tlab_alloc(size_t n_blocks, bool leaf) {
+    mp_state_thread_t *ts = mp_thread_get_state();
+    if (ts->gc_tlab_slot == 0) {
+        return NULL;
+    }
+    int *busy = &MP_STATE_MEM(gc_tlab_slot)[ts->gc_tlab_slot - 1].busy;
+    __atomic_store_n(busy, 1, __ATOMIC_SEQ_CST);
+    void *ptr = NULL;
+    if (!__atomic_load_n(&MP_STATE_MEM(gc_tlab_stop), __ATOMIC_SEQ_CST)
+        && ts->gc_tlab_epoch == MP_STATE_MEM(gc_tlab_epoch)
+        && ts->gc_tlab_end - ts->gc_tlab_block >= n_blocks
+        && MP_STATE_MEM(gc_lock_depth) == 0) {
+        ptr = gc_tlab_carve(ts, n_blocks, leaf);
+    }
+    __atomic_store_n(busy, 0, __ATOMIC_RELEASE);
+    return ptr;
+}
+
+// Free the unused part of the calling thread's buffer.  Must be called with
+// the GC mutex held.
+STATIC void gc_tlab_release(mp_state_thread_t *ts) {
+    if (ts->gc_tlab_epoch != MP_STATE_MEM(gc_tlab_epoch) || ts->gc_tlab_block >= ts->gc_tlab_end) {
+        return;
+    }
+    for (size_t block = ts->gc_tlab_block; block < ts->gc_tlab_end; block++) {
+        ATB_ANY_TO_FREE(block);
+    }
+    if (ts->gc_tlab_block / BLOCKS_PER_ATB < MP_STATE_MEM(gc_last_free_atb_index)) {
+        MP_STATE_MEM(gc_last_free_atb_index) = ts->gc_tlab_block / BLOCKS_PER_ATB;
+    }
+    ts->gc_tlab_end = ts->gc_tlab_block;
+}
+
+// Give the calling thread a new buffer and allocate n_blocks from it.  Must
+// be called with the GC mutex held.  Returns NULL if there's no free run to
+// use as a buffer, in which case the caller falls back to a normal allocation.
+STATIC void *gc_tlab_refill(size_t n_blocks, bool leaf) {
+    mp_state_thread_t *ts = mp_thread_get_state();
+    if (ts->gc_tlab_slot == 0) {
+        for (size_t i = 0; i < MICROPY_GC_TLAB_SLOTS; i++) {
+            if (!MP_STATE_MEM(gc_tlab_slot)[i].claimed) {
+                MP_STATE_MEM(gc_tlab_slot)[i].claimed = 1;
+                ts->gc_tlab_slot = i + 1;
+                break;
+            }
+        }
+        if (ts->gc_tlab_slot == 0) {
+            return NULL;
+        }
     }
+    gc_tlab_release(ts);
+
+    // take the lowest free run of at least n_blocks, up to
+    // MICROPY_GC_TLAB_BLOCKS of it, as the linear scan in gc_alloc would.
+    // This keeps small objects packed together at the bottom of the heap
+    // instead of spread over it, which would leave no room for large objects.
+    // With a lazy sweep only the swept part of the heap can be used, as a
+    // sweep slice may run while this thread allocates from the buffer.
+    size_t limit = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    #if MICROPY_GC_LAZY_SWEEP
+    limit = MIN(limit, MP_STATE_MEM(gc_sweep_block));
+    #endif
+    size_t start_block = 0;
+    size_t n_free = 0;
+    bool skipped_free = false;
+    byte *atb = MP_STATE_MEM(gc_alloc_table_start);
+    for (size_t block = MP_STATE_MEM(gc_last_free_atb_index) * BLOCKS_PER_ATB; block < limit; block++) {
+        if (n_free == 0 && block % BLOCKS_PER_ATB == 0) {
+            byte a = atb[block / BLOCKS_PER_ATB];
+            if (!ATB_0_IS_FREE(a) && !ATB_1_IS_FREE(a) && !ATB_2_IS_FREE(a) && !ATB_3_IS_FREE(a)) {
+                // skip a table byte with no free blocks
+                block += BLOCKS_PER_ATB - 1;
+                continue;
+            }
+        }
+        if (ATB_GET_KIND(block) == AT_FREE) {
+            if (n_free++ == 0) {
+                start_block = block;
+            }
+            if (n_free == MICROPY_GC_TLAB_BLOCKS) {
+                break;
+            }
+        } else if (n_free >= n_blocks) {
+            break;
+        } else {
+            skipped_free |= n_free != 0;
+            n_free = 0;
+        }
+    }
+    if (n_free < n_blocks) {
+        return NULL;
+    }
+    if (!skipped_free) {
+        // as in gc_alloc, there are now no free blocks before the buffer's end
+        MP_STATE_MEM(gc_last_free_atb_index) = (start_block + n_free) / BLOCKS_PER_ATB;
+    }
+
+    // make the buffer a head followed by tails.  Table bytes at either end
+    // may be shared with other blocks so are updated atomically per block,
+    // while those in between belong to the buffer alone and are stored whole.
+    // Free blocks never have the finaliser bit set.
+    size_t end_block = start_block + n_free;
+    ATB_FREE_TO_HEAD(start_block);
+    size_t block = start_block + 1;
+    for (; block < end_block && block % BLOCKS_PER_ATB != 0; block++) {
+        ATB_FREE_TO_TAIL(block);
+    }
+    for (; block + BLOCKS_PER_ATB <= end_block; block += BLOCKS_PER_ATB) {
+        __atomic_store_n(&atb[block / BLOCKS_PER_ATB], AT_TAIL * 0x55, __ATOMIC_RELAXED);
+    }
+    for (; block < end_block; block++) {
+        ATB_FREE_TO_TAIL(block);
+    }
+    memset((void*)PTR_FROM_BLOCK(start_block), 0, n_free * BYTES_PER_BLOCK);
+    #if MICROPY_GC_ALLOC_THRESHOLD
+    MP_STATE_MEM(gc_alloc_amount) += n_free;
+    #endif
+
+    ts->gc_tlab_block = start_block;
+    ts->gc_tlab_end = start_block + n_free;
+    ts->gc_tlab_epoch = MP_STATE_MEM(gc_tlab_epoch);
+    return gc_tlab_carve(ts, n_blocks, leaf);
+}
+
+// Stop all threads allocating from their buffers and make the buffers stale.
+// Must be called with the GC mutex held.
+STATIC void gc_tlab_stop(void) {
+    __atomic_store_n(&MP_STATE_MEM(gc_tlab_stop), 1, __ATOMIC_SEQ_CST);
+    for (size_t i = 0; i < MICROPY_GC_TLAB_SLOTS; i++) {
+        while (__atomic_load_n(&MP_STATE_MEM(gc_tlab_slot)[i].busy, __ATOMIC_SEQ_CST)) {
+        }
+    }
+    MP_STATE_MEM(gc_tlab_epoch) += 1;
+}
+
+void gc_tlab_init_thread(void) {
+    mp_state_thread_t *ts = mp_thread_get_state();
+    ts->gc_tlab_block = 0;
+    ts->gc_tlab_end = 0;
+    ts->gc_tlab_epoch = 0;
+    ts->gc_tlab_slot = 0;
 }
 
+void gc_tlab_deinit_thread(void) {
+    mp_state_thread_t *ts = mp_thread_get_state();
+    GC_ENTER();
+    gc_tlab_release(ts);
+    if (ts->gc_tlab_slot != 0) {
+        MP_STATE_MEM(gc_tlab_slot)[ts->gc_tlab_slot - 1].claimed = 0;
+        ts->gc_tlab_slot = 0;
+    }
+    GC_EXIT();
+}
+#endif
+
 void gc_collect_start(void) {
     GC_ENTER();
+    #if MICROPY_GC_TLAB
+    gc_tlab_stop();
+    #endif
+    #if MICROPY_GC_LAZY_SWEEP
+    // marking relies on all live heads being unmarked, so finish any
+    // outstanding sweep from the previous collection first
+    gc_sweep_slice((size_t)-1);
+    #endif
+    #if MICROPY_GC_PAUSE_STATS
+    MP_STATE_MEM(gc_pause_start) = mp_hal_ticks_us();
+    #endif
     MP_STATE_MEM(gc_lock_depth)++;
     #if MICROPY_GC_ALLOC_THRESHOLD
     MP_STATE_MEM(gc_alloc_amount) = 0;
     #endif
     MP_STATE_MEM(gc_stack_overflow) = 0;
     MP_STATE_MEM(gc_sp) = MP_STATE_MEM(gc_stack);
+    #if MICROPY_GC_PARALLEL_MARK
+    MP_STATE_MEM(gc_mark_pool_len) = 0;
+    #endif
     // Trace root pointers.  This relies on the root pointers being organised
     // correctly in the mp_state_ctx structure.  We scan nlr_top, dict_locals,
     // dict_globals, then the root pointer section of mp_state_vm.
     void **ptrs = (void**)(void*)&mp_state_ctx;
     gc_collect_root(ptrs, offsetof(mp_state_ctx_t, vm.qstr_last_chunk) / sizeof(void*));
+    #if MICROPY_GC_COMPACT
+    if (MP_STATE_MEM(gc_compact_table) != NULL) {
+        gc_collect_root((void**)&MP_STATE_MEM(gc_compact_table), 1);
+    }
+    #endif
 }
 
 void gc_collect_root(void **ptrs, size_t len) {
     for (size_t i = 0; i < len; i++) {
         void *ptr = ptrs[i];
+        #if MICROPY_GC_COMPACT
+        if (MP_STATE_MEM(gc_compact_table) != NULL
+            && ptr >= (void*)MP_STATE_MEM(gc_pool_start) && ptr < (void*)MP_STATE_MEM(gc_pool_end)) {
+            // roots can't be rewritten, so pin whatever chain they point into
+            size_t block = BLOCK_FROM_PTR(ptr);
+            while (block > 0 && ATB_GET_KIND(block) == AT_TAIL) {
+                block -= 1;
+            }
+            CTB_SET(PIN_TABLE(), block);
+        }
+        #endif
         VERIFY_MARK_AND_PUSH(ptr);
+        #if MICROPY_GC_PARALLEL_MARK
+        if (MP_STATE_MEM(gc_mark_threads) > 1) {
+            // leave tracing to the mark threads unless the stack is full
+            if (MP_STATE_MEM(gc_sp) == &MP_STATE_MEM(gc_stack)[MICROPY_ALLOC_GC_STACK_SIZE]) {
+                gc_mark_flush_roots();
+            }
+            continue;
+        }
+        #endif
         gc_drain_stack();
     }
 }
 
 void gc_collect_end(void) {
+    #if MICROPY_GC_PARALLEL_MARK
+    if (MP_STATE_MEM(gc_mark_threads) > 1) {
+        gc_mark_parallel();
+    }
+    #endif
     gc_deal_with_stack_overflow();
-    gc_sweep();
-    MP_STATE_MEM(gc_last_free_atb_index) = 0;
+    #if MICROPY_OPT_STR_INPLACE_ADD
+    // the += buffer is only weakly referenced, forget it if it's about to be freed
+    void *str_buf = (void*)MP_STATE_VM(str_append_buf);
+    if (str_buf != NULL && (!VERIFY_PTR(str_buf) || ATB_GET_KIND(BLOCK_FROM_PTR(str_buf)) != AT_MARK)) {
+        MP_STATE_VM(str_append_buf) = NULL;
+    }
+    #endif
+    gc_sweep_start();
+    #if MICROPY_GC_COMPACT
+    if (MP_STATE_MEM(gc_compact_table) != NULL) {
+        // compaction needs the whole heap swept
+        gc_sweep_range(0, (size_t)-1);
+        #if MICROPY_GC_LAZY_SWEEP
+        MP_STATE_MEM(gc_sweep_block) = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+        #endif
+        gc_compact_heap();
+    } else
+    #endif
+    {
+        #if MICROPY_GC_LAZY_SWEEP
+        // sweep the first slice now, the rest is swept by subsequent allocations
+        MP_STATE_MEM(gc_sweep_block) = gc_sweep_range(0, MP_STATE_MEM(gc_sweep_slice_blocks));
+        #else
+        gc_sweep_range(0, (size_t)-1);
+        #endif
+    }
     MP_STATE_MEM(gc_lock_depth)--;
+    #if MICROPY_GC_PAUSE_STATS
+    gc_pause_record(MP_STATE_MEM(gc_pause_start));
+    #endif
+    #if MICROPY_GC_TLAB
+    __atomic_store_n(&MP_STATE_MEM(gc_tlab_stop), 0, __ATOMIC_RELEASE);
+    #endif
     GC_EXIT();
 }
 
@@ -352,6 +1423,10 @@ void gc_info(gc_info_t *info) {
     info->num_1block = 0;
     info->num_2block = 0;
     info->max_block = 0;
+    #if MICROPY_GC_SIZE_CLASSES
+    info->size_class_hits = MP_STATE_MEM(gc_size_class_hits);
+    info->size_class_misses = MP_STATE_MEM(gc_size_class_misses);
+    #endif
     bool finish = false;
     for (size_t block = 0, len = 0, len_free = 0; !finish;) {
         size_t kind = ATB_GET_KIND(block);
@@ -362,6 +1437,9 @@ void gc_info(gc_info_t *info) {
                 len = 0;
                 break;
 
+            #if MICROPY_GC_LAZY_SWEEP
+            case AT_MARK:
+            #endif
             case AT_HEAD:
                 info->used += 1;
                 len = 1;
@@ -372,9 +1450,11 @@ void gc_info(gc_info_t *info) {
                 len += 1;
                 break;
 
+            #if !MICROPY_GC_LAZY_SWEEP
             case AT_MARK:
                 // shouldn't happen
                 break;
+            #endif
         }
 
         block++;
@@ -384,7 +1464,7 @@ void gc_info(gc_info_t *info) {
             kind = ATB_GET_KIND(block);
         }
 
-        if (finish || kind == AT_FREE || kind == AT_HEAD) {
+        if (finish || kind == AT_FREE || kind == AT_HEAD || kind == AT_MARK) {
             if (len == 1) {
                 info->num_1block += 1;
             } else if (len == 2) {
@@ -393,7 +1473,7 @@ void gc_info(gc_info_t *info) {
             if (len > info->max_block) {
                 info->max_block = len;
             }
-            if (finish || kind == AT_HEAD) {
+            if (finish || kind == AT_HEAD || kind == AT_MARK) {
                 if (len_free > info->max_free) {
                     info->max_free = len_free;
                 }
@@ -407,7 +1487,11 @@ void gc_info(gc_info_t *info) {
     GC_EXIT();
 }
 
+#if MICROPY_GC_LEAF_BLOCKS
+STATIC void *gc_alloc_blocks(size_t n_bytes, bool has_finaliser, bool leaf) {
+#else
 void *gc_alloc(size_t n_bytes, bool has_finaliser) {
+#endif
     size_t n_blocks = ((n_bytes + BYTES_PER_BLOCK - 1) & (~(BYTES_PER_BLOCK - 1))) / BYTES_PER_BLOCK;
     DEBUG_printf("gc_alloc(" UINT_FMT " bytes -> " UINT_FMT " blocks)\n", n_bytes, n_blocks);
 
@@ -416,6 +1500,19 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser) {
         return NULL;
     }
 
+    #if MICROPY_GC_TLAB
+    #if !MICROPY_GC_LEAF_BLOCKS
+    bool leaf = false;
+    #endif
+    bool use_tlab = n_blocks <= GC_TLAB_MAX_OBJ_BLOCKS && !has_finaliser;
+    if (use_tlab) {
+        void *ptr = gc_tlab_alloc(n_blocks, leaf);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+    #endif
+
     GC_ENTER();
 
     // check if GC is locked
@@ -427,7 +1524,7 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser) {
     size_t i;
     size_t end_block;
     size_t start_block;
-    size_t n_free = 0;
+    size_t n_free;
     int collected = !MP_STATE_MEM(gc_auto_collect_enabled);
 
     #if MICROPY_GC_ALLOC_THRESHOLD
@@ -438,9 +1535,38 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser) {
     }
     #endif
 
+    #if MICROPY_GC_LAZY_SWEEP
+    // each allocation pays for a slice of the outstanding sweep
+    gc_sweep_slice(MP_STATE_MEM(gc_sweep_slice_blocks));
+    #endif
+
+    #if MICROPY_GC_TLAB
+    if (use_tlab) {
+        void *ptr = gc_tlab_refill(n_blocks, leaf);
+        if (ptr != NULL) {
+            GC_EXIT();
+            return ptr;
+        }
+    }
+    #endif
+
     for (;;) {
 
+        #if MICROPY_GC_SIZE_CLASSES
+        // small allocations first try the free run lists built by the sweep
+        if (n_blocks <= MICROPY_GC_SIZE_CLASSES) {
+            start_block = gc_size_class_take(n_blocks);
+            if (start_block != (size_t)-1) {
+                MP_STATE_MEM(gc_size_class_hits)++;
+                end_block = start_block + n_blocks - 1;
+                goto found_run;
+            }
+            MP_STATE_MEM(gc_size_class_misses)++;
+        }
+        #endif
+
         // look for a run of n_blocks available blocks
+        n_free = 0;
         for (i = MP_STATE_MEM(gc_last_free_atb_index); i < MP_STATE_MEM(gc_alloc_table_byte_len); i++) {
             byte a = MP_STATE_MEM(gc_alloc_table_start)[i];
             if (ATB_0_IS_FREE(a)) { if (++n_free >= n_blocks) { i = i * BLOCKS_PER_ATB + 0; goto found; } } else { n_free = 0; }
@@ -449,6 +1575,14 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser) {
             if (ATB_3_IS_FREE(a)) { if (++n_free >= n_blocks) { i = i * BLOCKS_PER_ATB + 3; goto found; } } else { n_free = 0; }
         }
 
+        #if MICROPY_GC_LAZY_SWEEP
+        // finish the outstanding sweep before resorting to a new collection
+        if (MP_STATE_MEM(gc_sweep_block) < MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB) {
+            gc_sweep_slice((size_t)-1);
+            continue;
+        }
+        #endif
+
         GC_EXIT();
         // nothing found!
         if (collected) {
@@ -475,12 +1609,32 @@ found:
         MP_STATE_MEM(gc_last_free_atb_index) = (i + 1) / BLOCKS_PER_ATB;
     }
 
+    #if MICROPY_GC_SIZE_CLASSES
+found_run:
+    #endif
+
     #ifdef LOG_HEAP_ACTIVITY
     gc_log_change(start_block, end_block - start_block + 1);
     #endif
 
     // mark first block as used head
     ATB_FREE_TO_HEAD(start_block);
+    #if MICROPY_GC_LAZY_SWEEP
+    if (start_block >= MP_STATE_MEM(gc_sweep_block)) {
+        // not swept yet, so allocate it marked to survive the sweep
+        ATB_HEAD_TO_MARK(start_block);
+    }
+    #endif
+
+    #if MICROPY_GC_LEAF_BLOCKS
+    // the leaf flag is not cleared when blocks are freed, so always set it
+    // explicitly here
+    if (leaf) {
+        LTB_SET(start_block);
+    } else {
+        LTB_CLEAR(start_block);
+    }
+    #endif
 
     // mark rest of blocks as used tail
     // TODO for a run of many blocks can make this more efficient
@@ -531,6 +1685,16 @@ found:
     return ret_ptr;
 }
 
+#if MICROPY_GC_LEAF_BLOCKS
+void *gc_alloc(size_t n_bytes, bool has_finaliser) {
+    return gc_alloc_blocks(n_bytes, has_finaliser, false);
+}
+
+void *gc_alloc_leaf(size_t n_bytes) {
+    return gc_alloc_blocks(n_bytes, false, true);
+}
+#endif
+
 /*
 void *gc_alloc(mp_uint_t n_bytes) {
     return _gc_alloc(n_bytes, false);
@@ -559,7 +1723,7 @@ void gc_free(void *ptr) {
         // get the GC block number corresponding to this pointer
         assert(VERIFY_PTR(ptr));
         size_t block = BLOCK_FROM_PTR(ptr);
-        assert(ATB_GET_KIND(block) == AT_HEAD);
+        assert(ATB_IS_HEAD(block));
 
         #if MICROPY_ENABLE_FINALISER
         FTB_CLEAR(block);
@@ -574,11 +1738,19 @@ void gc_free(void *ptr) {
             #ifdef LOG_HEAP_ACTIVITY
             gc_log_change(block, 0);
             #endif
+        #if MICROPY_GC_SIZE_CLASSES
+        size_t start_block = block;
+        #endif
         do {
             ATB_ANY_TO_FREE(block);
             block += 1;
         } while (ATB_GET_KIND(block) == AT_TAIL);
 
+        #if MICROPY_GC_SIZE_CLASSES
+        // make the freed run available to small allocations straight away
+        gc_size_class_put(start_block, block - start_block);
+        #endif
+
         GC_EXIT();
 
         #if EXTENSIVE_HEAP_PROFILING
@@ -591,7 +1763,7 @@ size_t gc_nbytes(const void *ptr) {
     GC_ENTER();
     if (VERIFY_PTR(ptr)) {
         size_t block = BLOCK_FROM_PTR(ptr);
-        if (ATB_GET_KIND(block) == AT_HEAD) {
+        if (ATB_IS_HEAD(block)) {
             // work out number of consecutive blocks in the chain starting with this on
             size_t n_blocks = 0;
             do {
@@ -661,7 +1833,7 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
     GC_ENTER();
 
     // sanity check the ptr is pointing to the head of a block
-    if (ATB_GET_KIND(block) != AT_HEAD) {
+    if (!ATB_IS_HEAD(block)) {
         GC_EXIT();
         return NULL;
     }
@@ -766,6 +1938,10 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
     bool ftb_state = false;
     #endif
 
+    #if MICROPY_GC_LEAF_BLOCKS
+    bool ltb_state = LTB_GET(block);
+    #endif
+
     GC_EXIT();
 
     if (!allow_move) {
@@ -774,7 +1950,11 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
     }
 
     // can't resize inplace; try to find a new contiguous chain
+    #if MICROPY_GC_LEAF_BLOCKS
+    void *ptr_out = gc_alloc_blocks(n_bytes, ftb_state, ltb_state);
+    #else
     void *ptr_out = gc_alloc(n_bytes, ftb_state);
+    #endif
 
     // check that the alloc succeeded
     if (ptr_out == NULL) {
@@ -793,8 +1973,13 @@ void gc_dump_info(void) {
     gc_info(&info);
     mp_printf(&mp_plat_print, "GC: total: %u, used: %u, free: %u\n",
         (uint)info.total, (uint)info.used, (uint)info.free);
-    mp_printf(&mp_plat_print, " No. of 1-blocks: %u, 2-blocks: %u, max blk sz: %u, max free sz: %u\n",
+    mp_printf(&mp_plat_print, " No. of 1-blocks: %u, 2-blocks: %u, max blk sz: %u, max free sz: %u",
            (uint)info.num_1block, (uint)info.num_2block, (uint)info.max_block, (uint)info.max_free);
+    #if MICROPY_GC_SIZE_CLASSES
+    mp_printf(&mp_plat_print, ", size class hits: %u, misses: %u",
+           (uint)info.size_class_hits, (uint)info.size_class_misses);
+    #endif
+    mp_print_str(&mp_plat_print, "\n");
 }
 
 void gc_dump_alloc_table(void) {
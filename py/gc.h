@@ -44,8 +44,21 @@ void gc_collect(void);
 void gc_collect_start(void);
 void gc_collect_root(void **ptrs, size_t len);
 void gc_collect_end(void);
+#if MICROPY_GC_LAZY_SWEEP
+// Complete the sweep left outstanding by the last collection.
+void gc_sweep_all(void);
+#endif
+
+#if MICROPY_GC_TLAB
+// Set up and give back the allocation buffer of the calling thread.
+void gc_tlab_init_thread(void);
+void gc_tlab_deinit_thread(void);
+#endif
 
 void *gc_alloc(size_t n_bytes, bool has_finaliser);
+#if MICROPY_GC_LEAF_BLOCKS
+void *gc_alloc_leaf(size_t n_bytes); // contents are never scanned for pointers
+#endif
 void gc_free(void *ptr); // does not call finaliser
 size_t gc_nbytes(const void *ptr);
 void *gc_realloc(void *ptr, size_t n_bytes, bool allow_move);
@@ -58,9 +71,29 @@ typedef struct _gc_info_t {
     size_t num_1block;
     size_t num_2block;
     size_t max_block;
+    #if MICROPY_GC_SIZE_CLASSES
+    size_t size_class_hits;
+    size_t size_class_misses;
+    #endif
 } gc_info_t;
 
 void gc_info(gc_info_t *info);
+
+#if MICROPY_GC_COMPACT
+typedef struct _gc_compact_info_t {
+    size_t moved; // number of objects moved
+    size_t max_free_before; // largest free run in bytes, before and after moving
+    size_t max_free_after;
+} gc_compact_info_t;
+
+// Collect and then compact the heap.  Returns false if there wasn't enough
+// memory for the compaction tables, in which case nothing was done.
+bool gc_compact(gc_compact_info_t *info);
+
+// Stop the object at ptr from ever being moved by gc_compact, because its
+// address has been given out, eg by id().
+void gc_pin(const void *ptr);
+#endif
 void gc_dump_info(void);
 void gc_dump_alloc_table(void);
 
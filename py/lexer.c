@@ -115,8 +115,30 @@ STATIC bool is_head_of_identifier(mp_lexer_t *lex) {
     return is_letter(lex) || lex->chr0 == '_' || lex->chr0 >= 0x80;
 }
 
-STATIC bool is_tail_of_identifier(mp_lexer_t *lex) {
-    return is_head_of_identifier(lex) || is_digit(lex);
+// Refills the chunk buffer from the reader, returning false at end of stream.
+STATIC bool fill_buf(mp_lexer_t *lex) {
+    size_t n;
+    if (lex->reader.readinto != NULL) {
+        n = lex->reader.readinto(lex->reader.data, lex->buf, sizeof(lex->buf));
+    } else {
+        for (n = 0; n < sizeof(lex->buf); ++n) {
+            mp_uint_t c = lex->reader.readbyte(lex->reader.data);
+            if (c == MP_READER_EOF) {
+                break;
+            }
+            lex->buf[n] = c;
+        }
+    }
+    lex->buf_pos = 0;
+    lex->buf_len = n;
+    return n != 0;
+}
+
+static inline unichar read_char(mp_lexer_t *lex) {
+    if (lex->buf_pos >= lex->buf_len && !fill_buf(lex)) {
+        return MP_LEXER_EOF;
+    }
+    return lex->buf[lex->buf_pos++];
 }
 
 STATIC void next_char(mp_lexer_t *lex) {
@@ -134,14 +156,14 @@ STATIC void next_char(mp_lexer_t *lex) {
 
     lex->chr0 = lex->chr1;
     lex->chr1 = lex->chr2;
-    lex->chr2 = lex->reader.readbyte(lex->reader.data);
+    lex->chr2 = read_char(lex);
 
     if (lex->chr1 == '\r') {
         // CR is a new line, converted to LF
         lex->chr1 = '\n';
         if (lex->chr2 == '\n') {
             // CR LF is a single new line, throw out the extra LF
-            lex->chr2 = lex->reader.readbyte(lex->reader.data);
+            lex->chr2 = read_char(lex);
         }
     }
 
@@ -151,6 +173,76 @@ STATIC void next_char(mp_lexer_t *lex) {
     }
 }
 
+// Classes of characters that make up runs which can be scanned straight out of
+// the chunk buffer.  None include tab, CR or LF, which next_char() treats
+// specially, and bytes 0x80-0xff are in all but LEX_CC_DIGIT and LEX_CC_SPACE.
+#define LEX_CC_NAME (0x01) // tail of an identifier
+#define LEX_CC_DIGIT (0x02)
+#define LEX_CC_STR1 (0x04) // inside a '' string, excluding the quote and backslash
+#define LEX_CC_STR2 (0x08) // inside a "" string, excluding the quote and backslash
+#define LEX_CC_COMMENT (0x10)
+#define LEX_CC_SPACE (0x20)
+#define LEX_CC_HIGH (LEX_CC_NAME | LEX_CC_STR1 | LEX_CC_STR2 | LEX_CC_COMMENT)
+
+STATIC const uint8_t lex_cc_table[128] = {
+    0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x00, 0x00, 0x1c, 0x1c, 0x00, 0x1c, 0x1c,
+    0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c,
+    0x3c, 0x1c, 0x14, 0x1c, 0x1c, 0x1c, 0x1c, 0x18, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c,
+    0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c,
+    0x1c, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d,
+    0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1c, 0x10, 0x1c, 0x1c, 0x1d,
+    0x1c, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d,
+    0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1d, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c,
+};
+
+static inline uint8_t lex_cc(unichar c) {
+    if (c < 0x80) {
+        return lex_cc_table[c];
+    } else if (c <= 0xff) {
+        return LEX_CC_HIGH;
+    } else {
+        // MP_LEXER_EOF
+        return 0;
+    }
+}
+
+// Consumes the current character and those after it for as long as they are in
+// class cc, adding them to the token text if add is true.  Once the lookahead
+// characters are all in the class the rest of the run is scanned directly from
+// the chunk buffer, and then the lookahead is reloaded using next_char().
+STATIC void take_run(mp_lexer_t *lex, uint8_t cc, bool add) {
+    while (lex_cc(lex->chr0) & cc) {
+        if (!(lex_cc(lex->chr1) & lex_cc(lex->chr2) & cc)) {
+            if (add) {
+                vstr_add_byte(&lex->vstr, lex->chr0);
+            }
+            next_char(lex);
+            continue;
+        }
+        const byte *start = lex->buf + lex->buf_pos;
+        const byte *top = lex->buf + lex->buf_len;
+        const byte *p = start;
+        while (p < top && (lex_cc(*p) & cc)) {
+            ++p;
+        }
+        if (add) {
+            char *s = vstr_add_len(&lex->vstr, 3 + (p - start));
+            s[0] = lex->chr0;
+            s[1] = lex->chr1;
+            s[2] = lex->chr2;
+            memcpy(s + 3, start, p - start);
+        }
+        lex->buf_pos += p - start;
+        // each of the 3 calls to next_char() advances the column by 1 for
+        // the dummy lookahead, which stands in for the real one
+        lex->column += p - start;
+        lex->chr0 = lex->chr1 = lex->chr2 = ' ';
+        next_char(lex);
+        next_char(lex);
+        next_char(lex);
+    }
+}
+
 STATIC void indent_push(mp_lexer_t *lex, size_t indent) {
     if (lex->num_indent_level >= lex->alloc_indent_level) {
         lex->indent_level = m_renew(uint16_t, lex->indent_level, lex->alloc_indent_level, lex->alloc_indent_level + MICROPY_ALLOC_LEXEL_INDENT_INC);
@@ -289,8 +381,14 @@ STATIC void parse_string_literal(mp_lexer_t *lex, bool is_raw) {
     }
 
     size_t n_closing = 0;
+    const uint8_t run_cc = quote_char == '\'' ? LEX_CC_STR1 : LEX_CC_STR2;
     while (!is_end(lex) && (num_quotes > 1 || !is_char(lex, '\n')) && n_closing < num_quotes) {
-        if (is_char(lex, quote_char)) {
+        if (lex_cc(CUR_CHAR(lex)) & run_cc) {
+            // plain characters, added as bytes to remain 8-bit clean
+            n_closing = 0;
+            take_run(lex, run_cc, true);
+            continue;
+        } else if (is_char(lex, quote_char)) {
             n_closing += 1;
             vstr_add_char(&lex->vstr, CUR_CHAR(lex));
         } else {
@@ -408,12 +506,15 @@ STATIC bool skip_whitespace(mp_lexer_t *lex, bool stop_at_newline) {
             }
             had_physical_newline = true;
             next_char(lex);
+        } else if (is_char(lex, ' ')) {
+            take_run(lex, LEX_CC_SPACE, false);
         } else if (is_whitespace(lex)) {
             next_char(lex);
         } else if (is_char(lex, '#')) {
-            next_char(lex);
+            take_run(lex, LEX_CC_COMMENT, false);
             while (!is_end(lex) && !is_physical_newline(lex)) {
                 next_char(lex);
+                take_run(lex, LEX_CC_COMMENT, false);
             }
             // had_physical_newline will be set on next loop
         } else if (is_char_and(lex, '\\', '\n')) {
@@ -535,10 +636,7 @@ void mp_lexer_to_next(mp_lexer_t *lex) {
         next_char(lex);
 
         // get tail chars
-        while (!is_end(lex) && is_tail_of_identifier(lex)) {
-            vstr_add_byte(&lex->vstr, CUR_CHAR(lex));
-            next_char(lex);
-        }
+        take_run(lex, LEX_CC_NAME, true);
 
         // Check if the name is a keyword.
         // We also check for __debug__ here and convert it to its value.  This is
@@ -584,7 +682,9 @@ void mp_lexer_to_next(mp_lexer_t *lex) {
                     vstr_add_char(&lex->vstr, CUR_CHAR(lex));
                     next_char(lex);
                 }
-            } else if (is_letter(lex) || is_digit(lex) || is_char(lex, '.')) {
+            } else if (is_digit(lex)) {
+                take_run(lex, LEX_CC_DIGIT, true);
+            } else if (is_letter(lex) || is_char(lex, '.')) {
                 if (is_char_or3(lex, '.', 'j', 'J')) {
                     lex->tok_kind = MP_TOKEN_FLOAT_OR_IMAG;
                 }
@@ -684,6 +784,7 @@ mp_lexer_t *mp_lexer_new(qstr src_name, mp_reader_t reader) {
 
     // load lexer with start of file, advancing lex->column to 1
     // start with dummy bytes and use next_char() for proper EOL/EOF handling
+    lex->buf_pos = lex->buf_len = 0;
     lex->chr0 = lex->chr1 = lex->chr2 = 0;
     next_char(lex);
     next_char(lex);
@@ -151,6 +151,10 @@ typedef struct _mp_lexer_t {
 
     unichar chr0, chr1, chr2;   // current cached characters from source
 
+    uint16_t buf_pos;           // position of next unread byte in buf
+    uint16_t buf_len;           // number of bytes in buf
+    byte buf[MICROPY_ALLOC_LEXER_BUF]; // chunk of source read ahead of chr2
+
     size_t line;                // current source line
     size_t column;              // current source column
 
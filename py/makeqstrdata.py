@@ -158,6 +158,28 @@ def print_qstr_data(qcfgs, qstrs):
         qbytes = make_bytes(cfg_bytes_len, cfg_bytes_hash, qstr)
         print('QDEF(MP_QSTR_%s, %s)' % (ident, qbytes))
 
+    print_qstr_index(cfg_bytes_hash, qstrs)
+
+def print_qstr_index(cfg_bytes_hash, qstrs):
+    # build an open-addressing hash table of the qstrs, indexed by the low bits
+    # of their hash and using linear probing, with at most half the slots used;
+    # this must match the lookup in qstr_find_strn
+    size = 16
+    while size < 2 * (len(qstrs) + 1):
+        size *= 2
+    index = ['NULL'] * size
+    for order, ident, qstr in sorted(qstrs.values(), key=lambda x: x[0]):
+        i = compute_hash(bytes_cons(qstr, 'utf8'), cfg_bytes_hash) & (size - 1)
+        while index[i] != 'NULL':
+            i = (i + 1) & (size - 1)
+        index[i] = ident
+
+    print('')
+    print('#ifdef QINDEX')
+    for i in range(0, size, 8):
+        print(' '.join('QINDEX(MP_QSTR_%s)' % ident for ident in index[i:i + 8]))
+    print('#endif')
+
 def do_work(infiles):
     qcfgs, qstrs = parse_input_headers(infiles)
     print_qstr_data(qcfgs, qstrs)
@@ -112,6 +112,27 @@ void *m_malloc_with_finaliser(size_t num_bytes) {
 }
 #endif
 
+#if MICROPY_ENABLE_GC && MICROPY_GC_LEAF_BLOCKS
+void *m_malloc_leaf_maybe(size_t num_bytes) {
+    void *ptr = gc_alloc_leaf(num_bytes);
+#if MICROPY_MEM_STATS
+    MP_STATE_MEM(total_bytes_allocated) += num_bytes;
+    MP_STATE_MEM(current_bytes_allocated) += num_bytes;
+    UPDATE_PEAK();
+#endif
+    DEBUG_printf("malloc %d : %p\n", num_bytes, ptr);
+    return ptr;
+}
+
+void *m_malloc_leaf(size_t num_bytes) {
+    void *ptr = m_malloc_leaf_maybe(num_bytes);
+    if (ptr == NULL && num_bytes != 0) {
+        m_malloc_fail(num_bytes);
+    }
+    return ptr;
+}
+#endif
+
 void *m_malloc0(size_t num_bytes) {
     void *ptr = m_malloc(num_bytes);
     if (ptr == NULL && num_bytes != 0) {
@@ -69,18 +69,91 @@ STATIC size_t get_hash_alloc_greater_or_equal_to(size_t x) {
 /******************************************************************************/
 /* map                                                                        */
 
-void mp_map_init(mp_map_t *map, size_t n) {
-    if (n == 0) {
-        map->alloc = 0;
-        map->table = NULL;
+// A map that isn't ordered keeps its elements in the table in the order they
+// were added, so that iterating over the table gives them in that order.  A
+// removed element has its key set to MP_OBJ_SENTINEL and stays in place until
+// the table is rebuilt, and the unused elements at the end have a null key.
+// Tables of up to MAP_INDEX_MIN_ALLOC elements are searched linearly.  Larger
+// ones are followed, in the same allocation, by a hash index: the number of
+// elements filled so far (including removed ones), then an open-addressing
+// table with linear probing whose slots hold 1 + the position of an element,
+// 0 being an empty slot.  The index has more than 3/2 slots per element so
+// it's never more than 2/3 full, and its slots are the smallest unsigned
+// type that fits.
+#define MAP_INDEX_MIN_ALLOC (8)
+
+STATIC size_t map_index_len(size_t alloc) {
+    if (alloc <= MAP_INDEX_MIN_ALLOC) {
+        return 0;
+    }
+    return alloc + alloc / 2 + 1;
+}
+
+STATIC size_t map_index_slot_size(size_t index_len) {
+    return index_len <= 0x100 ? 1 : index_len <= 0x10000 ? 2 : 4;
+}
+
+STATIC size_t map_table_nbytes(size_t alloc) {
+    size_t n = alloc * sizeof(mp_map_elem_t);
+    size_t index_len = map_index_len(alloc);
+    if (index_len != 0) {
+        n += sizeof(size_t) + index_len * map_index_slot_size(index_len);
+    }
+    return n;
+}
+
+STATIC void map_table_free(mp_map_t *map) {
+    if (map->is_fixed) {
+        return;
+    }
+    if (map->is_ordered) {
+        m_del(mp_map_elem_t, map->table, map->alloc);
     } else {
-        map->alloc = n;
-        map->table = m_new0(mp_map_elem_t, map->alloc);
+        m_del(byte, map->table, map_table_nbytes(map->alloc));
+    }
+}
+
+#define MAP_INDEX_FILLED(map) (*(size_t*)&(map)->table[(map)->alloc])
+
+STATIC size_t map_index_get(const mp_map_t *map, size_t index_len, size_t pos) {
+    void *slots = &MAP_INDEX_FILLED(map) + 1;
+    switch (map_index_slot_size(index_len)) {
+        case 1: return ((uint8_t*)slots)[pos];
+        case 2: return ((uint16_t*)slots)[pos];
+        default: return ((uint32_t*)slots)[pos];
+    }
+}
+
+STATIC void map_index_set(mp_map_t *map, size_t index_len, size_t pos, size_t value) {
+    void *slots = &MAP_INDEX_FILLED(map) + 1;
+    switch (map_index_slot_size(index_len)) {
+        case 1: ((uint8_t*)slots)[pos] = value; break;
+        case 2: ((uint16_t*)slots)[pos] = value; break;
+        default: ((uint32_t*)slots)[pos] = value; break;
     }
+}
+
+STATIC mp_uint_t map_hash(mp_obj_t index) {
+    // fast path for common case of qstr
+    if (MP_OBJ_IS_QSTR(index)) {
+        return qstr_hash(MP_OBJ_QSTR_VALUE(index));
+    } else {
+        return MP_OBJ_SMALL_INT_VALUE(mp_unary_op(MP_UNARY_OP_HASH, index));
+    }
+}
+
+void mp_map_init(mp_map_t *map, size_t n) {
+    map->alloc = n;
     map->used = 0;
     map->all_keys_are_qstrs = 1;
     map->is_fixed = 0;
     map->is_ordered = 0;
+    if (n == 0) {
+        map->table = NULL;
+    } else {
+        // a zeroed index is valid for an empty table
+        map->table = m_malloc0(map_table_nbytes(n));
+    }
 }
 
 void mp_map_init_fixed_table(mp_map_t *map, size_t n, const mp_obj_t *table) {
@@ -94,16 +167,12 @@ void mp_map_init_fixed_table(mp_map_t *map, size_t n, const mp_obj_t *table) {
 
 // Differentiate from mp_map_clear() - semantics is different
 void mp_map_deinit(mp_map_t *map) {
-    if (!map->is_fixed) {
-        m_del(mp_map_elem_t, map->table, map->alloc);
-    }
+    map_table_free(map);
     map->used = map->alloc = 0;
 }
 
 void mp_map_clear(mp_map_t *map) {
-    if (!map->is_fixed) {
-        m_del(mp_map_elem_t, map->table, map->alloc);
-    }
+    map_table_free(map);
     map->alloc = 0;
     map->used = 0;
     map->all_keys_are_qstrs = 1;
@@ -111,24 +180,60 @@ void mp_map_clear(mp_map_t *map) {
     map->table = NULL;
 }
 
+// Make room to add an element to a map that isn't ordered, by moving the
+// elements that are in use to the front of the table, in order, and
+// rebuilding the index.  The table is grown unless at least a quarter of its
+// elements were removed, in which case it's compacted in place.
 STATIC void mp_map_rehash(mp_map_t *map) {
     size_t old_alloc = map->alloc;
-    size_t new_alloc = get_hash_alloc_greater_or_equal_to(map->alloc + 1);
+    size_t new_alloc = old_alloc;
     mp_map_elem_t *old_table = map->table;
-    mp_map_elem_t *new_table = m_new0(mp_map_elem_t, new_alloc);
+    mp_map_elem_t *new_table = old_table;
+    if (map->used >= old_alloc - old_alloc / 4) {
+        new_alloc = get_hash_alloc_greater_or_equal_to(old_alloc + 1);
+        new_table = m_malloc0(map_table_nbytes(new_alloc));
+    }
     // If we reach this point, table resizing succeeded, now we can edit the old map.
-    map->alloc = new_alloc;
-    map->used = 0;
+    size_t n = 0;
     map->all_keys_are_qstrs = 1;
-    map->table = new_table;
     for (size_t i = 0; i < old_alloc; i++) {
         if (old_table[i].key != MP_OBJ_NULL && old_table[i].key != MP_OBJ_SENTINEL) {
-            mp_map_lookup(map, old_table[i].key, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND)->value = old_table[i].value;
+            if (!MP_OBJ_IS_QSTR(old_table[i].key)) {
+                map->all_keys_are_qstrs = 0;
+            }
+            new_table[n++] = old_table[i];
+        }
+    }
+    if (new_table == old_table) {
+        memset(&new_table[n], 0, (old_alloc - n) * sizeof(mp_map_elem_t));
+    } else {
+        m_del(byte, old_table, map_table_nbytes(old_alloc));
+    }
+    map->alloc = new_alloc;
+    map->table = new_table;
+
+    size_t index_len = map_index_len(map->alloc);
+    if (index_len != 0) {
+        MAP_INDEX_FILLED(map) = n;
+        memset(&MAP_INDEX_FILLED(map) + 1, 0, index_len * map_index_slot_size(index_len));
+        for (size_t i = 0; i < n; i++) {
+            size_t pos = map_hash(new_table[i].key) % index_len;
+            while (map_index_get(map, index_len, pos) != 0) {
+                pos = (pos + 1) % index_len;
+            }
+            map_index_set(map, index_len, pos, i + 1);
         }
     }
-    m_del(mp_map_elem_t, old_table, old_alloc);
 }
 
+#if MICROPY_OPT_MAP_LOOKUP_CACHE
+// The lookup cache remembers where a qstr key was last found in an ordered
+// map, so that repeated lookups in the const dicts of modules and types can
+// skip the linear search.  It's shared by all maps and indexed by the map and
+// the key; an entry is only a hint and is checked against the map on use.
+#define MAP_CACHE_ENTRY(map, index) (MP_STATE_VM(map_lookup_cache)[(((uintptr_t)(map) >> 4) ^ ((uintptr_t)(index) >> 2)) & (MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE - 1)])
+#endif
+
 // MP_MAP_LOOKUP behaviour:
 //  - returns NULL if not found, else the slot it was found in with key,value non-null
 // MP_MAP_LOOKUP_ADD_IF_NOT_FOUND behaviour:
@@ -160,8 +265,21 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
 
     // if the map is an ordered array then we must do a brute force linear search
     if (map->is_ordered) {
+        #if MICROPY_OPT_MAP_LOOKUP_CACHE
+        if (compare_only_ptrs && lookup_kind != MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
+            size_t pos = MAP_CACHE_ENTRY(map, index);
+            if (pos < map->used && map->table[pos].key == index) {
+                return &map->table[pos];
+            }
+        }
+        #endif
         for (mp_map_elem_t *elem = &map->table[0], *top = &map->table[map->used]; elem < top; elem++) {
             if (elem->key == index || (!compare_only_ptrs && mp_obj_equal(elem->key, index))) {
+                #if MICROPY_OPT_MAP_LOOKUP_CACHE
+                if (compare_only_ptrs) {
+                    MAP_CACHE_ENTRY(map, index) = elem - map->table;
+                }
+                #endif
                 if (MP_UNLIKELY(lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND)) {
                     // remove the found element by moving the rest of the array down
                     mp_obj_t value = elem->value;
@@ -192,7 +310,8 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
         return elem;
     }
 
-    // map is a hash table (not an ordered array), so do a hash lookup
+    // map is not an ordered array, so do a linear search of a small table or
+    // a lookup in the hash index of a larger one
 
     if (map->alloc == 0) {
         if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
@@ -202,83 +321,73 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
         }
     }
 
-    // get hash of index, with fast path for common case of qstr
-    mp_uint_t hash;
-    if (MP_OBJ_IS_QSTR(index)) {
-        hash = qstr_hash(MP_OBJ_QSTR_VALUE(index));
-    } else {
-        hash = MP_OBJ_SMALL_INT_VALUE(mp_unary_op(MP_UNARY_OP_HASH, index));
-    }
-
-    size_t pos = hash % map->alloc;
-    size_t start_pos = pos;
-    mp_map_elem_t *avail_slot = NULL;
-    for (;;) {
-        mp_map_elem_t *slot = &map->table[pos];
-        if (slot->key == MP_OBJ_NULL) {
-            // found NULL slot, so index is not in table
-            if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
-                map->used += 1;
-                if (avail_slot == NULL) {
-                    avail_slot = slot;
-                }
-                avail_slot->key = index;
-                avail_slot->value = MP_OBJ_NULL;
-                if (!MP_OBJ_IS_QSTR(index)) {
-                    map->all_keys_are_qstrs = 0;
-                }
-                return avail_slot;
-            } else {
-                return NULL;
-            }
-        } else if (slot->key == MP_OBJ_SENTINEL) {
-            // found deleted slot, remember for later
-            if (avail_slot == NULL) {
-                avail_slot = slot;
+    mp_map_elem_t *elem;
+    mp_map_elem_t *top = &map->table[map->alloc];
+    size_t index_len = map_index_len(map->alloc);
+    if (index_len == 0) {
+        if (!MP_OBJ_IS_QSTR(index) && !MP_OBJ_IS_SMALL_INT(index)) {
+            // the hash isn't needed, but raises an error for an unhashable index
+            map_hash(index);
+        }
+        for (elem = &map->table[0]; elem < top && elem->key != MP_OBJ_NULL; elem++) {
+            if (elem->key == index || (!compare_only_ptrs && elem->key != MP_OBJ_SENTINEL && mp_obj_equal(elem->key, index))) {
+                goto found;
             }
-        } else if (slot->key == index || (!compare_only_ptrs && mp_obj_equal(slot->key, index))) {
-            // found index
-            // Note: CPython does not replace the index; try x={True:'true'};x[1]='one';x
-            if (lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
-                // delete element in this slot
-                map->used--;
-                if (map->table[(pos + 1) % map->alloc].key == MP_OBJ_NULL) {
-                    // optimisation if next slot is empty
-                    slot->key = MP_OBJ_NULL;
-                } else {
-                    slot->key = MP_OBJ_SENTINEL;
-                }
-                // keep slot->value so that caller can access it if needed
+        }
+        if (lookup_kind != MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
+            return NULL;
+        }
+        if (elem == top) {
+            // not enough room in table, rehash it and search again
+            mp_map_rehash(map);
+            return mp_map_lookup(map, index, lookup_kind);
+        }
+    } else {
+        size_t pos = map_hash(index) % index_len;
+        for (size_t e; (e = map_index_get(map, index_len, pos)) != 0; pos = (pos + 1) % index_len) {
+            elem = &map->table[e - 1];
+            if (elem->key == index || (!compare_only_ptrs && elem->key != MP_OBJ_SENTINEL && mp_obj_equal(elem->key, index))) {
+                goto found;
             }
-            return slot;
         }
+        if (lookup_kind != MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
+            return NULL;
+        }
+        size_t filled = MAP_INDEX_FILLED(map);
+        if (filled == map->alloc) {
+            // not enough room in table, rehash it and search again
+            mp_map_rehash(map);
+            return mp_map_lookup(map, index, lookup_kind);
+        }
+        map_index_set(map, index_len, pos, filled + 1);
+        MAP_INDEX_FILLED(map) = filled + 1;
+        elem = &map->table[filled];
+    }
 
-        // not yet found, keep searching in this table
-        pos = (pos + 1) % map->alloc;
-
-        if (pos == start_pos) {
-            // search got back to starting position, so index is not in table
-            if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
-                if (avail_slot != NULL) {
-                    // there was an available slot, so use that
-                    map->used++;
-                    avail_slot->key = index;
-                    avail_slot->value = MP_OBJ_NULL;
-                    if (!MP_OBJ_IS_QSTR(index)) {
-                        map->all_keys_are_qstrs = 0;
-                    }
-                    return avail_slot;
-                } else {
-                    // not enough room in table, rehash it
-                    mp_map_rehash(map);
-                    // restart the search for the new element
-                    start_pos = pos = hash % map->alloc;
-                }
-            } else {
-                return NULL;
+    // index is not in table, so add it at the end
+    map->used += 1;
+    elem->key = index;
+    elem->value = MP_OBJ_NULL;
+    if (!MP_OBJ_IS_QSTR(index)) {
+        map->all_keys_are_qstrs = 0;
+    }
+    return elem;
+
+found:
+    // Note: CPython does not replace the index; try x={True:'true'};x[1]='one';x
+    if (lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
+        // delete element, keeping elem->value so that caller can access it if needed
+        map->used--;
+        elem->key = MP_OBJ_SENTINEL;
+        if (index_len == 0 && (elem + 1 == top || elem[1].key == MP_OBJ_NULL)) {
+            // optimisation for a small table: unused elements at the end can
+            // be reused straight away
+            for (mp_map_elem_t *e = elem; e >= map->table && e->key == MP_OBJ_SENTINEL; e--) {
+                e->key = MP_OBJ_NULL;
             }
         }
     }
+    return elem;
 }
 
 /******************************************************************************/
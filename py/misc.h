@@ -68,6 +68,14 @@ typedef unsigned int uint;
 #else
 #define m_new_obj_with_finaliser(type) m_new_obj(type)
 #endif
+// for memory that never holds pointers to the heap, eg string data
+#if MICROPY_ENABLE_GC && MICROPY_GC_LEAF_BLOCKS
+#define m_new_leaf(type, num) ((type*)(m_malloc_leaf(sizeof(type) * (num))))
+#define m_new_leaf_maybe(type, num) ((type*)(m_malloc_leaf_maybe(sizeof(type) * (num))))
+#else
+#define m_new_leaf(type, num) m_new(type, num)
+#define m_new_leaf_maybe(type, num) m_new_maybe(type, num)
+#endif
 #if MICROPY_MALLOC_USES_ALLOCATED_SIZE
 #define m_renew(type, ptr, old_num, new_num) ((type*)(m_realloc((ptr), sizeof(type) * (old_num), sizeof(type) * (new_num))))
 #define m_renew_maybe(type, ptr, old_num, new_num, allow_move) ((type*)(m_realloc_maybe((ptr), sizeof(type) * (old_num), sizeof(type) * (new_num), (allow_move))))
@@ -85,6 +93,8 @@ void *m_malloc(size_t num_bytes);
 void *m_malloc_maybe(size_t num_bytes);
 void *m_malloc_with_finaliser(size_t num_bytes);
 void *m_malloc0(size_t num_bytes);
+void *m_malloc_leaf(size_t num_bytes);
+void *m_malloc_leaf_maybe(size_t num_bytes);
 #if MICROPY_MALLOC_USES_ALLOCATED_SIZE
 void *m_realloc(void *ptr, size_t old_num_bytes, size_t new_num_bytes);
 void *m_realloc_maybe(void *ptr, size_t old_num_bytes, size_t new_num_bytes, bool allow_move);
@@ -27,12 +27,17 @@
 #include "py/mpstate.h"
 #include "py/obj.h"
 #include "py/gc.h"
+#include "py/runtime.h"
 
 #if MICROPY_PY_GC && MICROPY_ENABLE_GC
 
 // collect(): run a garbage collection
 STATIC mp_obj_t py_gc_collect(void) {
     gc_collect();
+    #if MICROPY_GC_LAZY_SWEEP
+    // an explicit collection frees everything it can straight away
+    gc_sweep_all();
+    #endif
 #if MICROPY_PY_GC_COLLECT_RETVAL
     return MP_OBJ_NEW_SMALL_INT(MP_STATE_MEM(gc_collected));
 #else
@@ -95,6 +100,72 @@ STATIC mp_obj_t gc_threshold(size_t n_args, const mp_obj_t *args) {
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(gc_threshold_obj, 0, 1, gc_threshold);
 #endif
 
+#if MICROPY_GC_LAZY_SWEEP
+STATIC mp_obj_t py_gc_sweep_slice(size_t n_args, const mp_obj_t *args) {
+    if (n_args == 0) {
+        if (MP_STATE_MEM(gc_sweep_slice_blocks) == (size_t)-1) {
+            return MP_OBJ_NEW_SMALL_INT(-1);
+        }
+        return mp_obj_new_int(MP_STATE_MEM(gc_sweep_slice_blocks) * MICROPY_BYTES_PER_GC_BLOCK);
+    }
+    mp_int_t val = mp_obj_get_int(args[0]);
+    if (val <= 0) {
+        // sweep the whole heap as part of each collection
+        MP_STATE_MEM(gc_sweep_slice_blocks) = (size_t)-1;
+    } else {
+        MP_STATE_MEM(gc_sweep_slice_blocks) = (val + MICROPY_BYTES_PER_GC_BLOCK - 1) / MICROPY_BYTES_PER_GC_BLOCK;
+    }
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(gc_sweep_slice_obj, 0, 1, py_gc_sweep_slice);
+#endif
+
+#if MICROPY_GC_PAUSE_STATS
+// pause_stats(): return (last, max) GC pause time in microseconds
+STATIC mp_obj_t gc_pause_stats(void) {
+    mp_obj_t tuple[2] = {
+        mp_obj_new_int_from_uint(MP_STATE_MEM(gc_pause_last_us)),
+        mp_obj_new_int_from_uint(MP_STATE_MEM(gc_pause_max_us)),
+    };
+    return mp_obj_new_tuple(2, tuple);
+}
+MP_DEFINE_CONST_FUN_OBJ_0(gc_pause_stats_obj, gc_pause_stats);
+#endif
+
+#if MICROPY_GC_PARALLEL_MARK
+// mark_threads([n]): get or set the number of threads used to mark the heap
+STATIC mp_obj_t gc_mark_threads(size_t n_args, const mp_obj_t *args) {
+    if (n_args == 0) {
+        return MP_OBJ_NEW_SMALL_INT(MP_STATE_MEM(gc_mark_threads));
+    }
+    mp_int_t val = mp_obj_get_int(args[0]);
+    if (val < 1 || val > MICROPY_GC_PARALLEL_MARK) {
+        mp_raise_ValueError(NULL);
+    }
+    MP_STATE_MEM(gc_mark_threads) = val;
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(gc_mark_threads_obj, 0, 1, gc_mark_threads);
+#endif
+
+#if MICROPY_GC_COMPACT
+// compact(): collect and compact the heap, returning the number of objects
+// moved and the largest free block in bytes before and after compaction
+STATIC mp_obj_t py_gc_compact(void) {
+    gc_compact_info_t info;
+    if (!gc_compact(&info)) {
+        mp_raise_msg(&mp_type_MemoryError, NULL);
+    }
+    mp_obj_t tuple[3] = {
+        mp_obj_new_int_from_uint(info.moved),
+        mp_obj_new_int_from_uint(info.max_free_before),
+        mp_obj_new_int_from_uint(info.max_free_after),
+    };
+    return mp_obj_new_tuple(3, tuple);
+}
+MP_DEFINE_CONST_FUN_OBJ_0(gc_compact_obj, py_gc_compact);
+#endif
+
 STATIC const mp_rom_map_elem_t mp_module_gc_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_gc) },
     { MP_ROM_QSTR(MP_QSTR_collect), MP_ROM_PTR(&gc_collect_obj) },
@@ -106,6 +177,18 @@ STATIC const mp_rom_map_elem_t mp_module_gc_globals_table[] = {
     #if MICROPY_GC_ALLOC_THRESHOLD
     { MP_ROM_QSTR(MP_QSTR_threshold), MP_ROM_PTR(&gc_threshold_obj) },
     #endif
+    #if MICROPY_GC_LAZY_SWEEP
+    { MP_ROM_QSTR(MP_QSTR_sweep_slice), MP_ROM_PTR(&gc_sweep_slice_obj) },
+    #endif
+    #if MICROPY_GC_PAUSE_STATS
+    { MP_ROM_QSTR(MP_QSTR_pause_stats), MP_ROM_PTR(&gc_pause_stats_obj) },
+    #endif
+    #if MICROPY_GC_PARALLEL_MARK
+    { MP_ROM_QSTR(MP_QSTR_mark_threads), MP_ROM_PTR(&gc_mark_threads_obj) },
+    #endif
+    #if MICROPY_GC_COMPACT
+    { MP_ROM_QSTR(MP_QSTR_compact), MP_ROM_PTR(&gc_compact_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_gc_globals, mp_module_gc_globals_table);
@@ -38,6 +38,22 @@
 extern const mp_obj_type_t mp_type_fileio;
 extern const mp_obj_type_t mp_type_textio;
 
+#if MICROPY_PY_IO_BUFFEREDWRITER || MICROPY_PY_IO_BUFFEREDREADER
+// Buffer size used when the constructor is not given one
+#define BUFFERED_DEFAULT_SIZE (256)
+
+STATIC size_t buffered_get_size(size_t n_args, const mp_obj_t *args) {
+    if (n_args < 2) {
+        return BUFFERED_DEFAULT_SIZE;
+    }
+    mp_int_t alloc = mp_obj_get_int(args[1]);
+    if (alloc <= 0) {
+        mp_raise_ValueError("buffer size must be positive");
+    }
+    return alloc;
+}
+#endif
+
 #if MICROPY_PY_IO_BUFFEREDWRITER
 typedef struct _mp_obj_bufwriter_t {
     mp_obj_base_t base;
@@ -48,8 +64,8 @@ typedef struct _mp_obj_bufwriter_t {
 } mp_obj_bufwriter_t;
 
 STATIC mp_obj_t bufwriter_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
-    mp_arg_check_num(n_args, n_kw, 2, 2, false);
-    size_t alloc = mp_obj_get_int(args[1]);
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    size_t alloc = buffered_get_size(n_args, args);
     mp_obj_bufwriter_t *o = m_new_obj_var(mp_obj_bufwriter_t, byte, alloc);
     o->base.type = type;
     o->stream = args[0];
@@ -81,6 +97,7 @@ STATIC mp_uint_t bufwriter_write(mp_obj_t self_in, const void *buf, mp_uint_t si
         buf = (byte*)buf + rem;
         size -= rem;
         mp_uint_t out_sz = mp_stream_write_exactly(self->stream, self->buf, self->alloc, errcode);
+        (void)out_sz;
         if (*errcode != 0) {
             return MP_STREAM_ERROR;
         }
@@ -93,33 +110,79 @@ STATIC mp_uint_t bufwriter_write(mp_obj_t self_in, const void *buf, mp_uint_t si
     return org_size;
 }
 
-STATIC mp_obj_t bufwriter_flush(mp_obj_t self_in) {
-    mp_obj_bufwriter_t *self = MP_OBJ_TO_PTR(self_in);
-
+STATIC int bufwriter_flush_buf(mp_obj_bufwriter_t *self) {
+    int err = 0;
     if (self->len != 0) {
-        int err;
         mp_uint_t out_sz = mp_stream_write_exactly(self->stream, self->buf, self->len, &err);
+        (void)out_sz;
         // TODO: try to recover from a case of non-blocking stream, e.g. move
         // remaining chunk to the beginning of buffer.
         assert(out_sz == self->len);
         self->len = 0;
-        if (err != 0) {
-            mp_raise_OSError(err);
-        }
     }
+    return err;
+}
 
+STATIC mp_obj_t bufwriter_flush(mp_obj_t self_in) {
+    mp_obj_bufwriter_t *self = MP_OBJ_TO_PTR(self_in);
+    int err = bufwriter_flush_buf(self);
+    if (err != 0) {
+        mp_raise_OSError(err);
+    }
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(bufwriter_flush_obj, bufwriter_flush);
 
+STATIC mp_obj_t bufwriter_close(mp_obj_t self_in) {
+    mp_obj_bufwriter_t *self = MP_OBJ_TO_PTR(self_in);
+    int err = bufwriter_flush_buf(self);
+    if (err != 0) {
+        mp_raise_OSError(err);
+    }
+    return mp_stream_close(self->stream);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bufwriter_close_obj, bufwriter_close);
+
+STATIC mp_obj_t bufwriter___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return bufwriter_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bufwriter___exit___obj, 4, 4, bufwriter___exit__);
+
+STATIC mp_uint_t bufwriter_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    mp_obj_bufwriter_t *self = MP_OBJ_TO_PTR(self_in);
+    const mp_stream_p_t *stream_p = mp_get_stream_raise(self->stream, MP_STREAM_OP_WRITE);
+    // Anything buffered must reach the stream before it is flushed or seeked
+    if (request == MP_STREAM_FLUSH || request == MP_STREAM_SEEK) {
+        *errcode = bufwriter_flush_buf(self);
+        if (*errcode != 0) {
+            return MP_STREAM_ERROR;
+        }
+    }
+    if (stream_p->ioctl == NULL) {
+        if (request == MP_STREAM_FLUSH) {
+            return 0;
+        }
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    return stream_p->ioctl(self->stream, request, arg, errcode);
+}
+
 STATIC const mp_rom_map_elem_t bufwriter_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
     { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&bufwriter_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_seek), MP_ROM_PTR(&mp_stream_seek_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tell), MP_ROM_PTR(&mp_stream_tell_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&bufwriter_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&bufwriter___exit___obj) },
 };
 STATIC MP_DEFINE_CONST_DICT(bufwriter_locals_dict, bufwriter_locals_dict_table);
 
 STATIC const mp_stream_p_t bufwriter_stream_p = {
     .write = bufwriter_write,
+    .ioctl = bufwriter_ioctl,
 };
 
 STATIC const mp_obj_type_t bufwriter_type = {
@@ -131,6 +194,235 @@ STATIC const mp_obj_type_t bufwriter_type = {
 };
 #endif // MICROPY_PY_IO_BUFFEREDWRITER
 
+#if MICROPY_PY_IO_BUFFEREDREADER
+// Bytes in buf[pos:len] have been read from the stream but not yet consumed.
+typedef struct _mp_obj_bufreader_t {
+    mp_obj_base_t base;
+    mp_obj_t stream;
+    size_t alloc;
+    size_t pos;
+    size_t len;
+    byte buf[0];
+} mp_obj_bufreader_t;
+
+STATIC mp_obj_t bufreader_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_READ);
+    size_t alloc = buffered_get_size(n_args, args);
+    mp_obj_bufreader_t *o = m_new_obj_var(mp_obj_bufreader_t, byte, alloc);
+    o->base.type = type;
+    o->stream = args[0];
+    o->alloc = alloc;
+    o->pos = 0;
+    o->len = 0;
+    return o;
+}
+
+// Read once from the stream into the free space after buf[len].  Returns the
+// number of bytes added, 0 at EOF or MP_STREAM_ERROR.
+STATIC mp_uint_t bufreader_fill(mp_obj_bufreader_t *self, int *errcode) {
+    const mp_stream_p_t *stream_p = mp_get_stream_raise(self->stream, MP_STREAM_OP_READ);
+    if (self->pos == self->len) {
+        self->pos = self->len = 0;
+    }
+    mp_uint_t out_sz = stream_p->read(self->stream, self->buf + self->len, self->alloc - self->len, errcode);
+    if (out_sz != MP_STREAM_ERROR) {
+        self->len += out_sz;
+    }
+    return out_sz;
+}
+
+STATIC mp_uint_t bufreader_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_bufreader_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->pos == self->len) {
+        if (size >= self->alloc) {
+            // Nothing buffered and the request would fill the buffer anyway,
+            // so read straight into the caller's memory.
+            const mp_stream_p_t *stream_p = mp_get_stream_raise(self->stream, MP_STREAM_OP_READ);
+            return stream_p->read(self->stream, buf, size, errcode);
+        }
+        mp_uint_t out_sz = bufreader_fill(self, errcode);
+        if (out_sz == 0 || out_sz == MP_STREAM_ERROR) {
+            return out_sz;
+        }
+    }
+    size_t n = MIN(size, self->len - self->pos);
+    memcpy(buf, self->buf + self->pos, n);
+    self->pos += n;
+    return n;
+}
+
+STATIC mp_obj_t bufreader_readline(size_t n_args, const mp_obj_t *args) {
+    mp_obj_bufreader_t *self = MP_OBJ_TO_PTR(args[0]);
+    size_t max_size = (size_t)-1;
+    if (n_args > 1) {
+        mp_int_t sz = mp_obj_get_int(args[1]);
+        if (sz >= 0) {
+            max_size = sz;
+        }
+    }
+
+    // Fast path: the whole line is already in the buffer
+    size_t avail = MIN(self->len - self->pos, max_size);
+    const byte *p = self->buf + self->pos;
+    const byte *nl = memchr(p, '\n', avail);
+    if (nl != NULL || avail == max_size) {
+        size_t n = nl != NULL ? (size_t)(nl - p + 1) : avail;
+        self->pos += n;
+        return mp_obj_new_bytes(p, n);
+    }
+
+    vstr_t vstr;
+    vstr_init(&vstr, avail + 16);
+    while (vstr.len < max_size) {
+        if (self->pos == self->len) {
+            int error;
+            mp_uint_t out_sz = bufreader_fill(self, &error);
+            if (out_sz == MP_STREAM_ERROR) {
+                if (mp_is_nonblocking_error(error)) {
+                    // Same as the unbuffered readline: return None if nothing
+                    // at all could be read, otherwise what we have so far.
+                    if (vstr.len == 0) {
+                        vstr_clear(&vstr);
+                        return mp_const_none;
+                    }
+                    break;
+                }
+                mp_raise_OSError(error);
+            }
+            if (out_sz == 0) {
+                break;
+            }
+        }
+        size_t n = MIN(self->len - self->pos, max_size - vstr.len);
+        p = self->buf + self->pos;
+        nl = memchr(p, '\n', n);
+        if (nl != NULL) {
+            n = nl - p + 1;
+        }
+        vstr_add_strn(&vstr, (const char*)p, n);
+        self->pos += n;
+        if (nl != NULL) {
+            break;
+        }
+    }
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bufreader_readline_obj, 1, 2, bufreader_readline);
+
+STATIC mp_obj_t bufreader_iternext(mp_obj_t self_in) {
+    mp_obj_t line = bufreader_readline(1, &self_in);
+    if (mp_obj_is_true(line)) {
+        return line;
+    }
+    return MP_OBJ_STOP_ITERATION;
+}
+
+STATIC mp_obj_t bufreader_readlines(mp_obj_t self_in) {
+    mp_obj_t lines = mp_obj_new_list(0, NULL);
+    for (;;) {
+        mp_obj_t line = bufreader_iternext(self_in);
+        if (line == MP_OBJ_STOP_ITERATION) {
+            break;
+        }
+        mp_obj_list_append(lines, line);
+    }
+    return lines;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bufreader_readlines_obj, bufreader_readlines);
+
+// Return buffered bytes without consuming them.  As in CPython the result may
+// be shorter or longer than requested; it is only empty at EOF.
+STATIC mp_obj_t bufreader_peek(size_t n_args, const mp_obj_t *args) {
+    mp_obj_bufreader_t *self = MP_OBJ_TO_PTR(args[0]);
+    size_t want = 1;
+    if (n_args > 1) {
+        mp_int_t sz = mp_obj_get_int(args[1]);
+        if (sz > 0) {
+            want = MIN((size_t)sz, self->alloc);
+        }
+    }
+    if (self->len - self->pos < want) {
+        // Move what is left to the start so one read can top the buffer up
+        memmove(self->buf, self->buf + self->pos, self->len - self->pos);
+        self->len -= self->pos;
+        self->pos = 0;
+        int error;
+        if (bufreader_fill(self, &error) == MP_STREAM_ERROR && !mp_is_nonblocking_error(error)) {
+            mp_raise_OSError(error);
+        }
+    }
+    return mp_obj_new_bytes(self->buf + self->pos, self->len - self->pos);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bufreader_peek_obj, 1, 2, bufreader_peek);
+
+STATIC mp_obj_t bufreader_close(mp_obj_t self_in) {
+    mp_obj_bufreader_t *self = MP_OBJ_TO_PTR(self_in);
+    self->pos = self->len = 0;
+    return mp_stream_close(self->stream);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bufreader_close_obj, bufreader_close);
+
+STATIC mp_obj_t bufreader___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return bufreader_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bufreader___exit___obj, 4, 4, bufreader___exit__);
+
+STATIC mp_uint_t bufreader_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    mp_obj_bufreader_t *self = MP_OBJ_TO_PTR(self_in);
+    const mp_stream_p_t *stream_p = mp_get_stream_raise(self->stream, MP_STREAM_OP_READ);
+    if (stream_p->ioctl == NULL) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    size_t buffered = self->len - self->pos;
+    if (request == MP_STREAM_SEEK) {
+        // The stream is ahead of the caller by the buffered bytes
+        struct mp_stream_seek_t *s = (struct mp_stream_seek_t*)arg;
+        if (s->whence == MP_SEEK_CUR) {
+            s->offset -= buffered;
+        }
+        self->pos = self->len = 0;
+    }
+    mp_uint_t ret = stream_p->ioctl(self->stream, request, arg, errcode);
+    if (request == MP_STREAM_POLL && ret != MP_STREAM_ERROR && buffered != 0) {
+        ret |= arg & MP_STREAM_POLL_RD;
+    }
+    return ret;
+}
+
+STATIC const mp_rom_map_elem_t bufreader_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&mp_stream_read_obj) },
+    { MP_ROM_QSTR(MP_QSTR_read1), MP_ROM_PTR(&mp_stream_read1_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&mp_stream_readinto_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readline), MP_ROM_PTR(&bufreader_readline_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readlines), MP_ROM_PTR(&bufreader_readlines_obj) },
+    { MP_ROM_QSTR(MP_QSTR_peek), MP_ROM_PTR(&bufreader_peek_obj) },
+    { MP_ROM_QSTR(MP_QSTR_seek), MP_ROM_PTR(&mp_stream_seek_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tell), MP_ROM_PTR(&mp_stream_tell_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&bufreader_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&bufreader___exit___obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(bufreader_locals_dict, bufreader_locals_dict_table);
+
+STATIC const mp_stream_p_t bufreader_stream_p = {
+    .read = bufreader_read,
+    .ioctl = bufreader_ioctl,
+};
+
+STATIC const mp_obj_type_t bufreader_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_BufferedReader,
+    .make_new = bufreader_make_new,
+    .getiter = mp_identity_getiter,
+    .iternext = bufreader_iternext,
+    .protocol = &bufreader_stream_p,
+    .locals_dict = (mp_obj_dict_t*)&bufreader_locals_dict,
+};
+#endif // MICROPY_PY_IO_BUFFEREDREADER
+
 #if MICROPY_MODULE_FROZEN_STR
 STATIC mp_obj_t resource_stream(mp_obj_t package_in, mp_obj_t path_in) {
     VSTR_FIXED(path_buf, MICROPY_ALLOC_PATH_MAX);
@@ -203,6 +495,9 @@ STATIC const mp_rom_map_elem_t mp_module_io_globals_table[] = {
     #if MICROPY_PY_IO_BUFFEREDWRITER
     { MP_ROM_QSTR(MP_QSTR_BufferedWriter), MP_ROM_PTR(&bufwriter_type) },
     #endif
+    #if MICROPY_PY_IO_BUFFEREDREADER
+    { MP_ROM_QSTR(MP_QSTR_BufferedReader), MP_ROM_PTR(&bufreader_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_io_globals, mp_module_io_globals_table);
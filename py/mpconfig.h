@@ -116,6 +116,90 @@
 #define MICROPY_GC_CONSERVATIVE_CLEAR (MICROPY_ENABLE_GC)
 #endif
 
+// Number of small-allocation size classes (in blocks) for which the GC keeps
+// lists of free runs, rebuilt on each sweep.  Allocations of up to this many
+// blocks are then served from those runs (or carved from a longer free run)
+// without scanning the ATB table.  Set to 0 to disable.
+#ifndef MICROPY_GC_SIZE_CLASSES
+#define MICROPY_GC_SIZE_CLASSES (0)
+#endif
+
+// Maximum number of free runs remembered per size class
+#ifndef MICROPY_GC_SIZE_CLASS_LEN
+#define MICROPY_GC_SIZE_CLASS_LEN (64)
+#endif
+
+// Keep a table of heap blocks which hold no heap pointers (string data,
+// byte buffers, qstr chunks) so the mark phase does not scan their contents.
+// Costs one bit per GC block.
+#ifndef MICROPY_GC_LEAF_BLOCKS
+#define MICROPY_GC_LEAF_BLOCKS (0)
+#endif
+
+// Sweep the heap lazily: a collection only sweeps the first slice of the heap
+// and the rest is swept a slice at a time by subsequent allocations, which
+// shortens the pause of each collection.  Marking is still done in one go as
+// there is no write barrier on heap stores made by C code.
+#ifndef MICROPY_GC_LAZY_SWEEP
+#define MICROPY_GC_LAZY_SWEEP (0)
+#endif
+
+// Default number of heap bytes swept per slice, configurable by gc.sweep_slice()
+#ifndef MICROPY_GC_SWEEP_SLICE
+#define MICROPY_GC_SWEEP_SLICE (16384)
+#endif
+
+// Support gc.compact(), a collection which also slides movable objects down
+// into free space to reduce fragmentation; requires MICROPY_GC_LEAF_BLOCKS and
+// MICROPY_ENABLE_FINALISER
+#ifndef MICROPY_GC_COMPACT
+#define MICROPY_GC_COMPACT (0)
+#endif
+
+// Maximum number of threads, including the collecting thread, which may take
+// part in the mark phase of a collection; 0 disables parallel marking.  The
+// number actually used is set at runtime by gc.mark_threads() and defaults
+// to 1.  Requires MICROPY_PY_THREAD and a port providing
+// mp_thread_gc_run_workers().
+#ifndef MICROPY_GC_PARALLEL_MARK
+#define MICROPY_GC_PARALLEL_MARK (0)
+#endif
+
+// Hook called by a mark thread while it waits for another to share work
+#ifndef MICROPY_GC_MARK_IDLE_HOOK
+#define MICROPY_GC_MARK_IDLE_HOOK()
+#endif
+
+// Number of entries in the pool through which mark threads share work
+#ifndef MICROPY_GC_MARK_POOL_SIZE
+#define MICROPY_GC_MARK_POOL_SIZE (1024)
+#endif
+
+// Give each thread an allocation buffer: a run of blocks reserved under the
+// GC mutex which small objects are then bump allocated from without taking
+// the mutex.  Unused blocks are returned to the heap by the next collection.
+// Only useful with MICROPY_PY_THREAD and without the GIL.
+#ifndef MICROPY_GC_TLAB
+#define MICROPY_GC_TLAB (0)
+#endif
+
+// Maximum number of blocks in each allocation buffer; objects of up to an
+// eighth of this size are allocated from the buffer
+#ifndef MICROPY_GC_TLAB_BLOCKS
+#define MICROPY_GC_TLAB_BLOCKS (64)
+#endif
+
+// Maximum number of threads which may have an allocation buffer at once
+#ifndef MICROPY_GC_TLAB_SLOTS
+#define MICROPY_GC_TLAB_SLOTS (16)
+#endif
+
+// Record the duration of GC pauses (collections and sweep slices) using
+// mp_hal_ticks_us, available via gc.pause_stats()
+#ifndef MICROPY_GC_PAUSE_STATS
+#define MICROPY_GC_PAUSE_STATS (0)
+#endif
+
 // Support automatic GC when reaching allocation threshold,
 // configurable by gc.threshold().
 #ifndef MICROPY_GC_ALLOC_THRESHOLD
@@ -140,6 +224,11 @@
 #define MICROPY_ALLOC_LEXEL_INDENT_INC (8)
 #endif
 
+// Size of the buffer the lexer reads source code into
+#ifndef MICROPY_ALLOC_LEXER_BUF
+#define MICROPY_ALLOC_LEXER_BUF (32)
+#endif
+
 // Initial amount for parse rule stack
 #ifndef MICROPY_ALLOC_PARSE_RULE_INIT
 #define MICROPY_ALLOC_PARSE_RULE_INIT (64)
@@ -396,12 +485,101 @@
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (0)
 #endif
 
+// Whether to rewrite bytecode in RAM, when it is loaded, to use fused and
+// small-int specialised opcodes for common sequences (loop counters and
+// comparisons).  Specialised opcodes revert to the generic ones the first
+// time they see operands they can't handle.  Bytecode that is saved with
+// MICROPY_PERSISTENT_CODE_SAVE is never rewritten.
+#ifndef MICROPY_OPT_QUICKEN_BYTECODE
+#define MICROPY_OPT_QUICKEN_BYTECODE (0)
+#endif
+
+// Whether to remember where qstr keys were last found in ordered maps, which
+// include the const dicts of all builtin modules and types, so that repeated
+// lookups don't need a linear search.  Uses 2 bytes of RAM per cache entry.
+#ifndef MICROPY_OPT_MAP_LOOKUP_CACHE
+#define MICROPY_OPT_MAP_LOOKUP_CACHE (0)
+#endif
+
+// Number of entries in the map lookup cache; must be a power of 2
+#ifndef MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE
+#define MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE (256)
+#endif
+
+// Whether str/bytes built up with += keep spare room after their data, so
+// that the next += on the most recently grown object can append in place
+// instead of copying the whole string.  Other objects sharing the buffer only
+// ever see their own prefix of it, so no uniqueness check is needed.  Costs
+// up to half as much RAM again for the string being built.  Without a GIL
+// appends are serialised by a mutex.
+#ifndef MICROPY_OPT_STR_INPLACE_ADD
+#define MICROPY_OPT_STR_INPLACE_ADD (0)
+#endif
+
+// Whether to look up qstrs by their hash in a hash table, instead of
+// searching all the pools linearly.  The table for the qstrs built into the
+// firmware is generated with them and costs 2 bytes of ROM for every slot
+// (at least 2 slots per qstr); dynamically created qstrs get a table on the
+// heap.  Needs MICROPY_QSTR_BYTES_IN_HASH of 2 to be effective.
+#ifndef MICROPY_OPT_QSTR_HASH_INDEX
+#define MICROPY_OPT_QSTR_HASH_INDEX (0)
+#endif
+
+// Whether to cache the result of class attribute lookups on instances of
+// user classes in LOAD_ATTR and LOAD_METHOD.  Uses a table of
+// MICROPY_OPT_ATTR_INLINE_CACHE_SIZE call-site slots (2 entries each) in the
+// VM state, plus a small heap object per cached entry, and avoids walking the
+// class hierarchy and checking for descriptors on each method call.
+#ifndef MICROPY_OPT_ATTR_INLINE_CACHE
+#define MICROPY_OPT_ATTR_INLINE_CACHE (0)
+#endif
+
+// Number of call-site slots in the attribute cache; must be a power of 2
+#ifndef MICROPY_OPT_ATTR_INLINE_CACHE_SIZE
+#define MICROPY_OPT_ATTR_INLINE_CACHE_SIZE (256)
+#endif
+
 // Whether to use fast versions of bitwise operations (and, or, xor) when the
 // arguments are both positive.  Increases Thumb2 code size by about 250 bytes.
 #ifndef MICROPY_OPT_MPZ_BITWISE
 #define MICROPY_OPT_MPZ_BITWISE (0)
 #endif
 
+// Whether to multiply large integers using Karatsuba's method, which is
+// O(n^1.58) rather than O(n^2) in the number of digits.  It is used once both
+// operands have at least MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD digits, and needs
+// temporary heap memory of about 4 times the digits of the longer operand.
+#ifndef MICROPY_OPT_MPZ_KARATSUBA
+#define MICROPY_OPT_MPZ_KARATSUBA (0)
+#endif
+
+// Number of digits (each MPZ_DIG_SIZE bits) below which the schoolbook method
+// is faster than Karatsuba's; must be at least 4
+#ifndef MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD
+#define MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD (32)
+#endif
+
+// Whether pow(a, b, m) with an odd modulus of 2 or more digits uses
+// Montgomery multiplication instead of a long division after each step.
+// Needs temporary heap memory of about 4 times the digits of the modulus.
+#ifndef MICROPY_OPT_MPZ_MONTGOMERY
+#define MICROPY_OPT_MPZ_MONTGOMERY (0)
+#endif
+
+// Whether converting large integers to and from strings in a base that is not
+// a power of 2 splits the number in halves using powers of the base, instead
+// of working through the whole number for each group of characters.  Parsing
+// is only split with MICROPY_OPT_MPZ_KARATSUBA, which makes it subquadratic.
+#ifndef MICROPY_OPT_MPZ_DIVCONQ_STR
+#define MICROPY_OPT_MPZ_DIVCONQ_STR (0)
+#endif
+
+// Number of digits (each MPZ_DIG_SIZE bits) below which integers are
+// converted to and from strings by the direct method
+#ifndef MICROPY_OPT_MPZ_DIVCONQ_STR_THRESHOLD
+#define MICROPY_OPT_MPZ_DIVCONQ_STR_THRESHOLD (16)
+#endif
+
 /*****************************************************************************/
 /* Python internal features                                                  */
 
@@ -581,6 +759,14 @@ typedef double mp_float_t;
 #define MICROPY_FLOAT_HIGH_QUALITY_HASH (0)
 #endif
 
+// Whether to convert floats to and from decimal strings using table-driven
+// integer algorithms: repr gives the shortest string that reads back to the
+// same value (Ryu) and parsing is correctly rounded (Eisel-Lemire).  Needs a
+// table of about 10k bytes with double precision, 2k with single precision.
+#ifndef MICROPY_FLOAT_FAST_CONV
+#define MICROPY_FLOAT_FAST_CONV (0)
+#endif
+
 // Enable features which improve CPython compatibility
 // but may lead to more code size/memory usage.
 // TODO: Originally intended as generic category to not
@@ -956,6 +1142,11 @@ typedef double mp_float_t;
 #define MICROPY_PY_IO_BUFFEREDWRITER (0)
 #endif
 
+// Whether to provide "io.BufferedReader" class
+#ifndef MICROPY_PY_IO_BUFFEREDREADER
+#define MICROPY_PY_IO_BUFFEREDREADER (0)
+#endif
+
 // Whether to provide "struct" module
 #ifndef MICROPY_PY_STRUCT
 #define MICROPY_PY_STRUCT (1)
@@ -1061,10 +1252,25 @@ typedef double mp_float_t;
 #define MICROPY_PY_UZLIB (0)
 #endif
 
+// Whether uzlib provides compress() and CompIO as well as decompression
+#ifndef MICROPY_PY_UZLIB_COMPRESS
+#define MICROPY_PY_UZLIB_COMPRESS (0)
+#endif
+
 #ifndef MICROPY_PY_UJSON
 #define MICROPY_PY_UJSON (0)
 #endif
 
+// Whether ujson.dump/dumps accept a "separators" argument
+#ifndef MICROPY_PY_UJSON_SEPARATORS
+#define MICROPY_PY_UJSON_SEPARATORS (1)
+#endif
+
+// Whether to provide ujson.iterparse, an event-based parser
+#ifndef MICROPY_PY_UJSON_ITERPARSE
+#define MICROPY_PY_UJSON_ITERPARSE (0)
+#endif
+
 #ifndef MICROPY_PY_URE
 #define MICROPY_PY_URE (0)
 #endif
@@ -73,6 +73,9 @@ typedef struct _mp_state_mem_t {
     #if MICROPY_ENABLE_FINALISER
     byte *gc_finaliser_table_start;
     #endif
+    #if MICROPY_GC_LEAF_BLOCKS
+    byte *gc_leaf_table_start;
+    #endif
     byte *gc_pool_start;
     byte *gc_pool_end;
 
@@ -93,6 +96,55 @@ typedef struct _mp_state_mem_t {
 
     size_t gc_last_free_atb_index;
 
+    #if MICROPY_GC_LAZY_SWEEP
+    // blocks from here to the end of the heap have not been swept yet
+    size_t gc_sweep_block;
+    size_t gc_sweep_slice_blocks;
+    #endif
+
+    #if MICROPY_GC_PAUSE_STATS
+    mp_uint_t gc_pause_start;
+    mp_uint_t gc_pause_last_us;
+    mp_uint_t gc_pause_max_us;
+    #endif
+
+    #if MICROPY_GC_SIZE_CLASSES
+    // free runs of exactly n+1 blocks, stored as their starting block, with
+    // the last list holding runs longer than MICROPY_GC_SIZE_CLASSES blocks
+    size_t gc_size_class_free[MICROPY_GC_SIZE_CLASSES + 1][MICROPY_GC_SIZE_CLASS_LEN];
+    size_t gc_size_class_len[MICROPY_GC_SIZE_CLASSES + 1];
+    size_t gc_size_class_hits;
+    size_t gc_size_class_misses;
+    #endif
+
+    #if MICROPY_GC_COMPACT
+    // pin and forwarding bitmaps while a compacting collection is running
+    byte *gc_compact_table;
+    struct _gc_compact_info_t *gc_compact_info;
+    #endif
+
+    #if MICROPY_GC_PARALLEL_MARK
+    // number of threads used for marking, and the state they share
+    size_t gc_mark_threads;
+    mp_thread_mutex_t gc_mark_mutex;
+    size_t gc_mark_pool[MICROPY_GC_MARK_POOL_SIZE];
+    size_t gc_mark_pool_len;
+    size_t gc_mark_idle;
+    int gc_mark_rescan;
+    #endif
+
+    #if MICROPY_GC_TLAB
+    // allocation buffers handed out before the current epoch are stale; while
+    // gc_tlab_stop is set no thread may bump allocate, and each thread's
+    // slot is busy while it does
+    size_t gc_tlab_epoch;
+    int gc_tlab_stop;
+    struct {
+        int busy;
+        int claimed;
+    } __attribute__((aligned(64))) gc_tlab_slot[MICROPY_GC_TLAB_SLOTS];
+    #endif
+
     #if MICROPY_PY_GC_COLLECT_RETVAL
     size_t gc_collected;
     #endif
@@ -181,6 +233,16 @@ typedef struct _mp_state_vm_t {
     struct _mp_vfs_mount_t *vfs_mount_table;
     #endif
 
+    #if MICROPY_OPT_QSTR_HASH_INDEX
+    // hash table of the qstrs that aren't in the const pool
+    qstr *qstr_index;
+    #endif
+
+    #if MICROPY_OPT_ATTR_INLINE_CACHE
+    // per-call-site cache of attribute lookups on instances, 2 entries each
+    struct _mp_attr_cache_entry_t *attr_cache[MICROPY_OPT_ATTR_INLINE_CACHE_SIZE][2];
+    #endif
+
     //
     // END ROOT POINTER SECTION
     ////////////////////////////////////////////////////////////
@@ -191,6 +253,34 @@ typedef struct _mp_state_vm_t {
     size_t qstr_last_alloc;
     size_t qstr_last_used;
 
+    #if MICROPY_OPT_QSTR_HASH_INDEX
+    size_t qstr_index_len;
+    #endif
+
+    #if MICROPY_OPT_ATTR_INLINE_CACHE
+    // incremented whenever a class attribute is stored or deleted, which
+    // invalidates all entries in the attribute cache
+    size_t attr_cache_version;
+    #endif
+
+    #if MICROPY_OPT_STR_INPLACE_ADD
+    // data of the str/bytes most recently grown by +=, see str_inplace_add,
+    // with its allocated size and the number of bytes in use by the most
+    // recent object.  The buffer isn't a root pointer: the GC forgets it when
+    // nothing else references it, so it doesn't keep a dead string alive.
+    const byte *str_append_buf;
+    size_t str_append_alloc;
+    size_t str_append_len;
+    #if MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL
+    mp_thread_mutex_t str_append_mutex;
+    #endif
+    #endif
+
+    #if MICROPY_OPT_MAP_LOOKUP_CACHE
+    // where a key was last found in an ordered map, see mp_map_lookup
+    uint16_t map_lookup_cache[MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE];
+    #endif
+
     #if MICROPY_PY_THREAD
     // This is a global mutex used to make qstr interning thread-safe.
     mp_thread_mutex_t qstr_mutex;
@@ -228,6 +318,16 @@ typedef struct _mp_state_thread_t {
     #if MICROPY_STACK_CHECK
     size_t stack_limit;
     #endif
+
+    #if MICROPY_GC_TLAB
+    // allocation buffer: blocks from gc_tlab_block up to gc_tlab_end are free
+    // for this thread to allocate from while gc_tlab_epoch is current; slot
+    // is 1 + the index of this thread's entry in gc_tlab_slot, or 0
+    size_t gc_tlab_block;
+    size_t gc_tlab_end;
+    size_t gc_tlab_epoch;
+    size_t gc_tlab_slot;
+    #endif
 } mp_state_thread_t;
 
 // This structure combines the above 3 structures.
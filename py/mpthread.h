@@ -46,6 +46,12 @@ void mp_thread_finish(void);
 void mp_thread_mutex_init(mp_thread_mutex_t *mutex);
 int mp_thread_mutex_lock(mp_thread_mutex_t *mutex, int wait);
 void mp_thread_mutex_unlock(mp_thread_mutex_t *mutex);
+#if MICROPY_GC_PARALLEL_MARK
+// Call fun(id, n) on n threads, one of them the calling thread, with ids
+// 0 to n-1, and wait for them all to return.  n may be less than n_threads
+// if helper threads could not be started.
+void mp_thread_gc_run_workers(size_t n_threads, void (*fun)(size_t id, size_t n));
+#endif
 
 #endif // MICROPY_PY_THREAD
 
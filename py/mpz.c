@@ -449,6 +449,134 @@ STATIC size_t mpn_mul(mpz_dig_t *idig, mpz_dig_t *jdig, size_t jlen, mpz_dig_t *
     return ilen;
 }
 
+#if MICROPY_OPT_MPZ_KARATSUBA || MICROPY_OPT_MPZ_MONTGOMERY
+
+/* computes i -= j, where i >= j
+   the borrow out of the top of j is propagated into the digits of i above it
+*/
+STATIC void mpn_sub_inpl(mpz_dig_t *idig, const mpz_dig_t *jdig, size_t jlen) {
+    mpz_dbl_dig_signed_t borrow = 0;
+    for (; jlen > 0; --jlen, ++idig, ++jdig) {
+        borrow += (mpz_dbl_dig_t)*idig - (mpz_dbl_dig_t)*jdig;
+        *idig = borrow & DIG_MASK;
+        borrow >>= DIG_SIZE;
+    }
+    for (; borrow != 0; ++idig) {
+        borrow += *idig;
+        *idig = borrow & DIG_MASK;
+        borrow >>= DIG_SIZE;
+    }
+}
+
+#endif
+
+#if MICROPY_OPT_MPZ_KARATSUBA
+
+/* computes i += j, where i has enough digits to hold the result
+   the carry out of the top of j is propagated into the digits of i above it
+*/
+STATIC void mpn_add_inpl(mpz_dig_t *idig, const mpz_dig_t *jdig, size_t jlen) {
+    mpz_dbl_dig_t carry = 0;
+    for (; jlen > 0; --jlen, ++idig, ++jdig) {
+        carry += (mpz_dbl_dig_t)*idig + (mpz_dbl_dig_t)*jdig;
+        *idig = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+    for (; carry != 0; ++idig) {
+        carry += *idig;
+        *idig = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+}
+
+/* computes i = j + k, with j having exactly jlen digits and klen <= jlen
+   i has jlen + 1 digits, the top one being the carry
+*/
+STATIC void mpn_add_fixed(mpz_dig_t *idig, const mpz_dig_t *jdig, size_t jlen, const mpz_dig_t *kdig, size_t klen) {
+    memcpy(idig, jdig, jlen * sizeof(mpz_dig_t));
+    memset(idig + jlen, 0, sizeof(mpz_dig_t));
+    mpn_add_inpl(idig, kdig, klen);
+}
+
+// scratch memory for multiplications up to about 4 times the threshold fits
+// in this many digits, which mpz_mul_inpl takes from the C stack
+#define MPZ_KARATSUBA_STACK_DIGS (16 * MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD)
+
+/* returns the number of scratch digits needed by mpn_mul_karatsuba for the
+   given lengths; this follows the same recursion as mpn_mul_karatsuba
+*/
+STATIC size_t mpn_mul_karatsuba_scratch(size_t jlen, size_t klen) {
+    if (klen < MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD) {
+        return 0;
+    }
+    size_t h = (jlen + 1) / 2;
+    if (klen <= h) {
+        // multiplied in pieces of klen digits
+        return 2 * klen + mpn_mul_karatsuba_scratch(klen, klen);
+    }
+    return 4 * (h + 1) + mpn_mul_karatsuba_scratch(h + 1, h + 1);
+}
+
+/* computes i = j * k using Karatsuba's method, falling back to mpn_mul for
+   short k; all jlen + klen digits of i are written, so it may have leading
+   zeros, and j and k don't need to be normalised
+   assumes jlen >= klen > 0; assumes enough scratch memory in t
+   can have j, k point to same memory
+*/
+STATIC void mpn_mul_karatsuba(mpz_dig_t *idig, const mpz_dig_t *jdig, size_t jlen, const mpz_dig_t *kdig, size_t klen, mpz_dig_t *tdig) {
+    if (klen < MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD) {
+        memset(idig, 0, (jlen + klen) * sizeof(mpz_dig_t));
+        mpn_mul(idig, (mpz_dig_t*)jdig, jlen, (mpz_dig_t*)kdig, klen);
+        return;
+    }
+
+    size_t h = (jlen + 1) / 2;
+
+    if (klen <= h) {
+        // j is much longer than k, so multiply k by pieces of j of the
+        // same length as k and add up the partial products
+        memset(idig, 0, (jlen + klen) * sizeof(mpz_dig_t));
+        for (size_t off = 0; off < jlen; off += klen) {
+            size_t plen = jlen - off < klen ? jlen - off : klen;
+            if (plen == klen) {
+                mpn_mul_karatsuba(tdig, jdig + off, plen, kdig, klen, tdig + 2 * klen);
+            } else {
+                mpn_mul_karatsuba(tdig, kdig, klen, jdig + off, plen, tdig + 2 * klen);
+            }
+            mpn_add_inpl(idig + off, tdig, plen + klen);
+        }
+        return;
+    }
+
+    // split j = j1 * B^h + j0 and k = k1 * B^h + k0, then
+    // j * k = z2 * B^2h + (z1 - z2 - z0) * B^h + z0 with
+    // z0 = j0 * k0, z2 = j1 * k1, z1 = (j0 + j1) * (k0 + k1)
+    size_t j1len = jlen - h;
+    size_t k1len = klen - h;
+    mpz_dig_t *jsum = tdig;
+    mpz_dig_t *ksum = jsum + h + 1;
+    mpz_dig_t *z1 = ksum + h + 1;
+    mpz_dig_t *tnext = z1 + 2 * (h + 1);
+
+    mpn_mul_karatsuba(idig, jdig, h, kdig, h, tdig);
+    mpn_mul_karatsuba(idig + 2 * h, jdig + h, j1len, kdig + h, k1len, tdig);
+
+    mpn_add_fixed(jsum, jdig, h, jdig + h, j1len);
+    mpn_add_fixed(ksum, kdig, h, kdig + h, k1len);
+    mpn_mul_karatsuba(z1, jsum, h + 1, ksum, h + 1, tnext);
+    mpn_sub_inpl(z1, idig, 2 * h);
+    mpn_sub_inpl(z1, idig + 2 * h, j1len + k1len);
+
+    // the top digits of z1 are zero if they extend beyond i
+    size_t z1len = jlen + klen - h;
+    if (z1len > 2 * (h + 1)) {
+        z1len = 2 * (h + 1);
+    }
+    mpn_add_inpl(idig + h, z1, z1len);
+}
+
+#endif
+
 /* natural_div - quo * den + new_num = old_num (ie num is replaced with rem)
    assumes den != 0
    assumes num_dig has enough memory to be extended by 1 digit
@@ -523,97 +651,48 @@ STATIC void mpn_div(mpz_dig_t *num_dig, size_t *num_len, const mpz_dig_t *den_di
         quo /= lead_den_digit;
 
         // Multiply quo by den and subtract from num to get remainder.
-        // We have different code here to handle different compile-time
-        // configurations of mpz:
+        // Must be careful with overflow of the borrow variable.  Both
+        // borrow and low_digs are signed values and need signed right-shift,
+        // but x is unsigned and may take a full-range value.
+        const mpz_dig_t *d = den_dig;
+        mpz_dbl_dig_t d_norm = 0;
+        mpz_dbl_dig_signed_t borrow = 0;
+        for (mpz_dig_t *n = num_dig - den_len; n < num_dig; ++n, ++d) {
+            // Get the next digit in (den).
+            d_norm = ((mpz_dbl_dig_t)*d << norm_shift) | (d_norm >> DIG_SIZE);
+            // Multiply the next digit in (quo * den).
+            mpz_dbl_dig_t x = (mpz_dbl_dig_t)quo * (d_norm & DIG_MASK);
+            // Compute the low DIG_MASK bits of the next digit in (num - quo * den)
+            mpz_dbl_dig_signed_t low_digs = (borrow & DIG_MASK) + *n - (x & DIG_MASK);
+            // Store the digit result for (num).
+            *n = low_digs & DIG_MASK;
+            // Compute the borrow, shifted right before summing to avoid overflow.
+            borrow = (borrow >> DIG_SIZE) - (x >> DIG_SIZE) + (low_digs >> DIG_SIZE);
+        }
+
+        // At this point we have either:
         //
-        //   1. DIG_SIZE is stricly less than half the number of bits
-        //      available in mpz_dbl_dig_t.  In this case we can use a
-        //      slightly more optimal (in time and space) routine that
-        //      uses the extra bits in mpz_dbl_dig_signed_t to store a
-        //      sign bit.
+        //   1. quo was the correct value and the most-sig-digit of num is exactly
+        //      cancelled by borrow (borrow + *num_dig == 0).  In this case there is
+        //      nothing more to do.
         //
-        //   2. DIG_SIZE is exactly half the number of bits available in
-        //      mpz_dbl_dig_t.  In this (common) case we need to be careful
-        //      not to overflow the borrow variable.  And the shifting of
-        //      borrow needs some special logic (it's a shift right with
-        //      round up).
-
-        if (DIG_SIZE < 8 * sizeof(mpz_dbl_dig_t) / 2) {
-            const mpz_dig_t *d = den_dig;
-            mpz_dbl_dig_t d_norm = 0;
-            mpz_dbl_dig_signed_t borrow = 0;
-
-            for (mpz_dig_t *n = num_dig - den_len; n < num_dig; ++n, ++d) {
-                d_norm = ((mpz_dbl_dig_t)*d << norm_shift) | (d_norm >> DIG_SIZE);
-                borrow += (mpz_dbl_dig_t)*n - (mpz_dbl_dig_t)quo * (d_norm & DIG_MASK); // will overflow if DIG_SIZE >= 8*sizeof(mpz_dbl_dig_t)/2
-                *n = borrow & DIG_MASK;
-                borrow >>= DIG_SIZE;
-            }
-            borrow += *num_dig; // will overflow if DIG_SIZE >= 8*sizeof(mpz_dbl_dig_t)/2
-            *num_dig = borrow & DIG_MASK;
-            borrow >>= DIG_SIZE;
-
-            // adjust quotient if it is too big
-            for (; borrow != 0; --quo) {
-                d = den_dig;
-                d_norm = 0;
-                mpz_dbl_dig_t carry = 0;
-                for (mpz_dig_t *n = num_dig - den_len; n < num_dig; ++n, ++d) {
-                    d_norm = ((mpz_dbl_dig_t)*d << norm_shift) | (d_norm >> DIG_SIZE);
-                    carry += (mpz_dbl_dig_t)*n + (d_norm & DIG_MASK);
-                    *n = carry & DIG_MASK;
-                    carry >>= DIG_SIZE;
-                }
-                carry += *num_dig;
-                *num_dig = carry & DIG_MASK;
-                carry >>= DIG_SIZE;
-
-                borrow += carry;
-            }
-        } else { // DIG_SIZE == 8 * sizeof(mpz_dbl_dig_t) / 2
-            const mpz_dig_t *d = den_dig;
-            mpz_dbl_dig_t d_norm = 0;
-            mpz_dbl_dig_t borrow = 0;
-
+        //   2. quo was too large, we subtracted too many den from num, and the
+        //      most-sig-digit of num is less than needed (borrow + *num_dig < 0).
+        //      In this case we must reduce quo and add back den to num until the
+        //      carry from this operation cancels out the borrow.
+        //
+        borrow += *num_dig;
+        for (; borrow != 0; --quo) {
+            d = den_dig;
+            d_norm = 0;
+            mpz_dbl_dig_t carry = 0;
             for (mpz_dig_t *n = num_dig - den_len; n < num_dig; ++n, ++d) {
                 d_norm = ((mpz_dbl_dig_t)*d << norm_shift) | (d_norm >> DIG_SIZE);
-                mpz_dbl_dig_t x = (mpz_dbl_dig_t)quo * (d_norm & DIG_MASK);
-                if (x >= *n || *n - x <= borrow) {
-                    borrow += (mpz_dbl_dig_t)x - (mpz_dbl_dig_t)*n;
-                    *n = (-borrow) & DIG_MASK;
-                    borrow = (borrow >> DIG_SIZE) + ((borrow & DIG_MASK) == 0 ? 0 : 1); // shift-right with round-up
-                } else {
-                    *n = ((mpz_dbl_dig_t)*n - (mpz_dbl_dig_t)x - (mpz_dbl_dig_t)borrow) & DIG_MASK;
-                    borrow = 0;
-                }
-            }
-            if (borrow >= *num_dig) {
-                borrow -= (mpz_dbl_dig_t)*num_dig;
-                *num_dig = (-borrow) & DIG_MASK;
-                borrow = (borrow >> DIG_SIZE) + ((borrow & DIG_MASK) == 0 ? 0 : 1); // shift-right with round-up
-            } else {
-                *num_dig = (*num_dig - borrow) & DIG_MASK;
-                borrow = 0;
-            }
-
-            // adjust quotient if it is too big
-            for (; borrow != 0; --quo) {
-                d = den_dig;
-                d_norm = 0;
-                mpz_dbl_dig_t carry = 0;
-                for (mpz_dig_t *n = num_dig - den_len; n < num_dig; ++n, ++d) {
-                    d_norm = ((mpz_dbl_dig_t)*d << norm_shift) | (d_norm >> DIG_SIZE);
-                    carry += (mpz_dbl_dig_t)*n + (d_norm & DIG_MASK);
-                    *n = carry & DIG_MASK;
-                    carry >>= DIG_SIZE;
-                }
-                carry += (mpz_dbl_dig_t)*num_dig;
-                *num_dig = carry & DIG_MASK;
+                carry += (mpz_dbl_dig_t)*n + (d_norm & DIG_MASK);
+                *n = carry & DIG_MASK;
                 carry >>= DIG_SIZE;
-
-                //assert(borrow >= carry); // enable this to check the logic
-                borrow -= carry;
             }
+            borrow += carry;
         }
 
         // store this digit of the quotient
@@ -725,7 +804,11 @@ STATIC void mpz_need_dig(mpz_t *z, size_t need) {
         // if z has fixed digit buffer there's not much we can do as the caller will
         // be expecting a buffer with at least "need" bytes (but it shouldn't happen)
         assert(!z->fixed_dig);
-        z->dig = m_renew(mpz_dig_t, z->dig, z->alloc, need);
+        if (z->dig == NULL) {
+            z->dig = m_new_leaf(mpz_dig_t, need);
+        } else {
+            z->dig = m_renew(mpz_dig_t, z->dig, z->alloc, need);
+        }
         z->alloc = need;
     }
 }
@@ -739,7 +822,7 @@ STATIC mpz_t *mpz_clone(const mpz_t *src) {
     if (src->dig == NULL) {
         z->dig = NULL;
     } else {
-        z->dig = m_new(mpz_dig_t, z->alloc);
+        z->dig = m_new_leaf(mpz_dig_t, z->alloc);
         memcpy(z->dig, src->dig, src->alloc * sizeof(mpz_dig_t));
     }
     return z;
@@ -869,14 +952,192 @@ typedef uint32_t mp_float_int_t;
 }
 #endif
 
+/* computes the largest power of base that fits in a single digit
+   returns the power and stores its exponent (characters per digit) in *nchars
+*/
+STATIC mpz_dig_t mpz_str_chunk(unsigned int base, size_t *nchars) {
+    mpz_dbl_dig_t chunk = base;
+    size_t n = 1;
+    while (chunk * base <= DIG_MASK) {
+        chunk *= base;
+        n += 1;
+    }
+    *nchars = n;
+    return chunk;
+}
+
+// returns log2(base) if base is a power of 2, otherwise 0
+STATIC unsigned int mpz_str_pow2_bits(unsigned int base) {
+    if ((base & (base - 1)) != 0) {
+        return 0;
+    }
+    unsigned int bits = 0;
+    while (base > 1) {
+        base >>= 1;
+        bits += 1;
+    }
+    return bits;
+}
+
+STATIC unsigned int mpz_str_char_value(char c) {
+    if ('0' <= c && c <= '9') {
+        return c - '0';
+    } else if ('A' <= c && c <= 'Z') {
+        return c - ('A' - 10);
+    } else if ('a' <= c && c <= 'z') {
+        return c - ('a' - 10);
+    } else {
+        return 36;
+    }
+}
+
+#if MICROPY_OPT_MPZ_DIVCONQ_STR
+
+// enough powers of the base to split numbers of up to 2**24 digits in halves
+#define MPZ_STR_MAX_POW (24)
+
+// strings of at least this many characters per digit are parsed by splitting
+// them, which only pays once the multiplications are well into Karatsuba
+#define MPZ_STR_PARSE_THRESHOLD (8 * MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD)
+
+// state for converting between numbers and strings by divide and conquer;
+// pow[n] holds base**(nchars * 2**n) and is computed when first needed
+typedef struct _mpz_str_conv_t {
+    unsigned int base;
+    char base_char;
+    mpz_dig_t chunk;
+    size_t nchars;
+    size_t npow;
+    mpz_t pow[MPZ_STR_MAX_POW];
+} mpz_str_conv_t;
+
+STATIC void mpz_str_conv_init(mpz_str_conv_t *conv, unsigned int base, char base_char) {
+    conv->base = base;
+    conv->base_char = base_char;
+    conv->chunk = mpz_str_chunk(base, &conv->nchars);
+    conv->npow = 1;
+    mpz_init_from_int(&conv->pow[0], conv->chunk);
+}
+
+STATIC void mpz_str_conv_deinit(mpz_str_conv_t *conv) {
+    for (size_t n = 0; n < conv->npow; ++n) {
+        mpz_deinit(&conv->pow[n]);
+    }
+}
+
+STATIC const mpz_t *mpz_str_conv_pow(mpz_str_conv_t *conv, size_t n) {
+    while (conv->npow <= n) {
+        mpz_t *p = &conv->pow[conv->npow];
+        mpz_init_zero(p);
+        mpz_mul_inpl(p, p - 1, p - 1);
+        conv->npow += 1;
+    }
+    return &conv->pow[n];
+}
+
+#endif
+
+/* sets z to the value of the n characters at str, which must all be valid
+   digits in base; takes the characters nchars at a time, as a number below
+   chunk = base**nchars; assumes enough memory in z
+*/
+STATIC void mpz_set_from_str_basecase(mpz_t *z, const char *str, size_t n, unsigned int base, size_t nchars) {
+    z->len = 0;
+    if (n == 0) {
+        return;
+    }
+    size_t k = (n - 1) % nchars + 1;
+    for (const char *top = str + n; str < top; str += k, k = nchars) {
+        mpz_dig_t mul = 1;
+        mpz_dig_t v = 0;
+        for (size_t j = 0; j < k; ++j) {
+            mul *= base;
+            v = v * base + mpz_str_char_value(str[j]);
+        }
+        z->len = mpn_mul_dig_add_dig(z->dig, z->len, mul, v);
+    }
+}
+
+/* sets z to the value of the n characters at str, which must all be valid
+   digits in the base 2**bits; assumes enough memory in z
+*/
+STATIC void mpz_set_from_str_pow2(mpz_t *z, const char *str, size_t n, unsigned int bits) {
+    mpz_dbl_dig_t acc = 0;
+    unsigned int acc_bits = 0;
+    z->len = 0;
+    for (const char *cur = str + n; cur > str;) {
+        acc |= (mpz_dbl_dig_t)mpz_str_char_value(*--cur) << acc_bits;
+        acc_bits += bits;
+        if (acc_bits >= DIG_SIZE) {
+            z->dig[z->len++] = acc & DIG_MASK;
+            acc >>= DIG_SIZE;
+            acc_bits -= DIG_SIZE;
+        }
+    }
+    z->dig[z->len++] = acc;
+    z->len = mpn_remove_trailing_zeros(z->dig, z->dig + z->len);
+}
+
+#if MICROPY_OPT_MPZ_DIVCONQ_STR && MICROPY_OPT_MPZ_KARATSUBA
+/* sets z to the value of the n characters at str, which must all be valid
+   digits in the base; splits off the low nchars * 2**k characters, for the
+   largest such block that is shorter than the string, and combines the two
+   halves as hi * base**(nchars * 2**k) + lo
+*/
+STATIC void mpz_set_from_str_divconq(mpz_t *z, const char *str, size_t n, mpz_str_conv_t *conv) {
+    if (n < MPZ_STR_PARSE_THRESHOLD * conv->nchars) {
+        mpz_need_dig(z, n / conv->nchars + 1);
+        mpz_set_from_str_basecase(z, str, n, conv->base, conv->nchars);
+        return;
+    }
+
+    size_t k = 0;
+    while (k + 1 < MPZ_STR_MAX_POW && (conv->nchars << (k + 1)) < n) {
+        k += 1;
+    }
+    size_t lo_n = conv->nchars << k;
+
+    mpz_t hi, lo;
+    mpz_init_zero(&hi);
+    mpz_init_zero(&lo);
+    mpz_set_from_str_divconq(&hi, str, n - lo_n, conv);
+    mpz_set_from_str_divconq(&lo, str + n - lo_n, lo_n, conv);
+    mpz_mul_inpl(z, &hi, mpz_str_conv_pow(conv, k));
+    mpz_add_inpl(z, z, &lo);
+    mpz_deinit(&hi);
+    mpz_deinit(&lo);
+}
+#endif
+
 // returns number of bytes from str that were processed
 size_t mpz_set_from_str(mpz_t *z, const char *str, size_t len, bool neg, unsigned int base) {
     assert(base <= 36);
 
-    const char *cur = str;
-    const char *top = str + len;
-
-    mpz_need_dig(z, len * 8 / DIG_SIZE + 1);
+    // find the extent of the digits
+    size_t n = 0;
+    while (n < len && mpz_str_char_value(str[n]) < base) {
+        ++n;
+    }
+
+    unsigned int bits = mpz_str_pow2_bits(base);
+    size_t nchars;
+    mpz_str_chunk(base, &nchars);
+    #if MICROPY_OPT_MPZ_DIVCONQ_STR && MICROPY_OPT_MPZ_KARATSUBA
+    if (bits == 0 && n >= MPZ_STR_PARSE_THRESHOLD * nchars) {
+        mpz_str_conv_t conv;
+        mpz_str_conv_init(&conv, base, 'a');
+        mpz_set_from_str_divconq(z, str, n, &conv);
+        mpz_str_conv_deinit(&conv);
+    } else
+    #endif
+    {
+        mpz_need_dig(z, n * 8 / DIG_SIZE + 1);
+        if (bits != 0) {
+            mpz_set_from_str_pow2(z, str, n, bits);
+        } else {
+            mpz_set_from_str_basecase(z, str, n, base, nchars);
+        }
+    }
 
     if (neg) {
         z->neg = 1;
@@ -884,26 +1145,7 @@ size_t mpz_set_from_str(mpz_t *z, const char *str, size_t len, bool neg, unsigne
         z->neg = 0;
     }
 
-    z->len = 0;
-    for (; cur < top; ++cur) { // XXX UTF8 next char
-        //mp_uint_t v = char_to_numeric(cur#); // XXX UTF8 get char
-        mp_uint_t v = *cur;
-        if ('0' <= v && v <= '9') {
-            v -= '0';
-        } else if ('A' <= v && v <= 'Z') {
-            v -= 'A' - 10;
-        } else if ('a' <= v && v <= 'z') {
-            v -= 'a' - 10;
-        } else {
-            break;
-        }
-        if (v >= base) {
-            break;
-        }
-        z->len = mpn_mul_dig_add_dig(z->dig, z->len, base, v);
-    }
-
-    return cur - str;
+    return n;
 }
 
 void mpz_set_from_bytes(mpz_t *z, bool big_endian, size_t len, const byte *buf) {
@@ -1340,8 +1582,32 @@ void mpz_mul_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs) {
     }
 
     mpz_need_dig(dest, lhs->len + rhs->len); // min mem l+r-1, max mem l+r
-    memset(dest->dig, 0, dest->alloc * sizeof(mpz_dig_t));
-    dest->len = mpn_mul(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len);
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    if (lhs->len >= MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD && rhs->len >= MICROPY_OPT_MPZ_KARATSUBA_THRESHOLD) {
+        if (lhs->len < rhs->len) {
+            const mpz_t *t = lhs;
+            lhs = rhs;
+            rhs = t;
+        }
+        // take the scratch memory from the C stack if it's small enough, to
+        // save the cost of a heap allocation for each multiplication
+        mpz_dig_t stack_scratch[MPZ_KARATSUBA_STACK_DIGS];
+        mpz_dig_t *scratch = stack_scratch;
+        size_t scratch_len = mpn_mul_karatsuba_scratch(lhs->len, rhs->len);
+        if (scratch_len > MPZ_KARATSUBA_STACK_DIGS) {
+            scratch = m_new(mpz_dig_t, scratch_len);
+        }
+        mpn_mul_karatsuba(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len, scratch);
+        if (scratch != stack_scratch) {
+            m_del(mpz_dig_t, scratch, scratch_len);
+        }
+        dest->len = mpn_remove_trailing_zeros(dest->dig, dest->dig + lhs->len + rhs->len);
+    } else
+    #endif
+    {
+        memset(dest->dig, 0, dest->alloc * sizeof(mpz_dig_t));
+        dest->len = mpn_mul(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len);
+    }
 
     if (lhs->neg == rhs->neg) {
         dest->neg = 0;
@@ -1386,6 +1652,164 @@ void mpz_pow_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs) {
     mpz_free(n);
 }
 
+#if MICROPY_OPT_MPZ_MONTGOMERY
+
+/* compares i with j, both having exactly len digits
+   returns sign(i - j)
+*/
+STATIC int mpn_cmp_fixed(const mpz_dig_t *idig, const mpz_dig_t *jdig, size_t len) {
+    while (len-- > 0) {
+        if (idig[len] != jdig[len]) {
+            return idig[len] < jdig[len] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/* computes -m^-1 modulo DIG_BASE
+   assumes m is odd
+*/
+STATIC mpz_dig_t mpn_mont_inv(mpz_dig_t m) {
+    // Newton's iteration, each step doubles the number of correct low bits
+    mpz_dbl_dig_t inv = 1;
+    for (size_t bits = 1; bits < DIG_SIZE; bits *= 2) {
+        inv = (inv * (2 - (mpz_dbl_dig_t)m * inv)) & DIG_MASK;
+    }
+    return (0 - inv) & DIG_MASK;
+}
+
+/* computes i = j * k / B^mlen modulo m (Montgomery multiplication)
+   i, j, k have exactly mlen digits; assumes j, k < m; assumes m is odd and
+   minv = mpn_mont_inv(m[0]); assumes t has room for 2 * mlen + 1 digits,
+   plus the scratch needed by mpn_mul_karatsuba
+   can have i, j, k point to same memory
+*/
+STATIC void mpn_mont_mul(mpz_dig_t *idig, const mpz_dig_t *jdig, const mpz_dig_t *kdig,
+    const mpz_dig_t *mdig, size_t mlen, mpz_dig_t minv, mpz_dig_t *tdig) {
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    mpn_mul_karatsuba(tdig, jdig, mlen, kdig, mlen, tdig + 2 * mlen + 1);
+    #else
+    memset(tdig, 0, 2 * mlen * sizeof(mpz_dig_t));
+    mpn_mul(tdig, (mpz_dig_t*)jdig, mlen, (mpz_dig_t*)kdig, mlen);
+    #endif
+    tdig[2 * mlen] = 0;
+
+    // add multiples of m to t to clear its low digits one at a time
+    for (size_t i = 0; i < mlen; ++i) {
+        mpz_dbl_dig_t u = ((mpz_dbl_dig_t)tdig[i] * minv) & DIG_MASK;
+        mpz_dbl_dig_t carry = 0;
+        mpz_dig_t *td = tdig + i;
+        for (size_t j = 0; j < mlen; ++j, ++td) {
+            carry += (mpz_dbl_dig_t)*td + u * (mpz_dbl_dig_t)mdig[j]; // will never overflow so long as DIG_SIZE <= 8*sizeof(mpz_dbl_dig_t)/2
+            *td = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+        for (; carry != 0; ++td) {
+            carry += *td;
+            *td = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+    }
+
+    // the top mlen + 1 digits of t are now less than 2 * m
+    mpz_dig_t *rdig = tdig + mlen;
+    if (rdig[mlen] != 0 || mpn_cmp_fixed(rdig, mdig, mlen) >= 0) {
+        mpn_sub_inpl(rdig, mdig, mlen);
+    }
+    memcpy(idig, rdig, mlen * sizeof(mpz_dig_t));
+}
+
+// exponents are processed this many bits at a time by mpz_pow3_mont, which
+// keeps 2 ** (MPZ_POW3_WINDOW - 1) precomputed powers of the base
+#define MPZ_POW3_WINDOW (4)
+
+STATIC inline unsigned int mpn_get_bit(const mpz_dig_t *dig, size_t i) {
+    return (dig[i / DIG_SIZE] >> (i % DIG_SIZE)) & 1;
+}
+
+/* computes dest = (lhs ** rhs) % mod using Montgomery multiplication, which
+   avoids a long division after each step, and a sliding window over the bits
+   of rhs, which saves about 2/3 of the multiplications by the base
+   assumes mod is positive and odd; assumes rhs > 0
+   can have dest, lhs, rhs the same; mod can't be the same as dest
+*/
+STATIC void mpz_pow3_mont(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs, const mpz_t *mod) {
+    const size_t n_pow = 1 << (MPZ_POW3_WINDOW - 1);
+    size_t mlen = mod->len;
+    size_t buf_len = (n_pow + 1) * mlen + 2 * mlen + 1;
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    buf_len += mpn_mul_karatsuba_scratch(mlen, mlen);
+    #endif
+    mpz_dig_t *buf = m_new(mpz_dig_t, buf_len);
+    mpz_dig_t *pow_dig = buf; // lhs, lhs ** 3, ..., lhs ** (2 * n_pow - 1)
+    mpz_dig_t *adig = buf + n_pow * mlen;
+    mpz_dig_t *tdig = adig + mlen;
+    mpz_dig_t minv = mpn_mont_inv(mod->dig[0]);
+
+    // put lhs into Montgomery form, lhs * B^mlen % mod
+    {
+        mpz_t temp; mpz_init_zero(&temp);
+        mpz_t quo; mpz_init_zero(&quo);
+        mpz_shl_inpl(&temp, lhs, mlen * DIG_SIZE);
+        mpz_divmod_inpl(&quo, &temp, &temp, mod);
+        memset(pow_dig, 0, mlen * sizeof(mpz_dig_t));
+        memcpy(pow_dig, temp.dig, temp.len * sizeof(mpz_dig_t));
+        mpz_deinit(&quo);
+        mpz_deinit(&temp);
+    }
+
+    // compute the odd powers of lhs, using adig to hold lhs ** 2
+    mpn_mont_mul(adig, pow_dig, pow_dig, mod->dig, mlen, minv, tdig);
+    for (size_t i = 1; i < n_pow; ++i) {
+        mpn_mont_mul(pow_dig + i * mlen, pow_dig + (i - 1) * mlen, adig, mod->dig, mlen, minv, tdig);
+    }
+
+    // go through the bits of rhs from the top, squaring for each bit and
+    // multiplying in the power given by each window that starts and ends
+    // with a 1 bit
+    size_t n = mpz_max_num_bits(rhs);
+    bool first = true;
+    while (n > 0) {
+        if (!mpn_get_bit(rhs->dig, n - 1)) {
+            mpn_mont_mul(adig, adig, adig, mod->dig, mlen, minv, tdig);
+            --n;
+            continue;
+        }
+        size_t low = n > MPZ_POW3_WINDOW ? n - MPZ_POW3_WINDOW : 0;
+        while (!mpn_get_bit(rhs->dig, low)) {
+            ++low;
+        }
+        size_t window = 0;
+        for (size_t i = n; i-- > low;) {
+            window = window << 1 | mpn_get_bit(rhs->dig, i);
+            if (!first) {
+                mpn_mont_mul(adig, adig, adig, mod->dig, mlen, minv, tdig);
+            }
+        }
+        if (first) {
+            memcpy(adig, pow_dig + (window >> 1) * mlen, mlen * sizeof(mpz_dig_t));
+            first = false;
+        } else {
+            mpn_mont_mul(adig, adig, pow_dig + (window >> 1) * mlen, mod->dig, mlen, minv, tdig);
+        }
+        n = low;
+    }
+
+    // take the result out of Montgomery form by multiplying by 1
+    memset(pow_dig, 0, mlen * sizeof(mpz_dig_t));
+    pow_dig[0] = 1;
+    mpn_mont_mul(adig, adig, pow_dig, mod->dig, mlen, minv, tdig);
+
+    mpz_need_dig(dest, mlen);
+    memcpy(dest->dig, adig, mlen * sizeof(mpz_dig_t));
+    dest->len = mpn_remove_trailing_zeros(dest->dig, dest->dig + mlen);
+    dest->neg = 0;
+
+    m_del(mpz_dig_t, buf, buf_len);
+}
+
+#endif
+
 /* computes dest = (lhs ** rhs) % mod
    can have dest, lhs, rhs the same; mod can't be the same as dest
 */
@@ -1400,6 +1824,13 @@ void mpz_pow3_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs, const mpz_t
         return;
     }
 
+    #if MICROPY_OPT_MPZ_MONTGOMERY
+    if (mod->len >= 2 && !mod->neg && (mod->dig[0] & 1) != 0) {
+        mpz_pow3_mont(dest, lhs, rhs, mod);
+        return;
+    }
+    #endif
+
     mpz_t *x = mpz_clone(lhs);
     mpz_t *n = mpz_clone(rhs);
     mpz_t quo; mpz_init_zero(&quo);
@@ -1674,6 +2105,102 @@ char *mpz_as_str(const mpz_t *i, unsigned int base) {
 }
 #endif
 
+/* writes the characters of the number in dig, of length len, backwards so that
+   the last one is just before end, padded with zeros to width characters if
+   width is non-zero; takes nchars characters at a time by dividing by
+   chunk = base**nchars; destroys dig; returns a pointer to the first character
+*/
+STATIC char *mpn_as_str_basecase(char *end, mpz_dig_t *dig, size_t len, unsigned int base, char base_char, mpz_dig_t chunk, size_t nchars, size_t width) {
+    char *s = end;
+    do {
+        // compute next remainder
+        mpz_dbl_dig_t a = 0;
+        for (mpz_dig_t *d = dig + len; --d >= dig;) {
+            a = (a << DIG_SIZE) | *d;
+            *d = a / chunk;
+            a %= chunk;
+        }
+        len = mpn_remove_trailing_zeros(dig, dig + len);
+
+        // convert to characters, without leading zeros in the most significant chunk
+        for (size_t n = nchars; n > 0; --n) {
+            if (len == 0 && a == 0 && s != end) {
+                break;
+            }
+            unsigned int c = a % base + '0';
+            a /= base;
+            if (c > '9') {
+                c += base_char - '9' - 1;
+            }
+            *--s = c;
+        }
+    } while (len != 0);
+
+    while ((size_t)(end - s) < width) {
+        *--s = '0';
+    }
+
+    return s;
+}
+
+/* writes the characters of the number in dig, of length len, in the base
+   2**bits backwards so that the last one is just before end
+   returns a pointer to the first character
+*/
+STATIC char *mpn_as_str_pow2(char *end, const mpz_dig_t *dig, size_t len, unsigned int bits, char base_char) {
+    const mpz_dig_t *top = dig + len;
+    mpz_dbl_dig_t acc = 0;
+    int acc_bits = 0;
+    char *s = end;
+    do {
+        if (acc_bits < (int)bits && dig < top) {
+            acc |= (mpz_dbl_dig_t)*dig++ << acc_bits;
+            acc_bits += DIG_SIZE;
+        }
+        unsigned int c = (acc & ((1 << bits) - 1)) + '0';
+        acc >>= bits;
+        acc_bits -= bits;
+        if (c > '9') {
+            c += base_char - '9' - 1;
+        }
+        *--s = c;
+    } while (dig < top || acc != 0);
+    return s;
+}
+
+#if MICROPY_OPT_MPZ_DIVCONQ_STR
+/* writes the characters of z backwards so that the last one is just before
+   end, padded with zeros to width characters if width is non-zero; divides z
+   by the largest power of the base whose square has no more digits than z and
+   converts the remainder (padded) and the quotient separately
+   returns a pointer to the first character
+*/
+STATIC char *mpz_as_str_divconq(char *end, const mpz_t *z, mpz_str_conv_t *conv, size_t width) {
+    if (z->len < MICROPY_OPT_MPZ_DIVCONQ_STR_THRESHOLD) {
+        mpz_dig_t dig[MICROPY_OPT_MPZ_DIVCONQ_STR_THRESHOLD];
+        memcpy(dig, z->dig, z->len * sizeof(mpz_dig_t));
+        return mpn_as_str_basecase(end, dig, z->len, conv->base, conv->base_char, conv->chunk, conv->nchars, width);
+    }
+
+    size_t k = 0;
+    while (k + 1 < MPZ_STR_MAX_POW && 2 * (2 * conv->pow[k].len - 1) <= z->len + 1
+        && 2 * mpz_str_conv_pow(conv, k + 1)->len <= z->len + 1) {
+        k += 1;
+    }
+    size_t lo_width = conv->nchars << k;
+
+    mpz_t quo, rem;
+    mpz_init_zero(&quo);
+    mpz_init_zero(&rem);
+    mpz_divmod_inpl(&quo, &rem, z, &conv->pow[k]);
+    end = mpz_as_str_divconq(end, &rem, conv, lo_width);
+    mpz_deinit(&rem);
+    end = mpz_as_str_divconq(end, &quo, conv, width == 0 ? 0 : width - lo_width);
+    mpz_deinit(&quo);
+    return end;
+}
+#endif
+
 // assumes enough space as calculated by mp_int_format_size
 // returns length of string, not including null byte
 size_t mpz_as_str_inpl(const mpz_t *i, unsigned int base, const char *prefix, char base_char, char comma, char *str) {
@@ -1688,75 +2215,66 @@ size_t mpz_as_str_inpl(const mpz_t *i, unsigned int base, const char *prefix, ch
     size_t ilen = i->len;
 
     char *s = str;
+    if (ilen != 0 && i->neg != 0) {
+        *s++ = '-';
+    }
+    if (prefix) {
+        while (*prefix)
+            *s++ = *prefix++;
+    }
     if (ilen == 0) {
-        if (prefix) {
-            while (*prefix)
-                *s++ = *prefix++;
-        }
         *s++ = '0';
         *s = '\0';
         return s - str;
     }
 
-    // make a copy of mpz digits, so we can do the div/mod calculation
-    mpz_dig_t *dig = m_new(mpz_dig_t, ilen);
-    memcpy(dig, i->dig, ilen * sizeof(mpz_dig_t));
-
-    // convert
-    char *last_comma = str;
-    bool done;
-    do {
-        mpz_dig_t *d = dig + ilen;
-        mpz_dbl_dig_t a = 0;
-
-        // compute next remainder
-        while (--d >= dig) {
-            a = (a << DIG_SIZE) | *d;
-            *d = a / base;
-            a %= base;
-        }
-
-        // convert to character
-        a += '0';
-        if (a > '9') {
-            a += base_char - '9' - 1;
-        }
-        *s++ = a;
-
-        // check if number is zero
-        done = true;
-        for (d = dig; d < dig + ilen; ++d) {
-            if (*d != 0) {
-                done = false;
-                break;
-            }
-        }
-        if (comma && (s - last_comma) == 3) {
-            *s++ = comma;
-            last_comma = s;
-        }
-    }
-    while (!done);
-
-    // free the copy of the digits array
-    m_del(mpz_dig_t, dig, ilen);
-
-    if (prefix) {
-        const char *p = &prefix[strlen(prefix)];
-        while (p > prefix) {
-            *s++ = *--p;
+    // the characters are written backwards from the end of the space that
+    // mp_int_format_size reserves for them, then moved into place
+    unsigned int log_base2_floor = 0;
+    for (unsigned int b = base; b > 1; b >>= 1) {
+        log_base2_floor += 1;
+    }
+    char *end = s + ilen * DIG_SIZE / log_base2_floor + 1;
+    char *start;
+
+    unsigned int bits = mpz_str_pow2_bits(base);
+    if (bits != 0) {
+        start = mpn_as_str_pow2(end, i->dig, ilen, bits, base_char);
+    #if MICROPY_OPT_MPZ_DIVCONQ_STR
+    } else if (ilen >= MICROPY_OPT_MPZ_DIVCONQ_STR_THRESHOLD) {
+        // the magnitude of i, sharing its digits
+        mpz_t i_abs = *i;
+        i_abs.neg = 0;
+        mpz_str_conv_t conv;
+        mpz_str_conv_init(&conv, base, base_char);
+        start = mpz_as_str_divconq(end, &i_abs, &conv, 0);
+        mpz_str_conv_deinit(&conv);
+    #endif
+    } else {
+        // make a copy of mpz digits, so we can do the div/mod calculation
+        mpz_dig_t *dig = m_new(mpz_dig_t, ilen);
+        memcpy(dig, i->dig, ilen * sizeof(mpz_dig_t));
+        size_t nchars;
+        mpz_dig_t chunk = mpz_str_chunk(base, &nchars);
+        start = mpn_as_str_basecase(end, dig, ilen, base, base_char, chunk, nchars, 0);
+        m_del(mpz_dig_t, dig, ilen);
+    }
+
+    size_t n = end - start;
+    memmove(s, start, n);
+    s += n;
+
+    if (comma) {
+        // spread the characters out from the right to make room for the commas
+        char *src = s;
+        s += (n - 1) / 3;
+        for (char *dest = s; dest != src;) {
+            *--dest = *--src;
+            *--dest = *--src;
+            *--dest = *--src;
+            *--dest = comma;
         }
     }
-    if (i->neg != 0) {
-        *s++ = '-';
-    }
-
-    // reverse string
-    for (char *u = str, *v = s - 1; u < v; ++u, --v) {
-        char temp = *u;
-        *u = *v;
-        *v = temp;
-    }
 
     *s = '\0'; // null termination
 
@@ -34,6 +34,7 @@
 #include "py/objint.h"
 #include "py/objstr.h"
 #include "py/runtime.h"
+#include "py/gc.h"
 #include "py/stackctrl.h"
 #include "py/stream.h" // for mp_obj_print
 
@@ -415,7 +416,12 @@ mp_obj_t mp_obj_id(mp_obj_t o_in) {
     mp_int_t id = (mp_int_t)o_in;
     if (!MP_OBJ_IS_OBJ(o_in)) {
         return mp_obj_new_int(id);
-    } else if (id >= 0) {
+    }
+    #if MICROPY_GC_COMPACT
+    // the id must stay the same for the lifetime of the object
+    gc_pin(MP_OBJ_TO_PTR(o_in));
+    #endif
+    if (id >= 0) {
         // Many OSes and CPUs have affinity for putting "user" memories
         // into low half of address space, and "system" into upper half.
         // We're going to take advantage of that and return small int
@@ -355,10 +355,12 @@ typedef struct _mp_rom_map_elem_t {
 // this would save 1 ROM word for all ROM objects that have a locals_dict
 // would also need a trucated dict structure
 
+// A map that isn't ordered is a hash table, but still keeps its elements in
+// table[] in the order they were added; see map.c for its layout.
 typedef struct _mp_map_t {
     size_t all_keys_are_qstrs : 1;
     size_t is_fixed : 1;    // a fixed array that can't be modified; must also be ordered
-    size_t is_ordered : 1;  // an ordered array
+    size_t is_ordered : 1;  // an ordered array, searched linearly
     size_t used : (8 * sizeof(size_t) - 3);
     size_t alloc;
     mp_map_elem_t *table;
@@ -771,6 +773,7 @@ size_t mp_obj_dict_len(mp_obj_t self_in);
 mp_obj_t mp_obj_dict_get(mp_obj_t self_in, mp_obj_t index);
 mp_obj_t mp_obj_dict_store(mp_obj_t self_in, mp_obj_t key, mp_obj_t value);
 mp_obj_t mp_obj_dict_delete(mp_obj_t self_in, mp_obj_t key);
+mp_obj_t mp_obj_dict_copy(mp_obj_t self_in);
 mp_map_t *mp_obj_dict_get_map(mp_obj_t self_in);
 
 // set
@@ -779,6 +782,11 @@ void mp_obj_set_store(mp_obj_t self_in, mp_obj_t item);
 // slice
 void mp_obj_slice_get(mp_obj_t self_in, mp_obj_t *start, mp_obj_t *stop, mp_obj_t *step);
 
+// range
+#if MICROPY_OPT_QUICKEN_BYTECODE
+mp_obj_t mp_obj_range_it_iternext(mp_obj_t it_in);
+#endif
+
 // functions
 
 typedef struct _mp_obj_fun_builtin_fixed_t {
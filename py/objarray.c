@@ -103,7 +103,12 @@ STATIC mp_obj_array_t *array_new(char typecode, size_t n) {
     o->typecode = typecode;
     o->free = 0;
     o->len = n;
-    o->items = m_new(byte, typecode_size * o->len);
+    if (typecode == 'O' || typecode == 'P' || typecode == 'S') {
+        o->items = m_new(byte, typecode_size * o->len);
+    } else {
+        // numeric items never point into the heap
+        o->items = m_new_leaf(byte, typecode_size * o->len);
+    }
     return o;
 }
 #endif
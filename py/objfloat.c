@@ -123,7 +123,13 @@ STATIC void float_print(const mp_print_t *print, mp_obj_t o_in, mp_print_kind_t
     char buf[32];
     const int precision = 16;
 #endif
-    mp_format_float(o_val, buf, sizeof(buf), 'g', precision, '\0');
+    #if MICROPY_FLOAT_FAST_CONV && MICROPY_OBJ_REPR != MICROPY_OBJ_REPR_C
+    // shortest representation that reads back to the same value
+    const char fmt = 'r';
+    #else
+    const char fmt = 'g';
+    #endif
+    mp_format_float(o_val, buf, sizeof(buf), fmt, precision, '\0');
     mp_print_str(print, buf);
     if (strchr(buf, '.') == NULL && strchr(buf, 'e') == NULL && strchr(buf, 'n') == NULL) {
         // Python floats always have decimal point (unless inf or nan)
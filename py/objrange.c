@@ -57,6 +57,17 @@ STATIC const mp_obj_type_t range_it_type = {
     .iternext = range_it_iternext,
 };
 
+#if MICROPY_OPT_QUICKEN_BYTECODE
+// Used by the VM to step a range iterator in a for loop.  Returns MP_OBJ_NULL
+// if it_in is not a range iterator.
+mp_obj_t mp_obj_range_it_iternext(mp_obj_t it_in) {
+    if (!MP_OBJ_IS_TYPE(it_in, &range_it_type)) {
+        return MP_OBJ_NULL;
+    }
+    return range_it_iternext(it_in);
+}
+#endif
+
 STATIC mp_obj_t mp_obj_new_range_iterator(mp_int_t cur, mp_int_t stop, mp_int_t step, mp_obj_iter_buf_t *iter_buf) {
     assert(sizeof(mp_obj_range_it_t) <= sizeof(mp_obj_iter_buf_t));
     mp_obj_range_it_t *o = (mp_obj_range_it_t*)iter_buf;
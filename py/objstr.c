@@ -258,28 +258,84 @@ wrong_args:
     mp_raise_TypeError("wrong number of arguments");
 }
 
+// Haystacks shorter than this are searched without building a skip table
+#define FIND_SUBBYTES_SKIP_TABLE_MIN (256)
+
 // like strstr but with specified length and allows \0 bytes
-// TODO replace with something more efficient/standard
+// If direction is positive it finds the first occurrence, otherwise the last.
+// A single byte is searched for with memchr, short haystacks are searched by
+// comparing the needle at each offset that matches its first byte, and longer
+// ones use Boyer-Moore-Horspool, keyed on the last (or, when searching
+// backwards, the first) byte of the needle compared at each offset.
 const byte *find_subbytes(const byte *haystack, size_t hlen, const byte *needle, size_t nlen, int direction) {
-    if (hlen >= nlen) {
-        size_t str_index, str_index_end;
-        if (direction > 0) {
-            str_index = 0;
-            str_index_end = hlen - nlen;
-        } else {
-            str_index = hlen - nlen;
-            str_index_end = 0;
+    if (hlen < nlen) {
+        return NULL;
+    }
+    if (nlen == 0) {
+        return direction > 0 ? haystack : haystack + hlen;
+    }
+
+    if (direction > 0) {
+        if (nlen == 1) {
+            return memchr(haystack, needle[0], hlen);
+        }
+        const byte *top = haystack + hlen - nlen;
+        if (hlen < FIND_SUBBYTES_SKIP_TABLE_MIN) {
+            for (const byte *p = haystack; p <= top; p++) {
+                p = memchr(p, needle[0], top - p + 1);
+                if (p == NULL) {
+                    break;
+                }
+                if (memcmp(p + 1, needle + 1, nlen - 1) == 0) {
+                    return p;
+                }
+            }
+            return NULL;
+        }
+        // how far the needle can move on from an offset where the byte under
+        // its last position is c; capped so the table fits in bytes
+        byte skip[256];
+        memset(skip, MIN(nlen, 255), sizeof(skip));
+        for (size_t i = 0; i < nlen - 1; i++) {
+            skip[needle[i]] = MIN(nlen - 1 - i, 255);
+        }
+        byte last = needle[nlen - 1];
+        for (const byte *p = haystack; p <= top;) {
+            byte c = p[nlen - 1];
+            if (c == last && memcmp(p, needle, nlen - 1) == 0) {
+                return p;
+            }
+            p += skip[c];
+        }
+    } else {
+        const byte *p = haystack + hlen - nlen;
+        if (nlen == 1 || hlen < FIND_SUBBYTES_SKIP_TABLE_MIN) {
+            for (;; p--) {
+                if (*p == needle[0] && memcmp(p + 1, needle + 1, nlen - 1) == 0) {
+                    return p;
+                }
+                if (p == haystack) {
+                    break;
+                }
+            }
+            return NULL;
         }
+        // as above, with the needle moving back from the byte under its first position
+        byte skip[256];
+        memset(skip, MIN(nlen, 255), sizeof(skip));
+        for (size_t i = nlen - 1; i > 0; i--) {
+            skip[needle[i]] = MIN(i, 255);
+        }
+        byte first = needle[0];
         for (;;) {
-            if (memcmp(&haystack[str_index], needle, nlen) == 0) {
-                //found
-                return haystack + str_index;
+            byte c = *p;
+            if (c == first && memcmp(p + 1, needle + 1, nlen - 1) == 0) {
+                return p;
             }
-            if (str_index == str_index_end) {
-                //not found
+            if ((size_t)(p - haystack) < skip[c]) {
                 break;
             }
-            str_index += direction;
+            p -= skip[c];
         }
     }
     return NULL;
@@ -288,6 +344,68 @@ const byte *find_subbytes(const byte *haystack, size_t hlen, const byte *needle,
 // Note: this function is used to check if an object is a str or bytes, which
 // works because both those types use it as their binary_op method.  Revisit
 // MP_OBJ_IS_STR_OR_BYTES if this fact changes.
+#if MICROPY_OPT_STR_INPLACE_ADD
+// Results of += shorter than this are made the normal way, and may be interned
+#define STR_INPLACE_ADD_MIN_LEN (32)
+
+#if MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL
+#define STR_APPEND_ENTER() mp_thread_mutex_lock(&MP_STATE_VM(str_append_mutex), 1)
+#define STR_APPEND_EXIT() mp_thread_mutex_unlock(&MP_STATE_VM(str_append_mutex))
+#else
+#define STR_APPEND_ENTER()
+#define STR_APPEND_EXIT()
+#endif
+
+// Implements lhs += rhs for long str/bytes.  The result gets a buffer with
+// spare room at the end, and is remembered in the str_append_xxx VM state.
+// If lhs is that most recent result then rhs is appended straight into the
+// spare room and the new object shares the buffer with lhs.  This is safe
+// without knowing whether lhs is referenced elsewhere because every object
+// using the buffer only sees its own prefix of the data, which never changes;
+// the only visible effect is that they lose their null terminator, which
+// mp_obj_str_get_str accounts for.  The result's hash is computed lazily.
+// Without a GIL the check and the append are done under str_append_mutex, so
+// two threads can't both append to the same object's buffer.
+STATIC mp_obj_t str_inplace_add(const mp_obj_type_t *type, mp_obj_t lhs_in, const byte *rhs_data, size_t rhs_len) {
+    GET_STR_DATA_LEN(lhs_in, lhs_data, lhs_len);
+    size_t len = lhs_len + rhs_len;
+    byte *data = NULL;
+    STR_APPEND_ENTER();
+    if (lhs_data == MP_STATE_VM(str_append_buf) && lhs_len == MP_STATE_VM(str_append_len)
+        && len < MP_STATE_VM(str_append_alloc)) {
+        // lhs is the most recent user of the buffer and there is room for rhs;
+        // rhs can't overlap the free part of the buffer so memcpy is fine
+        data = (byte*)lhs_data;
+        memcpy(data + lhs_len, rhs_data, rhs_len);
+        data[len] = '\0';
+        MP_STATE_VM(str_append_len) = len;
+    }
+    STR_APPEND_EXIT();
+    if (data == NULL) {
+        // make a new buffer, over-allocated by half so that the cost of
+        // repeated appends is amortised linear; this is done without the
+        // mutex held because the allocation may raise
+        size_t alloc = len + len / 2 + 1;
+        data = m_new_leaf(byte, alloc);
+        memcpy(data, lhs_data, lhs_len);
+        memcpy(data + lhs_len, rhs_data, rhs_len);
+        data[len] = '\0';
+        STR_APPEND_ENTER();
+        MP_STATE_VM(str_append_buf) = data;
+        MP_STATE_VM(str_append_alloc) = alloc;
+        MP_STATE_VM(str_append_len) = len;
+        STR_APPEND_EXIT();
+    }
+
+    mp_obj_str_t *o = m_new_obj(mp_obj_str_t);
+    o->base.type = type;
+    o->hash = 0;
+    o->len = len;
+    o->data = data;
+    return MP_OBJ_FROM_PTR(o);
+}
+#endif
+
 mp_obj_t mp_obj_str_binary_op(mp_binary_op_t op, mp_obj_t lhs_in, mp_obj_t rhs_in) {
     // check for modulo
     if (op == MP_BINARY_OP_MODULO) {
@@ -370,6 +488,12 @@ mp_obj_t mp_obj_str_binary_op(mp_binary_op_t op, mp_obj_t lhs_in, mp_obj_t rhs_i
                 return lhs_in;
             }
 
+            #if MICROPY_OPT_STR_INPLACE_ADD
+            if (op == MP_BINARY_OP_INPLACE_ADD && lhs_len + rhs_len >= STR_INPLACE_ADD_MIN_LEN) {
+                return str_inplace_add(lhs_type, lhs_in, rhs_data, rhs_len);
+            }
+            #endif
+
             vstr_t vstr;
             vstr_init_len(&vstr, lhs_len + rhs_len);
             memcpy(vstr.buf, lhs_data, lhs_len);
@@ -462,6 +586,11 @@ STATIC mp_obj_t str_join(mp_obj_t self_in, mp_obj_t arg) {
         required_len += l;
     }
 
+    // a single item is returned as-is, there is nothing to join
+    if (seq_len == 1) {
+        return seq_items[0];
+    }
+
     // make joined string
     vstr_t vstr;
     vstr_init_len(&vstr, required_len);
@@ -533,14 +662,8 @@ mp_obj_t mp_obj_str_split(size_t n_args, const mp_obj_t *args) {
 
         for (;;) {
             const byte *start = s;
-            for (;;) {
-                if (splits == 0 || s + sep_len > top) {
-                    s = top;
-                    break;
-                } else if (memcmp(s, sep_str, sep_len) == 0) {
-                    break;
-                }
-                s++;
+            if (splits == 0 || (s = find_subbytes(s, top - s, (const byte*)sep_str, sep_len, 1)) == NULL) {
+                s = top;
             }
             mp_obj_list_append(res, mp_obj_new_str_of_type(self_type, start, s - start));
             if (s >= top) {
@@ -639,16 +762,10 @@ STATIC mp_obj_t str_rsplit(size_t n_args, const mp_obj_t *args) {
         const byte *beg = s;
         const byte *last = s + len;
         for (;;) {
-            s = last - sep_len;
-            for (;;) {
-                if (splits == 0 || s < beg) {
-                    break;
-                } else if (memcmp(s, sep_str, sep_len) == 0) {
-                    break;
-                }
-                s--;
+            if (splits != 0) {
+                s = find_subbytes(beg, last - beg, (const byte*)sep_str, sep_len, -1);
             }
-            if (s < beg || splits == 0) {
+            if (splits == 0 || s == NULL) {
                 res->items[idx] = mp_obj_new_str_of_type(self_type, beg, last - beg);
                 break;
             }
@@ -924,9 +1041,18 @@ STATIC NORETURN void terse_str_format_value_error(void) {
 STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *arg_i, size_t n_args, const mp_obj_t *args, mp_map_t *kwargs) {
     vstr_t vstr;
     mp_print_t print;
-    vstr_init_print(&vstr, 16, &print);
+    vstr_init_print(&vstr, top - str + 16, &print);
 
     for (; str < top; str++) {
+        if (*str != '{' && *str != '}') {
+            // copy a run of literal characters in one go
+            const char *run = str;
+            while (str + 1 < top && str[1] != '{' && str[1] != '}') {
+                str++;
+            }
+            vstr_add_strn(&vstr, run, str + 1 - run);
+            continue;
+        }
         if (*str == '}') {
             str++;
             if (str < top && *str == '}') {
@@ -939,10 +1065,6 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
                 mp_raise_ValueError("single '}' encountered in format string");
             }
         }
-        if (*str != '{') {
-            vstr_add_byte(&vstr, *str);
-            continue;
-        }
 
         str++;
         if (str < top && *str == '{') {
@@ -1071,8 +1193,11 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
             arg = args[(*arg_i) + 1];
             (*arg_i)++;
         }
-        if (!format_spec && !conversion) {
-            conversion = 's';
+        if (!format_spec) {
+            // without a format spec the arg is printed as-is, so print it
+            // straight into the result rather than via a temporary str
+            mp_obj_print_helper(&print, arg, conversion == 'r' ? PRINT_REPR : PRINT_STR);
+            continue;
         }
         if (conversion) {
             mp_print_kind_t print_kind;
@@ -1107,11 +1232,25 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
             // precision   ::=  integer
             // type        ::=  "b" | "c" | "d" | "e" | "E" | "f" | "F" | "g" | "G" | "n" | "o" | "s" | "x" | "X" | "%"
 
-            // recursively call the formatter to format any nested specifiers
-            MP_STACK_CHECK();
-            vstr_t format_spec_vstr = mp_obj_str_format_helper(format_spec, str, arg_i, n_args, args, kwargs);
-            const char *s = vstr_null_terminated_str(&format_spec_vstr);
-            const char *stop = s + format_spec_vstr.len;
+            // recursively call the formatter to format any nested specifiers,
+            // otherwise parse a null-terminated copy of the spec on the stack
+            vstr_t format_spec_vstr;
+            char format_spec_buf[16];
+            size_t format_spec_len = str - format_spec;
+            const char *s;
+            const char *stop;
+            if (format_spec_len < sizeof(format_spec_buf) && memchr(format_spec, '{', format_spec_len) == NULL) {
+                format_spec_vstr.buf = NULL;
+                memcpy(format_spec_buf, format_spec, format_spec_len);
+                format_spec_buf[format_spec_len] = '\0';
+                s = format_spec_buf;
+                stop = s + format_spec_len;
+            } else {
+                MP_STACK_CHECK();
+                format_spec_vstr = mp_obj_str_format_helper(format_spec, str, arg_i, n_args, args, kwargs);
+                s = vstr_null_terminated_str(&format_spec_vstr);
+                stop = s + format_spec_vstr.len;
+            }
             if (isalignment(*s)) {
                 align = *s++;
             } else if (*s && isalignment(s[1])) {
@@ -1157,7 +1296,9 @@ STATIC vstr_t mp_obj_str_format_helper(const char *str, const char *top, int *ar
                     mp_raise_ValueError("invalid format specifier");
                 }
             }
-            vstr_clear(&format_spec_vstr);
+            if (format_spec_vstr.buf != NULL) {
+                vstr_clear(&format_spec_vstr);
+            }
         }
         if (!align) {
             if (arg_looks_numeric(arg)) {
@@ -1379,12 +1520,19 @@ STATIC mp_obj_t str_modulo_format(mp_obj_t pattern, size_t n_args, const mp_obj_
     size_t arg_i = 0;
     vstr_t vstr;
     mp_print_t print;
-    vstr_init_print(&vstr, 16, &print);
+    vstr_init_print(&vstr, len + 16, &print);
 
     for (const byte *top = str + len; str < top; str++) {
         mp_obj_t arg = MP_OBJ_NULL;
         if (*str != '%') {
-            vstr_add_byte(&vstr, *str);
+            // copy a run of literal characters in one go
+            const byte *run = str;
+            str = memchr(str, '%', top - str);
+            if (str == NULL) {
+                str = top;
+            }
+            vstr_add_strn(&vstr, (const char*)run, str - run);
+            str--;
             continue;
         }
         if (++str >= top) {
@@ -1521,15 +1669,20 @@ not_enough_args:
             case 'r':
             case 's':
             {
-                vstr_t arg_vstr;
-                mp_print_t arg_print;
-                vstr_init_print(&arg_vstr, 16, &arg_print);
                 mp_print_kind_t print_kind = (*str == 'r' ? PRINT_REPR : PRINT_STR);
                 if (print_kind == PRINT_STR && is_bytes && MP_OBJ_IS_TYPE(arg, &mp_type_bytes)) {
                     // If we have something like b"%s" % b"1", bytes arg should be
                     // printed undecorated.
                     print_kind = PRINT_RAW;
                 }
+                if (width == 0 && prec < 0) {
+                    // no padding or truncation so print straight into the result
+                    mp_obj_print_helper(&print, arg, print_kind);
+                    break;
+                }
+                vstr_t arg_vstr;
+                mp_print_t arg_print;
+                vstr_init_print(&arg_vstr, 16, &arg_print);
                 mp_obj_print_helper(&arg_print, arg, print_kind);
                 uint vlen = arg_vstr.len;
                 if (prec < 0) {
@@ -1700,15 +1853,12 @@ STATIC mp_obj_t str_count(size_t n_args, const mp_obj_t *args) {
         return MP_OBJ_NEW_SMALL_INT(unichar_charlen((const char*)start, end - start) + 1);
     }
 
-    // count the occurrences
+    // count the occurrences; a match in a str is always at a character boundary
     mp_int_t num_occurrences = 0;
-    for (const byte *haystack_ptr = start; haystack_ptr + needle_len <= end;) {
-        if (memcmp(haystack_ptr, needle, needle_len) == 0) {
-            num_occurrences++;
-            haystack_ptr += needle_len;
-        } else {
-            haystack_ptr = utf8_next_char(haystack_ptr);
-        }
+    for (const byte *haystack_ptr = start;
+        (haystack_ptr = find_subbytes(haystack_ptr, end - haystack_ptr, needle, needle_len, 1)) != NULL;
+        haystack_ptr += needle_len) {
+        num_occurrences++;
     }
 
     return MP_OBJ_NEW_SMALL_INT(num_occurrences);
@@ -1983,7 +2133,7 @@ mp_obj_t mp_obj_new_str_of_type(const mp_obj_type_t *type, const byte* data, siz
     o->len = len;
     if (data) {
         o->hash = qstr_compute_hash(data, len);
-        byte *p = m_new(byte, len + 1);
+        byte *p = m_new_leaf(byte, len + 1);
         o->data = p;
         memcpy(p, data, len * sizeof(byte));
         p[len] = '\0'; // for now we add null for compatibility with C ASCIIZ strings
@@ -1995,8 +2145,9 @@ mp_obj_t mp_obj_new_str_of_type(const mp_obj_type_t *type, const byte* data, siz
 // the exact length required and then reused for the str/bytes object.  The vstr
 // is cleared and can safely be passed to vstr_free if it was heap allocated.
 mp_obj_t mp_obj_new_str_from_vstr(const mp_obj_type_t *type, vstr_t *vstr) {
-    // if not a bytes object, look if a qstr with this data already exists
-    if (type == &mp_type_str) {
+    // if not a bytes object, look if a qstr with this data already exists;
+    // a qstr can't be as long as 1 << (8 * MICROPY_QSTR_BYTES_IN_LEN) bytes
+    if (type == &mp_type_str && vstr->len < (1 << (8 * MICROPY_QSTR_BYTES_IN_LEN))) {
         qstr q = qstr_find_strn(vstr->buf, vstr->len);
         if (q != MP_QSTR_NULL) {
             vstr_clear(vstr);
@@ -2094,7 +2245,29 @@ qstr mp_obj_str_get_qstr(mp_obj_t self_in) {
 const char *mp_obj_str_get_str(mp_obj_t self_in) {
     if (MP_OBJ_IS_STR_OR_BYTES(self_in)) {
         GET_STR_DATA_LEN(self_in, s, l);
+        #if MICROPY_OPT_STR_INPLACE_ADD
+        // If the data is the buffer += appends to then stop further appends,
+        // which would overwrite the terminator while the caller uses it
+        STR_APPEND_ENTER();
+        if (s == MP_STATE_VM(str_append_buf)) {
+            MP_STATE_VM(str_append_buf) = NULL;
+        }
+        bool terminated = s[l] == '\0';
+        STR_APPEND_EXIT();
+        if (!terminated) {
+            // data shares a buffer that has since been appended to by +=, so
+            // give the object its own terminated copy.  This is the only case
+            // in which this function allocates, and it happens at most once
+            // per object; with the heap locked it raises MemoryError.
+            byte *p = m_new_leaf(byte, l + 1);
+            memcpy(p, s, l);
+            p[l] = '\0';
+            ((mp_obj_str_t*)MP_OBJ_TO_PTR(self_in))->data = p;
+            return (const char*)p;
+        }
+        #else
         (void)l; // len unused
+        #endif
         return (const char*)s;
     } else {
         bad_implicit_conversion(self_in);
@@ -528,7 +528,31 @@ retry:;
     return res;
 }
 
-STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
+#if MICROPY_OPT_ATTR_INLINE_CACHE
+STATIC void instance_attr_cache_store(struct _mp_attr_cache_entry_t **cache, mp_obj_t self_in, size_t version, qstr attr, const mp_obj_t *dest) {
+    // only cache lookups that are a pure function of the type and attr, which
+    // excludes types with a native base because they can use the sub-object
+    const mp_obj_type_t *type = mp_obj_get_type(self_in);
+    const mp_obj_type_t *native_base;
+    if (instance_count_native_bases(type, &native_base) != 0) {
+        return;
+    }
+    mp_attr_cache_entry_t *e = m_new_obj_maybe(mp_attr_cache_entry_t);
+    if (e == NULL) {
+        return;
+    }
+    e->type = type;
+    e->version = version;
+    e->attr = attr;
+    e->dest[0] = dest[0];
+    e->dest[1] = dest[1] == self_in ? MP_OBJ_SENTINEL : dest[1];
+    // most recently used entry goes first
+    cache[1] = cache[0];
+    cache[0] = e;
+}
+#endif
+
+STATIC void instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest, struct _mp_attr_cache_entry_t **cache) {
     // logic: look in instance members then class locals
     assert(mp_obj_is_instance_type(mp_obj_get_type(self_in)));
     mp_obj_instance_t *self = MP_OBJ_TO_PTR(self_in);
@@ -540,6 +564,24 @@ STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *des
         dest[0] = elem->value;
         return;
     }
+
+    #if MICROPY_OPT_ATTR_INLINE_CACHE
+    // read the version before the lookup so that an entry made stale by code
+    // run during the lookup (eg a __get__) is never used
+    size_t version = MP_STATE_VM(attr_cache_version);
+    if (cache != NULL) {
+        for (size_t i = 0; i < 2; ++i) {
+            const mp_attr_cache_entry_t *e = cache[i];
+            if (e != NULL && e->type == self->base.type && e->attr == attr && e->version == version) {
+                dest[0] = e->dest[0];
+                dest[1] = e->dest[1] == MP_OBJ_SENTINEL ? self_in : e->dest[1];
+                return;
+            }
+        }
+    }
+    #else
+    (void)cache;
+    #endif
 #if MICROPY_CPYTHON_COMPAT
     if (attr == MP_QSTR___dict__) {
         // Create a new dict with a copy of the instance's map items.
@@ -596,6 +638,13 @@ STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *des
             attr_get_method[2] = self_in;
             attr_get_method[3] = MP_OBJ_FROM_PTR(mp_obj_get_type(self_in));
             dest[0] = mp_call_method_n_kw(2, 0, attr_get_method);
+            return;
+        }
+        #endif
+
+        #if MICROPY_OPT_ATTR_INLINE_CACHE
+        if (cache != NULL) {
+            instance_attr_cache_store(cache, self_in, version, attr, dest);
         }
         #endif
         return;
@@ -624,6 +673,37 @@ STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *des
     }
 }
 
+STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
+    instance_load_attr(self_in, attr, dest, NULL);
+}
+
+#if MICROPY_OPT_ATTR_INLINE_CACHE
+void mp_obj_instance_load_method_cached(mp_obj_t self_in, qstr attr, mp_obj_t *dest, mp_attr_cache_entry_t **cache) {
+    if (attr == MP_QSTR___class__ || attr == MP_QSTR___next__) {
+        // these are handled specially by mp_load_method
+        mp_load_method(self_in, attr, dest);
+        return;
+    }
+    dest[0] = MP_OBJ_NULL;
+    dest[1] = MP_OBJ_NULL;
+    instance_load_attr(self_in, attr, dest, cache);
+    if (dest[0] == MP_OBJ_NULL) {
+        // not found; let mp_load_method raise the AttributeError
+        mp_load_method(self_in, attr, dest);
+    }
+}
+
+mp_obj_t mp_obj_instance_load_attr_cached(mp_obj_t self_in, qstr attr, mp_attr_cache_entry_t **cache) {
+    mp_obj_t dest[2];
+    mp_obj_instance_load_method_cached(self_in, attr, dest, cache);
+    if (dest[1] == MP_OBJ_NULL) {
+        return dest[0];
+    } else {
+        return mp_obj_new_bound_meth(dest[0], dest[1]);
+    }
+}
+#endif
+
 STATIC bool mp_obj_instance_store_attr(mp_obj_t self_in, qstr attr, mp_obj_t value) {
     mp_obj_instance_t *self = MP_OBJ_TO_PTR(self_in);
 
@@ -964,6 +1044,11 @@ STATIC void type_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
                     dest[0] = MP_OBJ_NULL; // indicate success
                 }
             }
+            #if MICROPY_OPT_ATTR_INLINE_CACHE
+            // this class and all its subclasses may now resolve attributes
+            // differently, so invalidate all cached lookups
+            ++MP_STATE_VM(attr_cache_version);
+            #endif
         }
     }
 }
@@ -982,7 +1067,9 @@ mp_obj_t mp_obj_new_type(qstr name, mp_obj_t bases_tuple, mp_obj_t locals_dict)
     assert(MP_OBJ_IS_TYPE(bases_tuple, &mp_type_tuple)); // MicroPython restriction, for now
     assert(MP_OBJ_IS_TYPE(locals_dict, &mp_type_dict)); // MicroPython restriction, for now
 
-    // TODO might need to make a copy of locals_dict; at least that's how CPython does it
+    // make a copy of locals_dict, as CPython does, so the type owns its dict;
+    // the attribute cache relies on all changes to it going through type_attr
+    locals_dict = mp_obj_dict_copy(locals_dict);
 
     // Basic validation of base classes
     size_t len;
@@ -40,6 +40,24 @@ typedef struct _mp_obj_instance_t {
 // this needs to be exposed for MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE to work
 void mp_obj_instance_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest);
 
+// An entry in the attribute cache, giving the result of looking up attr on
+// an instance of type.  A dest[1] of MP_OBJ_SENTINEL means the member is bound
+// to the instance.  Entries are never modified once published, so lookups
+// need no locking.
+typedef struct _mp_attr_cache_entry_t {
+    const mp_obj_type_t *type;
+    size_t version;
+    qstr attr;
+    mp_obj_t dest[2];
+} mp_attr_cache_entry_t;
+
+#if MICROPY_OPT_ATTR_INLINE_CACHE
+// these are used by the VM for LOAD_METHOD and LOAD_ATTR on instances, with
+// cache pointing to the 2 entries for the call site
+void mp_obj_instance_load_method_cached(mp_obj_t self_in, qstr attr, mp_obj_t *dest, mp_attr_cache_entry_t **cache);
+mp_obj_t mp_obj_instance_load_attr_cached(mp_obj_t self_in, qstr attr, mp_attr_cache_entry_t **cache);
+#endif
+
 // these need to be exposed so mp_obj_is_callable can work correctly
 bool mp_obj_instance_is_callable(mp_obj_t self_in);
 mp_obj_t mp_obj_instance_call(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args);
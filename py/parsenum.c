@@ -31,9 +31,12 @@
 #include "py/parsenumbase.h"
 #include "py/parsenum.h"
 #include "py/smallint.h"
+#include "py/mpz.h"
 
 #if MICROPY_PY_BUILTINS_FLOAT
+#include <float.h>
 #include <math.h>
+#include "py/formatfloat.h"
 #endif
 
 STATIC NORETURN void raise_exc(mp_obj_t exc, mp_lexer_t *lex) {
@@ -168,6 +171,214 @@ typedef enum {
     PARSE_DEC_IN_EXP,
 } parse_dec_in_t;
 
+#if MICROPY_PY_BUILTINS_FLOAT && MICROPY_FLOAT_FAST_CONV
+
+#if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_FLOAT
+#define DEC_MANT_BITS (23)
+#define DEC_EXP_MIN (-127)
+#define DEC_EXP_INF (0xff)
+#define DEC_POW10_MIN (-65)
+#define DEC_POW10_MAX (38)
+#define DEC_ROUND_EVEN_MIN (-17)
+#define DEC_ROUND_EVEN_MAX (10)
+#define DEC_EXACT_POW10_MAX (10)
+typedef uint32_t dec_float_uint_t;
+#else
+#define DEC_MANT_BITS (52)
+#define DEC_EXP_MIN (-1023)
+#define DEC_EXP_INF (0x7ff)
+#define DEC_POW10_MIN (-342)
+#define DEC_POW10_MAX (308)
+#define DEC_ROUND_EVEN_MIN (-4)
+#define DEC_ROUND_EVEN_MAX (23)
+#define DEC_EXACT_POW10_MAX (22)
+typedef uint64_t dec_float_uint_t;
+#endif
+
+// Powers of 10 that are exactly representable
+STATIC const mp_float_t dec_pow10_exact[DEC_EXACT_POW10_MAX + 1] = {
+    MICROPY_FLOAT_CONST(1e0), MICROPY_FLOAT_CONST(1e1), MICROPY_FLOAT_CONST(1e2),
+    MICROPY_FLOAT_CONST(1e3), MICROPY_FLOAT_CONST(1e4), MICROPY_FLOAT_CONST(1e5),
+    MICROPY_FLOAT_CONST(1e6), MICROPY_FLOAT_CONST(1e7), MICROPY_FLOAT_CONST(1e8),
+    MICROPY_FLOAT_CONST(1e9), MICROPY_FLOAT_CONST(1e10),
+    #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    #endif
+};
+
+// Returns the float nearest to w * 10^q, for w < 10^19, using the algorithm
+// by Daniel Lemire, "Number Parsing at a Gigabyte per Second", 2021, based on
+// an idea by Michael Eisel.
+STATIC mp_float_t dec_to_float(uint64_t w, int q) {
+    #if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    // Clinger's fast path: both operands are exact so one rounding is made
+    if (-DEC_EXACT_POW10_MAX <= q && q <= DEC_EXACT_POW10_MAX && w <= ((uint64_t)1 << (DEC_MANT_BITS + 1))) {
+        mp_float_t f = (mp_float_t)w;
+        if (q < 0) {
+            return f / dec_pow10_exact[-q];
+        } else {
+            return f * dec_pow10_exact[q];
+        }
+    }
+    #endif
+
+    union {
+        mp_float_t f;
+        dec_float_uint_t u;
+    } fb;
+    if (w == 0 || q < DEC_POW10_MIN) {
+        return 0;
+    } else if (q > DEC_POW10_MAX) {
+        return (mp_float_t)INFINITY;
+    }
+
+    // multiply the normalised w by the 128-bit approximation of 5^q; the
+    // second half of the product is only needed if the first is inconclusive
+    #if defined(__GNUC__)
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+    #else
+    int lz = 0;
+    while (!(w & ((uint64_t)1 << 63))) {
+        w <<= 1;
+        ++lz;
+    }
+    #endif
+    const uint64_t *pow5 = mp_float_pow5_128[q - MP_FLOAT_POW5_MIN];
+    uint64_t hi;
+    uint64_t lo = mp_float_umul128(w, pow5[0], &hi);
+    const uint64_t precision_mask = UINT64_MAX >> (DEC_MANT_BITS + 3);
+    if ((hi & precision_mask) == precision_mask) {
+        uint64_t hi2;
+        mp_float_umul128(w, pow5[1], &hi2);
+        lo += hi2;
+        hi += lo < hi2;
+    }
+
+    // keep one bit more than the mantissa for rounding; the exponent uses
+    // floor(q * log2(10)) = (q * 217706) >> 16 for |q| <= 1233
+    int upperbit = hi >> 63;
+    int shift = upperbit + 64 - DEC_MANT_BITS - 3;
+    uint64_t mant = hi >> shift;
+    int exp2 = ((q * 217706) >> 16) + 63 + upperbit - lz - DEC_EXP_MIN;
+
+    if (exp2 <= 0) {
+        // subnormal, or rounds up to the smallest normal
+        if (-exp2 + 1 >= 64) {
+            return 0;
+        }
+        mant >>= -exp2 + 1;
+        mant += mant & 1;
+        mant >>= 1;
+        exp2 = mant < ((uint64_t)1 << DEC_MANT_BITS) ? 0 : 1;
+    } else {
+        // round half up, unless the product is exact and halfway, where
+        // ties go to even; that can only happen for a small range of q
+        if (lo <= 1 && DEC_ROUND_EVEN_MIN <= q && q <= DEC_ROUND_EVEN_MAX
+            && (mant & 3) == 1 && (mant << shift) == hi) {
+            mant &= ~(uint64_t)1;
+        }
+        mant += mant & 1;
+        mant >>= 1;
+        if (mant >= ((uint64_t)2 << DEC_MANT_BITS)) {
+            mant = (uint64_t)1 << DEC_MANT_BITS;
+            ++exp2;
+        }
+        mant &= ~((uint64_t)1 << DEC_MANT_BITS);
+        if (exp2 >= DEC_EXP_INF) {
+            return (mp_float_t)INFINITY;
+        }
+    }
+
+    fb.u = (dec_float_uint_t)(mant | ((uint64_t)exp2 << DEC_MANT_BITS));
+    return fb.f;
+}
+
+#if MICROPY_LONGINT_IMPL == MICROPY_LONGINT_IMPL_MPZ
+
+STATIC void dec_mpz_mul_pow5(mpz_t *z, mp_uint_t n) {
+    mpz_t p, e;
+    mpz_init_from_int(&p, 5);
+    mpz_init_from_int(&e, n);
+    mpz_pow_inpl(&p, &p, &e);
+    mpz_mul_inpl(z, z, &p);
+    mpz_deinit(&p);
+    mpz_deinit(&e);
+}
+
+// Returns f or the next float up, whichever is nearer to the decimal number
+// with the digits starting at str (including any point) times 10^exp10, by
+// comparing that number exactly with the midpoint of the two.
+STATIC mp_float_t dec_round_exact(const char *str, const char *top, mp_int_t exp10, mp_float_t f) {
+    union {
+        mp_float_t f;
+        dec_float_uint_t u;
+    } fb = {f};
+    int exp2 = fb.u >> DEC_MANT_BITS;
+    uint64_t mant = fb.u & (((dec_float_uint_t)1 << DEC_MANT_BITS) - 1);
+    if (exp2 == 0) {
+        exp2 = 1;
+    } else {
+        mant |= (uint64_t)1 << DEC_MANT_BITS;
+    }
+
+    // the midpoint is mid * 2^exp2
+    mpz_t dec, mid;
+    mpz_init_zero(&dec);
+    mpz_init_zero(&mid);
+    mpz_set_from_ll(&mid, 2 * mant + 1, false);
+    exp2 += DEC_EXP_MIN - DEC_MANT_BITS - 1;
+
+    // the decimal number is dec * 10^exp10
+    const char *point = NULL;
+    const char *end = str;
+    for (; end < top && (unichar_isdigit(*end) || (*end == '.' && point == NULL)); ++end) {
+        if (*end == '.') {
+            point = end;
+        }
+    }
+    if (point == NULL) {
+        mpz_set_from_str(&dec, str, end - str, false, 10);
+    } else {
+        mpz_t frac;
+        mpz_init_zero(&frac);
+        size_t nfrac = end - point - 1;
+        mpz_set_from_str(&dec, str, point - str, false, 10);
+        mpz_set_from_str(&frac, point + 1, nfrac, false, 10);
+        dec_mpz_mul_pow5(&dec, nfrac);
+        mpz_shl_inpl(&dec, &dec, nfrac);
+        mpz_add_inpl(&dec, &dec, &frac);
+        mpz_deinit(&frac);
+        exp10 -= nfrac;
+    }
+
+    // cancel the common powers of 2 and compare
+    if (exp10 >= 0) {
+        dec_mpz_mul_pow5(&dec, exp10);
+    } else {
+        dec_mpz_mul_pow5(&mid, -exp10);
+    }
+    exp2 -= exp10;
+    if (exp2 >= 0) {
+        mpz_shl_inpl(&mid, &mid, exp2);
+    } else {
+        mpz_shl_inpl(&dec, &dec, -exp2);
+    }
+    int cmp = mpz_cmp(&dec, &mid);
+    mpz_deinit(&dec);
+    mpz_deinit(&mid);
+
+    // round half to even
+    if (cmp > 0 || (cmp == 0 && (mant & 1))) {
+        fb.u += 1;
+    }
+    return fb.f;
+}
+
+#endif
+
+#endif
+
 mp_obj_t mp_parse_num_decimal(const char *str, size_t len, bool allow_imag, bool force_complex, mp_lexer_t *lex) {
 #if MICROPY_PY_BUILTINS_FLOAT
     const char *top = str + len;
@@ -214,21 +425,47 @@ mp_obj_t mp_parse_num_decimal(const char *str, size_t len, bool allow_imag, bool
         // string should be a decimal number
         parse_dec_in_t in = PARSE_DEC_IN_INTG;
         bool exp_neg = false;
+        #if MICROPY_FLOAT_FAST_CONV
+        // the first 19 significant digits, and the exponent to apply to them
+        uint64_t dec_mant = 0;
+        int dec_ndig = 0;
+        mp_int_t exp_adj = 0;
+        bool dec_trunc = false;
+        #else
         mp_float_t frac_mult = 0.1;
+        #endif
         mp_int_t exp_val = 0;
         while (str < top) {
             mp_uint_t dig = *str++;
             if ('0' <= dig && dig <= '9') {
                 dig -= '0';
                 if (in == PARSE_DEC_IN_EXP) {
+                    #if MICROPY_FLOAT_FAST_CONV
+                    // anything bigger is out of range anyway
+                    if (exp_val < 100000) {
+                        exp_val = 10 * exp_val + dig;
+                    }
+                    #else
                     exp_val = 10 * exp_val + dig;
+                    #endif
                 } else {
+                    #if MICROPY_FLOAT_FAST_CONV
+                    if (dec_ndig < 19) {
+                        dec_mant = 10 * dec_mant + dig;
+                        dec_ndig += dec_mant != 0;
+                        exp_adj -= in == PARSE_DEC_IN_FRAC;
+                    } else {
+                        dec_trunc |= dig != 0;
+                        exp_adj += in == PARSE_DEC_IN_INTG;
+                    }
+                    #else
                     if (in == PARSE_DEC_IN_FRAC) {
                         dec_val += dig * frac_mult;
                         frac_mult *= MICROPY_FLOAT_CONST(0.1);
                     } else {
                         dec_val = 10 * dec_val + dig;
                     }
+                    #endif
                 }
             } else if (in == PARSE_DEC_IN_INTG && dig == '.') {
                 in = PARSE_DEC_IN_FRAC;
@@ -260,8 +497,28 @@ mp_obj_t mp_parse_num_decimal(const char *str, size_t len, bool allow_imag, bool
             exp_val = -exp_val;
         }
 
+        #if MICROPY_FLOAT_FAST_CONV
+        // convert with correct rounding
+        mp_int_t q = exp_val + exp_adj;
+        if (q < -100000) {
+            q = -100000;
+        } else if (q > 100000) {
+            q = 100000;
+        }
+        dec_val = dec_to_float(dec_mant, q);
+        #if MICROPY_LONGINT_IMPL == MICROPY_LONGINT_IMPL_MPZ
+        if (dec_trunc && dec_to_float(dec_mant + 1, q) != dec_val) {
+            // the dropped digits decide the rounding
+            dec_val = dec_round_exact(str_val_start, top, exp_val, dec_val);
+        }
+        #else
+        // without big integers, if digits were dropped the result may be one ulp low
+        (void)dec_trunc;
+        #endif
+        #else
         // apply the exponent
         dec_val *= MICROPY_FLOAT_C_FUN(pow)(10, exp_val);
+        #endif
     }
 
     // negate value if needed
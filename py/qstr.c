@@ -32,8 +32,8 @@
 #include "py/qstr.h"
 #include "py/gc.h"
 
-// NOTE: we are using linear arrays to store and search for qstr's (unique strings, interned strings)
-// ultimately we will replace this with a static hash table of some kind
+// NOTE: we are using linear arrays to store qstr's (unique strings, interned strings)
+// and, unless MICROPY_OPT_QSTR_HASH_INDEX is enabled, to search for them
 // also probably need to include the length in the string data, to allow null bytes in the string
 
 #if MICROPY_DEBUG_VERBOSE // print debugging info
@@ -109,6 +109,39 @@ const qstr_pool_t mp_qstr_const_pool = {
     },
 };
 
+#if MICROPY_OPT_QSTR_HASH_INDEX
+// Hash table of the qstrs in mp_qstr_const_pool, generated by makeqstrdata.py.
+// It is indexed by the low bits of the qstr hash with linear probing, and
+// MP_QSTR_NULL marks an empty slot.  The size is a power of 2.
+STATIC const uint16_t qstr_const_index[] = {
+#ifndef NO_QSTR
+#define QDEF(id, str)
+#define QINDEX(id) id,
+#include "genhdr/qstrdefs.generated.h"
+#undef QINDEX
+#undef QDEF
+#endif
+};
+
+// Smallest size of the hash table of dynamically created qstrs.  The size is
+// kept in the first element of the table's allocation, followed by the slots,
+// so that a lookup which loads the table pointer once always sees a matching
+// size, even while another thread replaces the table.
+#define QSTR_INDEX_MIN_ALLOC (64)
+#define QSTR_INDEX_ALLOC(index) ((index)[0])
+#define QSTR_INDEX_SLOTS(index) ((index) + 1)
+
+// Lookups don't take qstr_mutex, so without a GIL the table and its slots are
+// published with release stores, after the qstr data they refer to.
+#if MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL
+#define QSTR_INDEX_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define QSTR_INDEX_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#else
+#define QSTR_INDEX_LOAD(ptr) (*(ptr))
+#define QSTR_INDEX_STORE(ptr, val) (*(ptr) = (val))
+#endif
+#endif
+
 #ifdef MICROPY_QSTR_EXTRA_POOL
 extern const qstr_pool_t MICROPY_QSTR_EXTRA_POOL;
 #define CONST_POOL MICROPY_QSTR_EXTRA_POOL
@@ -120,6 +153,11 @@ void qstr_init(void) {
     MP_STATE_VM(last_pool) = (qstr_pool_t*)&CONST_POOL; // we won't modify the const_pool since it has no allocated room left
     MP_STATE_VM(qstr_last_chunk) = NULL;
 
+    #if MICROPY_OPT_QSTR_HASH_INDEX
+    MP_STATE_VM(qstr_index) = NULL;
+    MP_STATE_VM(qstr_index_len) = 0;
+    #endif
+
     #if MICROPY_PY_THREAD
     mp_thread_mutex_init(&MP_STATE_VM(qstr_mutex));
     #endif
@@ -137,6 +175,54 @@ STATIC const byte *find_qstr(qstr q) {
     return 0;
 }
 
+#if MICROPY_OPT_QSTR_HASH_INDEX
+STATIC void qstr_index_insert(qstr *index, qstr q) {
+    size_t mask = QSTR_INDEX_ALLOC(index) - 1;
+    qstr *slots = QSTR_INDEX_SLOTS(index);
+    size_t i = Q_GET_HASH(find_qstr(q)) & mask;
+    while (slots[i] != MP_QSTR_NULL) {
+        i = (i + 1) & mask;
+    }
+    QSTR_INDEX_STORE(&slots[i], q);
+}
+
+// Add q, which must be the last qstr in the last pool, to the hash table of
+// dynamically created qstrs.  The table covers every pool except the const
+// pool and is rebuilt, twice as big, when it would become more than half
+// full.  If it can't be allocated it's dropped and qstr_find_strn searches
+// the pools linearly until a later qstr_add manages to allocate it.
+// qstr_mutex must be taken while in this function.
+STATIC void qstr_index_add(qstr q) {
+    qstr *index = MP_STATE_VM(qstr_index);
+    if (index != NULL && 2 * (MP_STATE_VM(qstr_index_len) + 1) <= QSTR_INDEX_ALLOC(index)) {
+        qstr_index_insert(index, q);
+        MP_STATE_VM(qstr_index_len) += 1;
+        return;
+    }
+
+    size_t len = q + 1 - mp_qstr_const_pool.len;
+    size_t alloc = QSTR_INDEX_MIN_ALLOC;
+    while (alloc < 2 * len) {
+        alloc *= 2;
+    }
+    index = m_new_leaf_maybe(qstr, 1 + alloc);
+
+    // The old table is left for the GC to reclaim, so that a lookup in another
+    // thread that is still using it stays valid.
+    MP_STATE_VM(qstr_index) = NULL;
+    if (index == NULL) {
+        return;
+    }
+    memset(index, 0, (1 + alloc) * sizeof(qstr));
+    QSTR_INDEX_ALLOC(index) = alloc;
+    for (qstr i = mp_qstr_const_pool.len; i <= q; ++i) {
+        qstr_index_insert(index, i);
+    }
+    MP_STATE_VM(qstr_index_len) = len;
+    QSTR_INDEX_STORE(&MP_STATE_VM(qstr_index), index);
+}
+#endif
+
 // qstr_mutex must be taken while in this function
 STATIC qstr qstr_add(const byte *q_ptr) {
     DEBUG_printf("QSTR: add hash=%d len=%d data=%.*s\n", Q_GET_HASH(q_ptr), Q_GET_LENGTH(q_ptr), Q_GET_LENGTH(q_ptr), Q_GET_DATA(q_ptr));
@@ -158,17 +244,55 @@ STATIC qstr qstr_add(const byte *q_ptr) {
 
     // add the new qstr
     MP_STATE_VM(last_pool)->qstrs[MP_STATE_VM(last_pool)->len++] = q_ptr;
+    qstr q = MP_STATE_VM(last_pool)->total_prev_len + MP_STATE_VM(last_pool)->len - 1;
+
+    #if MICROPY_OPT_QSTR_HASH_INDEX
+    qstr_index_add(q);
+    #endif
 
     // return id for the newly-added qstr
-    return MP_STATE_VM(last_pool)->total_prev_len + MP_STATE_VM(last_pool)->len - 1;
+    return q;
 }
 
 qstr qstr_find_strn(const char *str, size_t str_len) {
     // work out hash of str
     mp_uint_t str_hash = qstr_compute_hash((const byte*)str, str_len);
 
+    #if MICROPY_OPT_QSTR_HASH_INDEX
+    // look up the const pool in its hash table
+    size_t mask = MP_ARRAY_SIZE(qstr_const_index) - 1;
+    for (size_t i = str_hash & mask; qstr_const_index[i] != MP_QSTR_NULL; i = (i + 1) & mask) {
+        const byte *q = mp_qstr_const_pool.qstrs[qstr_const_index[i]];
+        if (Q_GET_HASH(q) == str_hash && Q_GET_LENGTH(q) == str_len && memcmp(Q_GET_DATA(q), str, str_len) == 0) {
+            return qstr_const_index[i];
+        }
+    }
+
+    // then the other pools, in their hash table if there is one
+    // (the table pointer is loaded once and the size is read from the table)
+    qstr *index = QSTR_INDEX_LOAD(&MP_STATE_VM(qstr_index));
+    if (index != NULL) {
+        mask = QSTR_INDEX_ALLOC(index) - 1;
+        qstr *slots = QSTR_INDEX_SLOTS(index);
+        for (size_t i = str_hash & mask;; i = (i + 1) & mask) {
+            qstr slot = QSTR_INDEX_LOAD(&slots[i]);
+            if (slot == MP_QSTR_NULL) {
+                break;
+            }
+            const byte *q = find_qstr(slot);
+            if (Q_GET_HASH(q) == str_hash && Q_GET_LENGTH(q) == str_len && memcmp(Q_GET_DATA(q), str, str_len) == 0) {
+                return slot;
+            }
+        }
+        return 0;
+    }
+    const qstr_pool_t *end_pool = &mp_qstr_const_pool;
+    #else
+    const qstr_pool_t *end_pool = NULL;
+    #endif
+
     // search pools for the data
-    for (qstr_pool_t *pool = MP_STATE_VM(last_pool); pool != NULL; pool = pool->prev) {
+    for (qstr_pool_t *pool = MP_STATE_VM(last_pool); pool != end_pool; pool = pool->prev) {
         for (const byte **q = pool->qstrs, **q_top = pool->qstrs + pool->len; q < q_top; q++) {
             if (Q_GET_HASH(*q) == str_hash && Q_GET_LENGTH(*q) == str_len && memcmp(Q_GET_DATA(*q), str, str_len) == 0) {
                 return pool->total_prev_len + (q - pool->qstrs);
@@ -213,10 +337,10 @@ qstr qstr_from_strn(const char *str, size_t len) {
             if (al < MICROPY_ALLOC_QSTR_CHUNK_INIT) {
                 al = MICROPY_ALLOC_QSTR_CHUNK_INIT;
             }
-            MP_STATE_VM(qstr_last_chunk) = m_new_maybe(byte, al);
+            MP_STATE_VM(qstr_last_chunk) = m_new_leaf_maybe(byte, al);
             if (MP_STATE_VM(qstr_last_chunk) == NULL) {
                 // failed to allocate a large chunk so try with exact size
-                MP_STATE_VM(qstr_last_chunk) = m_new_maybe(byte, n_bytes);
+                MP_STATE_VM(qstr_last_chunk) = m_new_leaf_maybe(byte, n_bytes);
                 if (MP_STATE_VM(qstr_last_chunk) == NULL) {
                     QSTR_EXIT();
                     m_malloc_fail(n_bytes);
@@ -245,7 +369,7 @@ qstr qstr_from_strn(const char *str, size_t len) {
 
 byte *qstr_build_start(size_t len, byte **q_ptr) {
     assert(len < (1 << (8 * MICROPY_QSTR_BYTES_IN_LEN)));
-    *q_ptr = m_new(byte, MICROPY_QSTR_BYTES_IN_HASH + MICROPY_QSTR_BYTES_IN_LEN + len + 1);
+    *q_ptr = m_new_leaf(byte, MICROPY_QSTR_BYTES_IN_HASH + MICROPY_QSTR_BYTES_IN_LEN + len + 1);
     Q_SET_LENGTH(*q_ptr, len);
     return Q_GET_DATA(*q_ptr);
 }
@@ -25,6 +25,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 #include "py/runtime.h"
@@ -47,6 +48,16 @@ STATIC mp_uint_t mp_reader_mem_readbyte(void *data) {
     }
 }
 
+STATIC size_t mp_reader_mem_readinto(void *data, byte *buf, size_t len) {
+    mp_reader_mem_t *reader = (mp_reader_mem_t*)data;
+    if (len > (size_t)(reader->end - reader->cur)) {
+        len = reader->end - reader->cur;
+    }
+    memcpy(buf, reader->cur, len);
+    reader->cur += len;
+    return len;
+}
+
 STATIC void mp_reader_mem_close(void *data) {
     mp_reader_mem_t *reader = (mp_reader_mem_t*)data;
     if (reader->free_len > 0) {
@@ -64,6 +75,7 @@ void mp_reader_new_mem(mp_reader_t *reader, const byte *buf, size_t len, size_t
     reader->data = rm;
     reader->readbyte = mp_reader_mem_readbyte;
     reader->close = mp_reader_mem_close;
+    reader->readinto = mp_reader_mem_readinto;
 }
 
 #if MICROPY_READER_POSIX
@@ -98,6 +110,28 @@ STATIC mp_uint_t mp_reader_posix_readbyte(void *data) {
     return reader->buf[reader->pos++];
 }
 
+STATIC size_t mp_reader_posix_readinto(void *data, byte *buf, size_t len) {
+    mp_reader_posix_t *reader = (mp_reader_posix_t*)data;
+    if (reader->pos < reader->len) {
+        // hand out what was buffered by an earlier read
+        if (len > reader->len - reader->pos) {
+            len = reader->len - reader->pos;
+        }
+        memcpy(buf, reader->buf + reader->pos, len);
+        reader->pos += len;
+        return len;
+    }
+    if (reader->len == 0) {
+        return 0;
+    }
+    int n = read(reader->fd, buf, len);
+    if (n <= 0) {
+        reader->len = 0;
+        return 0;
+    }
+    return n;
+}
+
 STATIC void mp_reader_posix_close(void *data) {
     mp_reader_posix_t *reader = (mp_reader_posix_t*)data;
     if (reader->close_fd) {
@@ -122,6 +156,7 @@ void mp_reader_new_file_from_fd(mp_reader_t *reader, int fd, bool close_fd) {
     reader->data = rp;
     reader->readbyte = mp_reader_posix_readbyte;
     reader->close = mp_reader_posix_close;
+    reader->readinto = mp_reader_posix_readinto;
 }
 
 void mp_reader_new_file(mp_reader_t *reader, const char *filename) {
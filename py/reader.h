@@ -33,10 +33,14 @@
 // it can be called again after returning MP_READER_EOF, and in that case must return MP_READER_EOF
 #define MP_READER_EOF ((mp_uint_t)(-1))
 
+// the optional readinto function must read up to len bytes into buf and return
+// the number read, returning 0 only at the end of the stream; it may be NULL,
+// in which case readbyte is used, and calls to both can be mixed
 typedef struct _mp_reader_t {
     void *data;
     mp_uint_t (*readbyte)(void *data);
     void (*close)(void *data);
+    size_t (*readinto)(void *data, byte *buf, size_t len);
 } mp_reader_t;
 
 void mp_reader_new_mem(mp_reader_t *reader, const byte *buf, size_t len, size_t free_len);
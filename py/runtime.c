@@ -108,6 +108,21 @@ void mp_init(void) {
     MP_STATE_VM(mp_module_builtins_override_dict) = NULL;
     #endif
 
+    #if MICROPY_OPT_ATTR_INLINE_CACHE
+    // entries from a previous session point into the old heap
+    memset(MP_STATE_VM(attr_cache), 0, sizeof(MP_STATE_VM(attr_cache)));
+    MP_STATE_VM(attr_cache_version) = 0;
+    #endif
+
+    #if MICROPY_OPT_STR_INPLACE_ADD
+    MP_STATE_VM(str_append_buf) = NULL;
+    MP_STATE_VM(str_append_alloc) = 0;
+    MP_STATE_VM(str_append_len) = 0;
+    #if MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL
+    mp_thread_mutex_init(&MP_STATE_VM(str_append_mutex));
+    #endif
+    #endif
+
     #ifdef MICROPY_PY_OS_DUPTERM
     for (size_t i = 0; i < MICROPY_PY_OS_DUPTERM; ++i) {
         MP_STATE_VM(dupterm_objs[i]) = MP_OBJ_NULL;
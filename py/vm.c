@@ -32,6 +32,7 @@
 #include "py/emitglue.h"
 #include "py/objtype.h"
 #include "py/runtime.h"
+#include "py/smallint.h"
 #include "py/bc0.h"
 #include "py/bc.h"
 
@@ -93,6 +94,47 @@ typedef enum {
 
 #endif
 
+#if MICROPY_OPT_ATTR_INLINE_CACHE
+// the attribute cache entries for the call site at ip
+#define ATTR_CACHE(ip) (MP_STATE_VM(attr_cache)[(uintptr_t)(ip) & (MICROPY_OPT_ATTR_INLINE_CACHE_SIZE - 1)])
+#endif
+
+#if MICROPY_OPT_QUICKEN_BYTECODE
+// Evaluate a comparison op (MP_BINARY_OP_LESS to MP_BINARY_OP_NOT_EQUAL)
+STATIC inline bool quick_small_int_cmp(mp_uint_t op, mp_int_t lhs, mp_int_t rhs) {
+    switch (op) {
+        case MP_BINARY_OP_LESS: return lhs < rhs;
+        case MP_BINARY_OP_MORE: return lhs > rhs;
+        case MP_BINARY_OP_EQUAL: return lhs == rhs;
+        case MP_BINARY_OP_LESS_EQUAL: return lhs <= rhs;
+        case MP_BINARY_OP_MORE_EQUAL: return lhs >= rhs;
+        default: return lhs != rhs;
+    }
+}
+
+// Evaluate one of the ops in mp_bc_quick_binary_op; returns MP_OBJ_NULL if
+// the result is not a small int
+STATIC inline mp_obj_t quick_small_int_binary_op(mp_uint_t op, mp_int_t lhs, mp_int_t rhs) {
+    mp_int_t res;
+    switch (op) {
+        case MP_BINARY_OP_INPLACE_ADD:
+        case MP_BINARY_OP_ADD:
+            res = lhs + rhs;
+            break;
+        case MP_BINARY_OP_INPLACE_SUBTRACT:
+        case MP_BINARY_OP_SUBTRACT:
+            res = lhs - rhs;
+            break;
+        default:
+            return mp_obj_new_bool(quick_small_int_cmp(op, lhs, rhs));
+    }
+    if (!MP_SMALL_INT_FITS(res)) {
+        return MP_OBJ_NULL;
+    }
+    return MP_OBJ_NEW_SMALL_INT(res);
+}
+#endif
+
 #define PUSH(val) *++sp = (val)
 #define POP() (*sp--)
 #define TOP() (*sp)
@@ -336,6 +378,12 @@ dispatch_loop:
                 ENTRY(MP_BC_LOAD_ATTR): {
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
+                    #if MICROPY_OPT_ATTR_INLINE_CACHE
+                    if (mp_obj_get_type(TOP())->attr == mp_obj_instance_attr) {
+                        SET_TOP(mp_obj_instance_load_attr_cached(TOP(), qst, ATTR_CACHE(ip)));
+                        DISPATCH();
+                    }
+                    #endif
                     SET_TOP(mp_load_attr(TOP(), qst));
                     DISPATCH();
                 }
@@ -364,7 +412,14 @@ dispatch_loop:
                         DISPATCH();
                     }
                 load_attr_cache_fail:
-                    SET_TOP(mp_load_attr(top, qst));
+                    #if MICROPY_OPT_ATTR_INLINE_CACHE
+                    if (mp_obj_get_type(top)->attr == mp_obj_instance_attr) {
+                        SET_TOP(mp_obj_instance_load_attr_cached(top, qst, ATTR_CACHE(ip)));
+                    } else
+                    #endif
+                    {
+                        SET_TOP(mp_load_attr(top, qst));
+                    }
                     ip++;
                     DISPATCH();
                 }
@@ -373,7 +428,14 @@ dispatch_loop:
                 ENTRY(MP_BC_LOAD_METHOD): {
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
-                    mp_load_method(*sp, qst, sp);
+                    #if MICROPY_OPT_ATTR_INLINE_CACHE
+                    if (mp_obj_get_type(*sp)->attr == mp_obj_instance_attr) {
+                        mp_obj_instance_load_method_cached(*sp, qst, sp, ATTR_CACHE(ip));
+                    } else
+                    #endif
+                    {
+                        mp_load_method(*sp, qst, sp);
+                    }
                     sp += 1;
                     DISPATCH();
                 }
@@ -1214,6 +1276,117 @@ yield:
                     mp_import_all(POP());
                     DISPATCH();
 
+#if MICROPY_OPT_QUICKEN_BYTECODE
+                // The quickened opcodes below handle small ints only.  For
+                // anything else they restore the original opcode and
+                // re-dispatch it, so that site stays generic from then on.
+
+                quick_fast_cmp_jump: {
+                    // ip[0] is LOAD_FAST_MULTI or LOAD_CONST_SMALL_INT_MULTI,
+                    // ip[1] is BINARY_OP_MULTI, ip[2..4] is POP_JUMP_IF_xxx
+                    mp_obj_t lhs = fastn[MP_BC_QUICK_FAST_CMP_JUMP_MULTI - (mp_int_t)ip[-1]];
+                    mp_obj_t rhs;
+                    if (ip[0] >= MP_BC_LOAD_FAST_MULTI) {
+                        rhs = fastn[MP_BC_LOAD_FAST_MULTI - (mp_int_t)ip[0]];
+                    } else {
+                        rhs = MP_OBJ_NEW_SMALL_INT((mp_int_t)ip[0] - MP_BC_LOAD_CONST_SMALL_INT_MULTI - 16);
+                    }
+                    if (MP_OBJ_IS_SMALL_INT(lhs) && MP_OBJ_IS_SMALL_INT(rhs)) {
+                        bool cond = quick_small_int_cmp(ip[1] - MP_BC_BINARY_OP_MULTI,
+                            MP_OBJ_SMALL_INT_VALUE(lhs), MP_OBJ_SMALL_INT_VALUE(rhs));
+                        bool jump_if = ip[2] == MP_BC_POP_JUMP_IF_TRUE;
+                        ip += 3;
+                        DECODE_SLABEL;
+                        if (cond == jump_if) {
+                            ip += slab;
+                        }
+                        DISPATCH_WITH_PEND_EXC_CHECK();
+                    }
+                    *(byte*)&ip[-1] = MP_BC_LOAD_FAST_MULTI + (ip[-1] - MP_BC_QUICK_FAST_CMP_JUMP_MULTI);
+                    ip -= 1;
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_QUICK_FAST_INPLACE_CONST): {
+                    // ip[0] is LOAD_CONST_SMALL_INT_MULTI, ip[1] is BINARY_OP_MULTI,
+                    // ip[2] is STORE_FAST_MULTI to the same local that is loaded
+                    mp_obj_t *var = &fastn[MP_BC_STORE_FAST_MULTI - (mp_int_t)ip[2]];
+                    if (MP_OBJ_IS_SMALL_INT(*var)) {
+                        mp_obj_t res = quick_small_int_binary_op(ip[1] - MP_BC_BINARY_OP_MULTI,
+                            MP_OBJ_SMALL_INT_VALUE(*var), (mp_int_t)ip[0] - MP_BC_LOAD_CONST_SMALL_INT_MULTI - 16);
+                        if (res != MP_OBJ_NULL) {
+                            *var = res;
+                            ip += 3;
+                            DISPATCH();
+                        }
+                    }
+                    *(byte*)&ip[-1] = MP_BC_LOAD_FAST_MULTI + (ip[2] - MP_BC_STORE_FAST_MULTI);
+                    ip -= 1;
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_QUICK_RANGE_CMP_JUMP): {
+                    // ip[0] is ROT_TWO, ip[1] is BINARY_OP_MULTI, ip[2..4] is POP_JUMP_IF_xxx;
+                    // compares the counter on TOS with the limit below it
+                    mp_obj_t lhs = TOP();
+                    mp_obj_t rhs = sp[-1];
+                    if (MP_OBJ_IS_SMALL_INT(lhs) && MP_OBJ_IS_SMALL_INT(rhs)) {
+                        bool cond = quick_small_int_cmp(ip[1] - MP_BC_BINARY_OP_MULTI,
+                            MP_OBJ_SMALL_INT_VALUE(lhs), MP_OBJ_SMALL_INT_VALUE(rhs));
+                        bool jump_if = ip[2] == MP_BC_POP_JUMP_IF_TRUE;
+                        ip += 3;
+                        DECODE_SLABEL;
+                        if (cond == jump_if) {
+                            ip += slab;
+                        }
+                        DISPATCH_WITH_PEND_EXC_CHECK();
+                    }
+                    *(byte*)&ip[-1] = MP_BC_DUP_TOP_TWO;
+                    ip -= 1;
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_QUICK_FOR_ITER_RANGE): {
+                    mp_obj_t obj;
+                    if (sp[-MP_OBJ_ITER_BUF_NSLOTS + 1] == MP_OBJ_NULL) {
+                        obj = sp[-MP_OBJ_ITER_BUF_NSLOTS + 2];
+                    } else {
+                        obj = MP_OBJ_FROM_PTR(&sp[-MP_OBJ_ITER_BUF_NSLOTS + 1]);
+                    }
+                    mp_obj_t value = mp_obj_range_it_iternext(obj);
+                    if (value == MP_OBJ_NULL) {
+                        *(byte*)&ip[-1] = MP_BC_FOR_ITER;
+                        ip -= 1;
+                        DISPATCH();
+                    }
+                    DECODE_ULABEL;
+                    if (value == MP_OBJ_STOP_ITERATION) {
+                        sp -= MP_OBJ_ITER_BUF_NSLOTS; // pop the exhausted iterator
+                        ip += ulab; // jump to after for-block
+                    } else {
+                        PUSH(value); // push the next iteration value
+                    }
+                    DISPATCH();
+                }
+
+                quick_binary_op: {
+                    mp_uint_t op = mp_bc_quick_binary_op[ip[-1] - MP_BC_QUICK_BINARY_OP_MULTI];
+                    mp_obj_t rhs = TOP();
+                    mp_obj_t lhs = sp[-1];
+                    if (MP_OBJ_IS_SMALL_INT(lhs) && MP_OBJ_IS_SMALL_INT(rhs)) {
+                        mp_obj_t res = quick_small_int_binary_op(op, MP_OBJ_SMALL_INT_VALUE(lhs), MP_OBJ_SMALL_INT_VALUE(rhs));
+                        if (res != MP_OBJ_NULL) {
+                            sp -= 1;
+                            SET_TOP(res);
+                            DISPATCH();
+                        }
+                    }
+                    *(byte*)&ip[-1] = MP_BC_BINARY_OP_MULTI + op;
+                    ip -= 1;
+                    DISPATCH();
+                }
+#endif
+
 #if MICROPY_OPT_COMPUTED_GOTO
                 ENTRY(MP_BC_LOAD_CONST_SMALL_INT_MULTI):
                     PUSH(MP_OBJ_NEW_SMALL_INT((mp_int_t)ip[-1] - MP_BC_LOAD_CONST_SMALL_INT_MULTI - 16));
@@ -1244,6 +1417,13 @@ yield:
                     MARK_EXC_IP_SELECTIVE();
 #else
                 ENTRY_DEFAULT:
+                    #if MICROPY_OPT_QUICKEN_BYTECODE
+                    if (ip[-1] < MP_BC_QUICK_FAST_CMP_JUMP_MULTI + 16) {
+                        goto quick_fast_cmp_jump;
+                    } else if (ip[-1] >= MP_BC_QUICK_BINARY_OP_MULTI) {
+                        goto quick_binary_op;
+                    } else
+                    #endif
                     if (ip[-1] < MP_BC_LOAD_CONST_SMALL_INT_MULTI + 64) {
                         PUSH(MP_OBJ_NEW_SMALL_INT((mp_int_t)ip[-1] - MP_BC_LOAD_CONST_SMALL_INT_MULTI - 16));
                         DISPATCH();
@@ -106,6 +106,13 @@ static const void *const entry_table[256] = {
     [MP_BC_IMPORT_NAME] = &&entry_MP_BC_IMPORT_NAME,
     [MP_BC_IMPORT_FROM] = &&entry_MP_BC_IMPORT_FROM,
     [MP_BC_IMPORT_STAR] = &&entry_MP_BC_IMPORT_STAR,
+    #if MICROPY_OPT_QUICKEN_BYTECODE
+    [MP_BC_QUICK_FAST_CMP_JUMP_MULTI ... MP_BC_QUICK_FAST_CMP_JUMP_MULTI + 15] = &&quick_fast_cmp_jump,
+    [MP_BC_QUICK_FAST_INPLACE_CONST] = &&entry_MP_BC_QUICK_FAST_INPLACE_CONST,
+    [MP_BC_QUICK_RANGE_CMP_JUMP] = &&entry_MP_BC_QUICK_RANGE_CMP_JUMP,
+    [MP_BC_QUICK_FOR_ITER_RANGE] = &&entry_MP_BC_QUICK_FOR_ITER_RANGE,
+    [MP_BC_QUICK_BINARY_OP_MULTI ... MP_BC_QUICK_BINARY_OP_MULTI + MP_BC_QUICK_BINARY_OP_NUM - 1] = &&quick_binary_op,
+    #endif
     [MP_BC_LOAD_CONST_SMALL_INT_MULTI ... MP_BC_LOAD_CONST_SMALL_INT_MULTI + 63] = &&entry_MP_BC_LOAD_CONST_SMALL_INT_MULTI,
     [MP_BC_LOAD_FAST_MULTI ... MP_BC_LOAD_FAST_MULTI + 15] = &&entry_MP_BC_LOAD_FAST_MULTI,
     [MP_BC_STORE_FAST_MULTI ... MP_BC_STORE_FAST_MULTI + 15] = &&entry_MP_BC_STORE_FAST_MULTI,
@@ -20,3 +20,9 @@ print(hex(pow(2, x-1, x))) # Should be 1, since x is prime
 print(hex(pow(y, x-1, x))) # Should be 1, since x is prime
 print(hex(pow(y, y-1, x))) # Should be a 'big value'
 print(hex(pow(y, y-1, y))) # Should be a 'big value'
+
+# odd multi-digit moduli
+m = (1 << 521) - 1
+print(hex(pow(3, m - 1, m))) # Should be 1, since m is prime
+print(hex(pow(y, x, m)))
+print(hex(pow(x, y, x * y + 2)))
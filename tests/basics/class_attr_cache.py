@@ -0,0 +1,72 @@
+# test that cached attribute lookups on instances see changes to classes
+
+class A:
+    x = 1
+    def f(self):
+        return 'A.f'
+    @staticmethod
+    def s():
+        return 'A.s'
+    @classmethod
+    def c(cls):
+        return cls.__name__
+
+class B(A):
+    pass
+
+def call(o):
+    return o.f(), o.x, o.s(), o.c()
+
+a = A()
+b = B()
+for i in range(3):
+    print(call(a), call(b))
+
+# replace a method in the base class
+A.f = lambda self: 'new A.f'
+print(call(a), call(b))
+
+# override in the subclass
+B.f = lambda self: 'B.f'
+B.x = 2
+print(call(a), call(b))
+
+# remove the override
+del B.f
+del B.x
+print(call(a), call(b))
+
+# instance attribute shadows the class attribute
+b.x = 3
+b.f = lambda: 'b.f'
+print(call(a), call(b))
+del b.x
+print(call(a), call(b))
+
+# bound method taken from a cached site
+m = a.f
+print(m())
+
+# attribute error after the attribute is removed
+def get_x(o):
+    return o.x
+print(get_x(a))
+del A.x
+try:
+    get_x(a)
+except AttributeError:
+    print('AttributeError')
+
+# a class made by type() doesn't see later changes to the dict it was given
+def call_f(o):
+    return o.f()
+d = {'f': lambda s: 1}
+C = type('C', (), d)
+c = C()
+r = [call_f(c)]
+d['f'] = lambda s: 2
+r.append(call_f(c))
+r.append(call_f(c))
+print(r)
+C.f = lambda s: 3
+print(call_f(c))
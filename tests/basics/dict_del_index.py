@@ -0,0 +1,35 @@
+# deleting from dicts large enough to have a hash index, with its slots
+# taking 1 and 2 bytes
+
+def check(n, key):
+    d = {}
+    for i in range(n):
+        d[key(i)] = i
+    # delete every other key
+    for i in range(0, n, 2):
+        del d[key(i)]
+    ok = len(d) == n // 2
+    for i in range(n):
+        if (key(i) in d) != (i % 2 == 1) or d.get(key(i), -1) != (i if i % 2 else -1):
+            ok = False
+    # deleted keys can be added again, at the end
+    for i in range(0, n, 2):
+        d[key(i)] = -i
+    ok = ok and list(d.values()) == list(range(1, n, 2)) + [-i for i in range(0, n, 2)]
+    # delete the rest in a different order, then the dict can be reused
+    for i in range(n - 1, -1, -1):
+        del d[key(i)]
+    ok = ok and len(d) == 0 and list(d) == []
+    d[key(0)] = 0
+    ok = ok and list(d.items()) == [(key(0), 0)]
+    try:
+        del d[key(1)]
+    except KeyError:
+        pass
+    else:
+        ok = False
+    print(n, ok)
+
+for n in (20, 100, 1000, 5000):
+    check(n, lambda i: i)
+    check(n, lambda i: 'k%d' % i)
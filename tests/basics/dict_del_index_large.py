@@ -0,0 +1,30 @@
+# deleting from a dict large enough for its hash index slots to take 4 bytes
+
+n = 44000
+try:
+    d = dict.fromkeys(range(n))
+except MemoryError:
+    print('SKIP')
+    raise SystemExit
+
+# delete every other key
+for i in range(0, n, 2):
+    del d[i]
+ok = len(d) == n // 2
+for i in range(n):
+    if (i in d) != (i % 2 == 1):
+        ok = False
+
+# deleted keys go at the end when added again
+for i in range(0, n, 2):
+    d[i] = i
+expect = 1
+for k in d:
+    if k != expect:
+        ok = False
+    expect += 2
+    if expect == n + 1:
+        expect = 0
+for i in range(n):
+    del d[i]
+print(ok, len(d))
@@ -0,0 +1,55 @@
+# dicts iterate in insertion order
+
+# deleting keys keeps the order of the rest
+d = {}
+for i in range(20):
+    d[i] = i * i
+for i in range(0, 20, 3):
+    del d[i]
+print(list(d.keys()))
+print(list(d.values()))
+
+# a key that is re-inserted goes at the end, assigning to an existing key
+# keeps its place
+d[0] = 'a'
+d[3] = 'b'
+d[5] = 'c'
+print(list(d.items()))
+
+# order is kept while the table grows, including with non-qstr keys
+d = {}
+for i in range(100):
+    d['key%d' % (i * 37 % 100)] = i
+print(list(d.keys()) == ['key%d' % (i * 37 % 100) for i in range(100)])
+print(list(d.values()) == list(range(100)))
+
+# and when it's rebuilt after many deletes
+for i in range(100):
+    if i % 4 != 0:
+        del d['key%d' % (i * 37 % 100)]
+for i in range(200, 230):
+    d[i] = i
+print(list(d.values()) == list(range(0, 100, 4)) + list(range(200, 230)))
+
+# popitem removes the last item
+d = {'a': 1, 'b': 2, 'c': 3}
+d['d'] = 4
+del d['b']
+d['b'] = 5
+print(d.popitem(), d.popitem(), d.popitem(), d.popitem())
+d = {}
+for i in range(30):
+    d[i] = i
+del d[29]
+print([d.popitem() for i in range(5)], len(d))
+
+# copy keeps the order
+d = {}
+for i in range(50):
+    d[(i * 7) % 50] = i
+del d[7]
+d[7] = 'x'
+c = d.copy()
+print(list(c.items()) == list(d.items()))
+c[100] = 1
+print(list(c.keys())[-3:], list(d.keys())[-2:])
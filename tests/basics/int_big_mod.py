@@ -15,3 +15,8 @@ x = 0x8000000000000000
 print((x + 1) % x)
 x = 0x86c60128feff5330
 print((x + 1) % x)
+
+# modulus with a full most-significant digit
+m = (1 << 149) - 1
+x = m - 1
+print(x * x % m)
@@ -21,3 +21,11 @@ print(i * i)
 print(i * -i)
 print(-i * i)
 print(-i * -i)
+
+# products of large operands, including unbalanced lengths
+a = 0x9e3779b97f4a7c15f39cc0605cedc834 ** 40 + 1
+b = 0xc2b2ae3d27d4eb4f165667b19e3779f9 ** 31 - 1
+print(a * b)
+print(a * -a)
+print(b * (a >> 2000))
+print((a * b) // a == b)
@@ -0,0 +1,26 @@
+# test conversion of large ints to and from strings
+
+# numbers with long runs of zeros and nines, and random-looking digits
+for x in (10 ** 300, 10 ** 1000 - 1, 10 ** 2000 + 1, 7 ** 4000, 3 ** 7000 + 10 ** 1500):
+    for y in (x, -x):
+        s = str(y)
+        print(len(s), s[:20], s[-20:], s.count('0'), int(s) == y)
+
+# round trip in other bases
+x = 5 ** 1500 - 1
+for base in (2, 3, 8, 10, 16, 36):
+    digits = []
+    y = x
+    while y:
+        y, r = divmod(y, base)
+        digits.append('0123456789abcdefghijklmnopqrstuvwxyz'[r])
+    s = ''.join(reversed(digits))
+    print(base, len(s), int(s, base) == x, int('-' + s.upper(), base) == -x)
+print(hex(x)[-20:], oct(-x)[:20], bin(x)[-20:])
+
+# leading zeros
+print(int('0' * 3000 + '123'), int('0' * 2000 + '1' * 2000) == int('1' * 2000))
+
+# thousands separators
+for x in (123456, 10 ** 50, -7 ** 100):
+    print('{:,}'.format(x))
@@ -76,3 +76,10 @@ try:
     exec(r"'\U0000000'")
 except SyntaxError:
     print("SyntaxError")
+
+# tokens longer than the lexer's read buffer
+s = "x" * 200
+exec(s + " = 5\nprint(" + s + ", len('" + s * 5 + "'))")
+print(eval("1" * 200 + "0") % 7)
+exec("# " + "c" * 1000 + "\r\nprint('after comment')")
+exec(" " * 500 + "\r\n" + "\t" * 3 + "\nprint('after spaces')")
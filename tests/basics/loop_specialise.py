@@ -0,0 +1,79 @@
+# test loop and arithmetic sequences that the VM may specialise for small
+# ints, with operands that are not small ints
+
+def count(start, stop, step):
+    i = start
+    n = 0
+    while i < stop:
+        i += step
+        n += 1
+    return i, n
+
+print(count(0, 10, 1))
+print(count(0, 1 << 70, 1 << 67))
+print(count(0.5, 3, 1))
+print(count((1 << 62) - 2, (1 << 62) + 1, 1))
+
+# the same site seeing small ints after a big int
+def dec(x):
+    x -= 1
+    return x
+print(dec(1 << 80), dec(5), dec(-(1 << 80)), dec(0))
+
+# sequences with non-numeric types
+def add(a, b):
+    a += b
+    return a
+print(add([1], [2]), add('a', 'b'), add(1, 2))
+l = [1]
+l2 = l
+l2 += [3]
+print(l, l2 is l)
+
+def cmp(a, b):
+    r = []
+    while a < b:
+        r.append(a)
+        a = a + 1
+    return r
+print(cmp(0, 3), cmp(2.5, 4), cmp(1 << 65, (1 << 65) + 2))
+print(cmp(0, 3))
+
+# range loops with small and big bounds and negative steps
+for start, stop, step in ((0, 5, 2), (5, 0, -2), (-3, 3, 1)):
+    print([i for i in range(start, stop, step)])
+def fr(n):
+    r = 0
+    for i in range(n):
+        r += i
+    return r
+print(fr(10), fr(1 << 2), fr(0))
+
+# for loops over a range object and other iterables at the same site
+def it(seq):
+    r = []
+    for x in seq:
+        r.append(x)
+    return r
+print(it(range(3)), it([4, 5]), it(iter(range(2, 6, 2))), it('ab'), it(range(3)))
+
+# comparisons of locals feeding conditional jumps
+def minmax(a, b):
+    if a <= b:
+        lo = a
+    else:
+        lo = b
+    if a != b:
+        return lo, True
+    return lo, False
+print(minmax(1, 2), minmax(2, 1), minmax(2, 2), minmax('a', 'b'), minmax(1, 1.5))
+
+# unbound local in a specialised sequence
+def unbound():
+    try:
+        while x < 10:
+            pass
+    except NameError:
+        print('NameError')
+    x = 1
+unbound()
@@ -0,0 +1,29 @@
+# lookups in ordered maps whose cached positions are out of date
+
+# keyword arguments to builtins are looked up in a map over the arguments on
+# the stack, which is at the same place for calls with different keywords
+l = [3, 1, 2]
+neg = lambda x: -x
+for i in range(3):
+    print(sorted(l, key=neg, reverse=True), sorted(l, reverse=True, key=neg))
+    print(sorted(l, reverse=True), sorted(l, key=neg), sorted(l))
+    print(1, 2, sep='-', end='|\n')
+    print(1, 2, end='|\n', sep='+')
+    print(1, 2, end='|\n')
+    print(1, 2, sep='*')
+    l.sort(key=neg)
+    print(l)
+    l.sort(reverse=True, key=neg)
+    print(l)
+
+# a keyword which isn't accepted is still reported
+for i in range(2):
+    try:
+        sorted(l, reverse=True, kye=neg)
+    except TypeError:
+        print('TypeError')
+
+# the same names looked up in several const dicts
+import sys
+for i in range(3):
+    print(type(sys.version), hasattr(list, 'append'), 'x'.join(['a', 'b']), [].count(1))
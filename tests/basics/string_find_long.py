@@ -0,0 +1,17 @@
+# test searching long strings and bytes, where a skip table is used
+
+s = ''.join(['abcab'[(i * 7) % 5] for i in range(600)]) + 'xyzab' + 'abc' * 100
+for needle in ('x', 'xyz', 'bca', 'abcabc', 'zab', 'cab' * 90, 'q', 'abcq', s[100:400], s[-300:]):
+    print(len(needle), s.find(needle), s.rfind(needle), s.count(needle))
+    print(s.find(needle, 50, 700), s.rfind(needle, 50, 700))
+    print(len(s.split(needle)), len(s.rsplit(needle, 3)), len(s.replace(needle, '-')))
+    print(s.partition(needle)[2][:10], s.rpartition(needle)[0][-10:])
+    print(needle in s)
+
+b = bytes(range(256)) * 3
+for needle in (b'\x00', b'\xff\x00\x01', bytes(range(250, 256)), b'\x05' * 2, bytes(range(100)) * 3):
+    print(b.find(needle), b.rfind(needle), b.count(needle), needle in b)
+
+# needle longer than 255 bytes, with repeats
+s = 'a' * 1000 + 'b' + 'a' * 300
+print(s.find('a' * 300 + 'b'), s.rfind('b' + 'a' * 300), s.rfind('a' * 300), s.count('a' * 299))
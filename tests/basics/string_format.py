@@ -74,3 +74,8 @@ print("{text:{align}{width}}".format(text="foo", align=">", width=30))
 print("{foo}/foo".format(foo="bar"))
 print("{}".format(123, foo="bar"))
 print("{}-{foo}".format(123, foo="bar"))
+
+# literal text around fields, and long format specifiers
+print("abc{}def{{ghi}}jkl{!r}mno".format(1, "x"))
+print("{:*>+0000000015,d}|{:*>+00000000016,d}|{:*>+000000000017,d}".format(1000, 2000, 3000))
+print("{:{}>20}".format('x', '-'))
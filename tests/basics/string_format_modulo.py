@@ -100,3 +100,8 @@ try:
     'a%' % 1
 except ValueError:
     print('ValueError')
+
+# literal text around fields, with and without padding
+print('abc%sdef%rghi%%jkl' % ('x', 'y'))
+print('[%5s][%-5s][%.2s][%s]' % ('ab', 'cd', 'efg', 123))
+print(b'a%sb%5sc' % (b'x', b'y'))
@@ -0,0 +1,48 @@
+# test building up long str/bytes with +=, including objects that share data
+
+s = ''
+keep = []
+for i in range(100):
+    s += 'item%d,' % i
+    if i % 30 == 0:
+        keep.append(s)
+print(len(s), s == ''.join(['item%d,' % i for i in range(100)]))
+print([len(k) for k in keep])
+
+# extending an older prefix must not affect the newer one or vice versa
+t = keep[1]
+t += 'X' * 40
+u = keep[1]
+u += 'Y' * 40
+print(t[-45:])
+print(u[-45:])
+print(keep[1][-8:], s[-8:])
+
+# appending to itself
+x = 'a' * 40
+x += x
+x += x
+print(len(x), x == 'a' * 160)
+
+# hash and equality of the results
+d = {s: 1, t: 2}
+print(d[''.join(['item%d,' % i for i in range(100)])], d[keep[1] + 'X' * 40])
+
+# bytes
+b = b''
+for i in range(50):
+    b += bytes([i, i, i])
+c = b
+c += b
+print(len(b), len(c), c[:150] == b, b[-6:])
+
+# prefix used where a null-terminated string is needed
+try:
+    import ustruct as struct
+except ImportError:
+    import struct
+fmt = '<'
+fmt += 'B' * 40
+fmt2 = fmt
+fmt2 += 'I' * 8
+print(struct.calcsize(fmt), struct.calcsize(fmt2))
@@ -0,0 +1,22 @@
+# Compiler
+# Compile a large generated module, with long names, comments and strings.
+import bench
+
+def make_src():
+    lines = []
+    for i in range(100):
+        lines.append('# function number %d, with a comment that takes up most of the line' % i)
+        lines.append('def function_number_%d(argument_one, argument_two=%d):' % (i, i * 12345))
+        lines.append('    """Docstring for function %d, describing what it does."""' % i)
+        lines.append('    local_value = argument_one + argument_two * 3.25 - 0x%x' % i)
+        lines.append("    message = 'value of %s is %d' % ('local_value', local_value)")
+        lines.append('    return [local_value, message, {"key_%d": argument_two}]' % i)
+        lines.append('')
+    return '\n'.join(lines)
+
+def test(num):
+    src = make_src()
+    for i in iter(range(num // 200000)):
+        compile(src, 'bench', 'exec')
+
+bench.run(test)
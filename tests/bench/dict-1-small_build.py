@@ -0,0 +1,14 @@
+# Dict operations
+# Build many small dicts by insertion and read them back, as decoding JSON
+# objects does.
+import bench
+
+def test(num):
+    keys = ('id', 'name', 'value', 'unit', 'ts')
+    for i in iter(range(num // 100)):
+        d = {}
+        for k in keys:
+            d[k] = i
+        a = d['unit']
+
+bench.run(test)
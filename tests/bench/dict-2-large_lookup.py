@@ -0,0 +1,13 @@
+# Dict operations
+# Look up keys, both present and missing, in a large dict.
+import bench
+
+def test(num):
+    d = {}
+    for i in range(1000):
+        d[i * 2] = i
+    for i in iter(range(num // 40)):
+        a = (i & 1023) * 2 in d
+        a = (i & 1023) * 2 + 1 in d
+
+bench.run(test)
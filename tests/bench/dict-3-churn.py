@@ -0,0 +1,13 @@
+# Dict operations
+# Add and remove keys, keeping the dict at the same size, as a cache does.
+import bench
+
+def test(num):
+    d = {}
+    for i in range(100):
+        d[i] = i
+    for i in iter(range(100, num // 20)):
+        d[i] = i
+        del d[i - 100]
+
+bench.run(test)
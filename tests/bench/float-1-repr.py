@@ -0,0 +1,12 @@
+# Float conversion
+# Convert floats with full and short decimal expansions to strings.
+import bench
+
+def test(num):
+    vals = [1 / 3, 2 ** 0.5, 1e-7, 123.25, 6.02214076e23, 0.1, 2.5e-300]
+    for i in iter(range(num // 200)):
+        for x in vals:
+            s = repr(x)
+            s = str(-x)
+
+bench.run(test)
@@ -0,0 +1,12 @@
+# Float conversion
+# Parse decimal strings with short and full-precision mantissas to floats.
+import bench
+
+def test(num):
+    strs = ['0.3333333333333333', '1.4142135623730951', '1e-07', '123.25',
+            '6.02214076e+23', '0.1', '2.5e-300', '-17']
+    for i in iter(range(num // 200)):
+        for s in strs:
+            x = float(s)
+
+bench.run(test)
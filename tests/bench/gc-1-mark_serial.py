@@ -0,0 +1,16 @@
+# Garbage collection
+# Time collections while the amount of live data grows, marking with
+# a single thread.
+import bench
+import gc
+
+def test(num):
+    root = []
+    for i in range(num // 2000000):
+        for j in range(300):
+            root.append([j, (j, 'x'), {j: j}])
+        for k in range(20):
+            gc.collect()
+
+gc.mark_threads(1)
+bench.run(test)
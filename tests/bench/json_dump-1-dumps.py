@@ -0,0 +1,12 @@
+# Serialising a list of records to JSON
+# Render to a str with dumps(); needs the whole text in the heap.
+import bench
+import ujson
+
+DATA = [{"id": i, "name": "sensor%d" % i, "vals": [i, i * 2, None]} for i in range(200)]
+
+def test(num):
+    for i in iter(range(num // 40000)):
+        s = ujson.dumps(DATA)
+
+bench.run(test)
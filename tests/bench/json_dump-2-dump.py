@@ -0,0 +1,16 @@
+# Serialising a list of records to JSON
+# Stream to a preallocated BytesIO with dump(); no per-call text buffer.
+import bench
+import ujson
+import uio
+
+DATA = [{"id": i, "name": "sensor%d" % i, "vals": [i, i * 2, None]} for i in range(200)]
+
+def test(num):
+    f = uio.BytesIO()
+    ujson.dump(DATA, f)
+    for i in iter(range(num // 40000)):
+        f.seek(0)
+        ujson.dump(DATA, f)
+
+bench.run(test)
@@ -0,0 +1,15 @@
+# Parsing a JSON array of records from a stream
+# Build the whole object tree with load(), then walk it.
+import bench
+import ujson
+import uio
+
+TEXT = ujson.dumps([{"id": i, "name": "sensor%d" % i, "vals": [i, i * 2, None]} for i in range(200)])
+
+def test(num):
+    for i in iter(range(num // 40000)):
+        total = 0
+        for rec in ujson.load(uio.BytesIO(TEXT)):
+            total += rec["id"]
+
+bench.run(test)
@@ -0,0 +1,20 @@
+# Parsing a JSON array of records from a stream
+# Handle one event at a time with iterparse(); no tree is built.
+import bench
+import ujson
+import uio
+
+TEXT = ujson.dumps([{"id": i, "name": "sensor%d" % i, "vals": [i, i * 2, None]} for i in range(200)])
+
+def test(num):
+    for i in iter(range(num // 40000)):
+        total = 0
+        key = None
+        for ev, val in ujson.iterparse(uio.BytesIO(TEXT)):
+            if ev == "map_key":
+                key = val
+            elif key == "id":
+                total += val
+                key = None
+
+bench.run(test)
@@ -0,0 +1,12 @@
+# Map lookup in const dicts
+# Load names that are found in the builtins module, after a miss in globals
+import bench
+
+def test(num):
+    for i in iter(range(num // 10)):
+        a = zip
+        a = sorted
+        a = isinstance
+        a = setattr
+
+bench.run(test)
@@ -0,0 +1,14 @@
+# Map lookup in const dicts
+# Load attributes of a builtin module
+import bench
+import math
+
+def test(num):
+    m = math
+    for i in iter(range(num // 10)):
+        a = m.sqrt
+        a = m.tan
+        a = m.degrees
+        a = m.isnan
+
+bench.run(test)
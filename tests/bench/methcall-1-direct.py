@@ -0,0 +1,14 @@
+# Method call overhead test
+# Call a method defined directly on the instance's class
+import bench
+
+class Foo:
+    def f(self, x):
+        return x + 1
+
+def test(num):
+    o = Foo()
+    for i in iter(range(num)):
+        a = o.f(i)
+
+bench.run(test)
@@ -0,0 +1,23 @@
+# Method call overhead test
+# Call a method defined 3 levels up the class hierarchy
+import bench
+
+class A:
+    def f(self, x):
+        return x + 1
+
+class B(A):
+    pass
+
+class C(B):
+    pass
+
+class D(C):
+    pass
+
+def test(num):
+    o = D()
+    for i in iter(range(num)):
+        a = o.f(i)
+
+bench.run(test)
@@ -0,0 +1,18 @@
+# Method call overhead test
+# Call site that alternates between instances of 2 different classes
+import bench
+
+class A:
+    def f(self, x):
+        return x + 1
+
+class B(A):
+    def f(self, x):
+        return x + 2
+
+def test(num):
+    objs = (A(), B())
+    for i in iter(range(num)):
+        a = objs[i & 1].f(i)
+
+bench.run(test)
@@ -0,0 +1,16 @@
+# Method call overhead test
+# Load a class-level constant through the instance inside a method
+import bench
+
+class Foo:
+    STEP = 1
+
+    def f(self, x):
+        return x + self.STEP
+
+def test(num):
+    o = Foo()
+    for i in iter(range(num)):
+        a = o.f(i)
+
+bench.run(test)
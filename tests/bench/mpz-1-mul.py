@@ -0,0 +1,12 @@
+# Arbitrary precision integers
+# Multiply pairs of 256 to 4096 bit integers.
+import bench
+
+def test(num):
+    vals = [((1 << bits) - 1) // 3 for bits in (256, 512, 1024, 2048, 4096)]
+    for i in iter(range(num // 4000)):
+        for a in vals:
+            b = a * (a + 1)
+            b = a * (a >> 64)
+
+bench.run(test)
@@ -0,0 +1,11 @@
+# Arbitrary precision integers
+# Divide 512 to 8192 bit integers by ones of half the size.
+import bench
+
+def test(num):
+    vals = [((1 << bits) - 1) // 3 for bits in (256, 512, 1024, 2048, 4096)]
+    for i in iter(range(num // 4000)):
+        for a in vals:
+            q, r = divmod(a * a + 12345, a - 1)
+
+bench.run(test)
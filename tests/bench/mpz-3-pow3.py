@@ -0,0 +1,13 @@
+# Arbitrary precision integers
+# Modular exponentiation with 256 to 4096 bit odd moduli, as used by RSA.
+import bench
+
+def test(num):
+    for bits, n in ((256, 400), (512, 100), (1024, 16), (2048, 2), (4096, 1)):
+        m = ((1 << bits) - 1) // 3 | 1
+        b = m // 7 + 1
+        e = (m * 0x9e3779b97f4a7c15 >> 64) ^ (m // 7)
+        for i in iter(range(n * num // 20000000)):
+            r = pow(b, e, m)
+
+bench.run(test)
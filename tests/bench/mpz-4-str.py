@@ -0,0 +1,12 @@
+# Arbitrary precision integers
+# Convert 100 to 3000 digit integers to and from decimal strings.
+import bench
+
+def test(num):
+    vals = [7 ** (digits * 100 // 84) + 1 for digits in (100, 300, 1000, 3000)]
+    for i in iter(range(num // 200000)):
+        for a in vals:
+            s = str(a)
+            b = int(s)
+
+bench.run(test)
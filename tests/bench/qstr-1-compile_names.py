@@ -0,0 +1,11 @@
+# Interning of identifiers
+# Compile a module that uses many distinct names, as importing a large
+# module does, so that each identifier is looked up in the qstr pools.
+import bench
+
+def test(num):
+    src = ''.join('name_%d = len(str(%d))\n' % (i, i) for i in range(3000))
+    for i in range(num // 2000000):
+        exec(compile(src, 'mod', 'exec'), {})
+
+bench.run(test)
@@ -0,0 +1,15 @@
+# Interning of identifiers
+# Look up attributes of builtin objects by name, which interns each name
+# and finds it among the qstrs built into the firmware.
+import bench
+
+def test(num):
+    # build the names at runtime so they aren't already interned
+    NAMES = [s + '_' for s in ('append', 'startswith', 'to_bytes', 'setdefault', 'difference_update')]
+    NAMES = [s[:-1] for s in NAMES]
+    l = []
+    for i in range(num // 200):
+        for name in NAMES:
+            hasattr(l, name)
+
+bench.run(test)
@@ -0,0 +1,14 @@
+# Line-oriented reading of an in-memory log
+# Plain BytesIO, whose readline() reads one byte per stream call.
+import bench
+import uio
+
+DATA = b"".join(b"2017-01-01 00:00:%02d INFO sensor %d reading %d\n" % (i % 60, i % 7, i * 13) for i in range(500))
+
+def test(num):
+    for i in iter(range(num // 20000)):
+        f = uio.BytesIO(DATA)
+        for line in f:
+            pass
+
+bench.run(test)
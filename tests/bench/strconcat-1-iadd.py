@@ -0,0 +1,12 @@
+# String concatenation
+# Build up a large response with += on str, which should be linear in length.
+import bench
+
+def test(num):
+    for i in iter(range(num // 400000)):
+        s = ''
+        for j in range(500):
+            s += 'HTTP/1.1 200 OK, item '
+            s += str(j)
+
+bench.run(test)
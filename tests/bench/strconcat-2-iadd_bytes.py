@@ -0,0 +1,12 @@
+# String concatenation
+# Accumulate a large bytes payload with += from fixed-size chunks.
+import bench
+
+def test(num):
+    chunk = b'0123456789abcdef' * 4
+    for i in iter(range(num // 400000)):
+        b = b''
+        for j in range(500):
+            b += chunk
+
+bench.run(test)
@@ -0,0 +1,10 @@
+# String formatting
+# Format log lines with str.format using plain and padded fields.
+import bench
+
+def test(num):
+    name = 'sensor'
+    for i in iter(range(num // 100)):
+        s = '[{}] {}: reading {} of {:>6} ok'.format(i, name, i & 15, i)
+
+bench.run(test)
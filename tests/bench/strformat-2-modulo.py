@@ -0,0 +1,10 @@
+# String formatting
+# Format log lines with the % operator.
+import bench
+
+def test(num):
+    name = 'sensor'
+    for i in iter(range(num // 100)):
+        s = '[%d] %s: reading %d of %6d ok' % (i, name, i & 15, i)
+
+bench.run(test)
@@ -0,0 +1,11 @@
+# String formatting
+# Join a list of fields into a line, as for a CSV record.
+import bench
+
+def test(num):
+    fields = ['timestamp', '2018-01-01', '12:00:00', 'INFO', 'sensor', 'reading', 'ok']
+    for i in iter(range(num // 100)):
+        s = ','.join(fields)
+        s = ' '.join(x for x in fields)
+
+bench.run(test)
@@ -0,0 +1,11 @@
+# String search
+# Find a header terminator near the end of a large payload.
+import bench
+
+def test(num):
+    s = 'GET /index.html HTTP/1.1\r\nHost: example.com\r\n' * 200 + '\r\n\r\nbody'
+    for i in iter(range(num // 20000)):
+        a = s.find('\r\n\r\n')
+        a = s.find('Content-Length:')
+
+bench.run(test)
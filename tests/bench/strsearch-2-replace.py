@@ -0,0 +1,10 @@
+# String search
+# Replace a word throughout a large log payload.
+import bench
+
+def test(num):
+    s = '2018-01-01 12:00:00 INFO request handled in 12ms by worker 3\n' * 100
+    for i in iter(range(num // 20000)):
+        a = s.replace('worker', 'thread')
+
+bench.run(test)
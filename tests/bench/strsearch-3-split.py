@@ -0,0 +1,12 @@
+# String search
+# Split a large payload on a multi-byte separator.
+import bench
+
+def test(num):
+    s = 'name=value; path=/; expires=never' * 40 + '\r\n'
+    s = s * 20
+    for i in iter(range(num // 20000)):
+        a = s.split('\r\n')
+        a = s.rsplit('; ', 10)
+
+bench.run(test)
@@ -0,0 +1,29 @@
+try:
+    from uio import StringIO
+    import ujson as json
+except:
+    try:
+        from io import StringIO
+        import json
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+for sep in [None, (", ", ": "), (",", ":"), (";", "=")]:
+    print(json.dumps([1, (2, {"a": 3}), "b"], separators=sep))
+    s = StringIO()
+    json.dump({"x": [None, True, 1.5, "long string " * 10]}, s, separators=sep)
+    print(s.getvalue())
+
+# separators must be a pair of strings
+for sep in [(",",), 1]:
+    try:
+        json.dumps(1, separators=sep)
+    except (TypeError, ValueError):
+        print("Error")
+
+# separators is keyword-only
+try:
+    json.dumps(1, (",", ":"))
+except TypeError:
+    print("TypeError")
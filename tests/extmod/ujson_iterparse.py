@@ -0,0 +1,39 @@
+try:
+    from uio import StringIO
+    import ujson as json
+    json.iterparse
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+def show(src):
+    try:
+        for ev in json.iterparse(src):
+            print(ev)
+    except ValueError:
+        print("ValueError")
+
+show('{"a": [1, 2.5, "x"], "b": {"c": null}, "d": true, "e": []}')
+show(StringIO('[{}, [[false]], -3]'))
+show(' 12 ')
+show('"str"')
+
+# events are produced lazily
+it = json.iterparse(StringIO('[1, 2, 3'))
+print(next(it), next(it))
+
+# the stream is read in blocks, so values may straddle them
+n = 0
+total = 0
+for ev, val in json.iterparse(StringIO('[' + ', '.join([str(i * 1001) for i in range(200)]) + ']')):
+    if ev == 'number':
+        n += 1
+        total += val
+print(n, total)
+
+# malformed documents
+show('')
+show('[1, 2')
+show('[1]]')
+show('[1] 2')
+show('{[]: 1}')
@@ -0,0 +1,60 @@
+try:
+    import uzlib as zlib
+    import uio as io
+    zlib.compress
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+# small inputs give the same bitstream as CPython's zlib
+print(zlib.compress(b''))
+print(zlib.compress(b'a'))
+print(zlib.compress(b'hello', -1, -15))
+
+data = b'hello hello hello world ' * 50 + bytes(range(256)) + b'x' * 1000
+for wbits in (9, 12, 15, -9, -15):
+    for level in (0, 1, 6, 9):
+        c = zlib.compress(data, level, wbits)
+        print(wbits, level, zlib.decompress(c, wbits) == data, len(c) < len(data) or level == 0)
+
+# gzip framing, read back with DecompIO
+c = zlib.compress(data, -1, 31)
+print(c[:3], zlib.DecompIO(io.BytesIO(c), 31).read() == data)
+
+# input longer than the window, so the window slides
+long_data = bytes([(i * i) >> 3 & 0xff for i in range(3000)]) * 4
+c = zlib.compress(long_data, 6, 9)
+print(zlib.decompress(c, 9) == long_data)
+
+# streaming with flush and close
+buf = io.BytesIO()
+with zlib.CompIO(buf) as z:
+    z.write(b'hello ')
+    z.flush()
+    print(buf.getvalue()[-4:])
+    inp = zlib.DecompIO(io.BytesIO(buf.getvalue()))
+    print(inp.read(6))
+    for i in range(100):
+        z.write(b'world %d ' % i)
+c = buf.getvalue()
+print(zlib.decompress(c) == b'hello ' + b''.join([b'world %d ' % i for i in range(100)]))
+
+# gzip stream
+buf = io.BytesIO()
+z = zlib.CompIO(buf, 31)
+z.write(data)
+z.close()
+z.close()
+print(zlib.DecompIO(io.BytesIO(buf.getvalue()), 31).read() == data)
+try:
+    z.write(b'x')
+except OSError:
+    print('OSError')
+
+# invalid arguments
+for args in ((b'', -1, 8), (b'', -1, 16), (b'', 10)):
+    try:
+        zlib.compress(*args)
+    except ValueError:
+        print('ValueError')
@@ -0,0 +1,39 @@
+# test exact conversion of floats to and from strings, requiring double precision
+
+try:
+    import ustruct as struct
+except ImportError:
+    import struct
+
+# shortest round-trip repr is optional
+if repr(0.1 + 0.2) != '0.30000000000000004':
+    print('SKIP')
+    raise SystemExit
+
+# repr gives the shortest string that reads back to the same value
+for x in (0.1, 0.3, 1 / 3, 2 / 3, 2 ** 0.5, 1e22, 1e23, 5e-324, 1.7976931348623157e308,
+        2.2250738585072014e-308, 2.225073858507201e-308, 9007199254740993.0, 123456789.125,
+        0.0001, 0.00001, 1e15, 1e16, 1e-7, 4.35, 0.000123456789012345678):
+    print(repr(x), repr(-x))
+print(repr(1.5 + 0.1j), repr(0.1j))
+
+# parsing is correctly rounded, including halfway cases
+print(float('9007199254740993'))
+print(float('9007199254740993.0000000000000000000000001'))
+print(float('9007199254740995'))
+print(float('2.4703282292062327e-324'), float('2.4703282292062328e-324'))
+print(float('1.7976931348623158e308'), float('1.7976931348623159e308'))
+print(float('0.' + '0' * 300 + '1e300'), float('1' + '0' * 400 + 'e-400'))
+print(float('179769313486231580793728971405301e276'))
+print(float('7.2057594037927933e16'), float('8.988465674311579e307'))
+
+# round trip of a spread of bit patterns
+x = 0x123456789abcdef
+n = 0
+for i in range(2000):
+    x = (x * 6364136223846793005 + 1442695040888963407) & 0xffffffffffffffff
+    f = struct.unpack('<d', struct.pack('<Q', x))[0]
+    if f == f and float(repr(f)) != f:
+        print('fail', repr(f))
+    n += 1
+print(n)
@@ -0,0 +1,38 @@
+try:
+    import uio as io
+except ImportError:
+    import io
+
+try:
+    io.BytesIO
+    io.BufferedReader
+except AttributeError:
+    print('SKIP')
+    raise SystemExit
+
+# lines straddling the buffer, with and without a size limit
+r = io.BufferedReader(io.BytesIO(b"line one\nline two\n\nlast"), 4)
+print(r.peek()[:1])
+print(r.readline())
+print(r.readline(3))
+print(r.readline())
+print(r.read(2))
+print(r.readline())
+print(r.readline())
+
+r = io.BufferedReader(io.BytesIO(b"abc\ndefghijklmnop\nq\n"), 5)
+print(list(r))
+r = io.BufferedReader(io.BytesIO(b"xy\nz"))
+print(r.readlines())
+
+# reads larger than the buffer, readinto, seek and tell
+r = io.BufferedReader(io.BytesIO(b"0123456789" * 3), 8)
+print(r.read(3), r.tell(), r.read(20), r.tell())
+r.seek(5)
+print(r.read(4), r.tell())
+buf = bytearray(12)
+print(r.readinto(buf), buf)
+print(r.read())
+
+with io.BufferedReader(io.BytesIO(b"data")) as r:
+    print(r.read())
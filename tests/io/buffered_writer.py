@@ -25,3 +25,13 @@ bts = io.BytesIO()
 buf = io.BufferedWriter(bts, 1)
 buf.write(b"foo")
 print(bts.getvalue())
+
+# close flushes what is still buffered
+bts = io.BytesIO()
+with io.BufferedWriter(bts, 4) as buf:
+    buf.write(b"abcdef")
+    print(bts.getvalue())
+    buf.write(b"gh")
+    print(buf.tell())
+    v = bts.getvalue()
+print(v)
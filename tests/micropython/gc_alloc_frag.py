@@ -0,0 +1,16 @@
+# small objects which survive many collections mustn't end up spread over the
+# heap, leaving no room for a large allocation
+import gc
+
+gc.collect()
+free = gc.mem_free()
+n = free // 1024
+keep = [None] * (4 * n)
+for i in range(n):
+    for j in range(4):
+        keep[4 * i + j] = i + j + 0.5
+        junk = bytes(16)
+    gc.collect()
+
+b = bytearray(free // 2)
+print(len(b) == free // 2)
@@ -0,0 +1,108 @@
+# test gc.compact() moving objects into free space
+
+import gc
+
+try:
+    gc.compact
+    import ustruct
+except (AttributeError, ImportError):
+    print('SKIP')
+    raise SystemExit
+
+def check_floats(l):
+    for i in range(len(l)):
+        if l[i] != i:
+            return False
+    return True
+
+# fill most of the heap with pairs of objects, then free one of each pair;
+# some memory is left for gc.compact() itself
+keep = []
+junk = []
+try:
+    for i in range(10000):
+        junk.append(bytearray(64))
+        keep.append(float(i))
+except MemoryError:
+    keep.pop()
+junk = None
+
+moved, before, after = gc.compact()
+print(moved > 0, after > before)
+
+# moved objects keep their value and references to them are updated
+print(check_floats(keep))
+l = [1.5, [2, 3], 'abc', b'def', bytearray(b'ghi'), 1 << 100]
+d = {'l': l}
+t = (l, d)
+gc.compact()
+print(d['l'] is l, t[0] is l, t[1] is d, l)
+keep = l = d = t = None
+
+# floats and ints whose value looks like the address of a moved object must
+# not be changed; id() gives the address of an anchor, and the objects which
+# may move are allocated straight after it
+gc.collect()
+junk = [bytearray(64) for i in range(2000)]
+anchor = bytearray(8)
+objs = [[i] for i in range(16)]
+junk = None
+gc.collect()
+base = id(anchor)
+word = ustruct.calcsize('P')
+fmt = 'Q' if word == 8 else 'II'
+addrs = [base + i * word for i in range(512)]
+fakes = []
+for a in addrs:
+    if word == 8:
+        fakes.append(ustruct.unpack('d', ustruct.pack('Q', a))[0])
+    else:
+        fakes.append(ustruct.unpack('d', ustruct.pack('II', a, a))[0])
+ints = [a << 64 | a for a in addrs]
+mixed = list(zip(objs, fakes[:16]))
+moved, before, after = gc.compact()
+print(moved > 0)
+ok = True
+for i in range(len(addrs)):
+    a = addrs[i]
+    b = ustruct.pack('d', fakes[i])
+    if (word == 8 and b != ustruct.pack('Q', a)) or (word == 4 and b != ustruct.pack('II', a, a)):
+        ok = False
+    if ints[i] != a << 64 | a:
+        ok = False
+print(ok)
+for i in range(len(objs)):
+    if objs[i] != [i] or mixed[i][0] is not objs[i]:
+        ok = False
+print(ok)
+
+# the id of an object doesn't change
+gc.collect()
+junk = [bytearray(64) for i in range(2000)]
+x = [1, 2]
+junk = None
+i = id(x)
+gc.compact()
+print(id(x) == i, x)
+
+# likewise when id() is taken after an automatic collection which left the
+# heap only partly swept, so live objects in the rest of it are still marked
+if hasattr(gc, 'sweep_slice'):
+    slice_size = gc.sweep_slice()
+    gc.sweep_slice(16)
+gc.collect()
+junk = [bytearray(64) for i in range(2000)]
+strs = ['str%d' % i for i in range(300)]
+junk = None
+gc.threshold(1)
+x = bytearray(1000)
+gc.threshold(-1)
+ids = [id(s) for s in strs]
+gc.compact()
+ok = True
+for i in range(len(strs)):
+    if id(strs[i]) != ids[i] or strs[i] != 'str%d' % i:
+        ok = False
+print(ok)
+if hasattr(gc, 'sweep_slice'):
+    gc.sweep_slice(slice_size)
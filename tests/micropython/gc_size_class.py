@@ -0,0 +1,66 @@
+# test allocating and freeing across the GC's small size classes
+
+import gc
+import micropython
+
+# this function is not always available
+if not hasattr(micropython, 'mem_info'):
+    print('SKIP')
+    raise SystemExit
+
+# blocks are 16 or 32 bytes, so these data sizes cover runs of 1 to 8 blocks
+SIZES = (1, 20, 40, 70, 100, 130, 160, 200, 250)
+
+def fill(i):
+    return bytearray(bytes((i & 0xff,)) * SIZES[i % len(SIZES)])
+
+def check(chunks):
+    for c in chunks:
+        for i in range(len(c)):
+            if c[i] is not None and c[i] != fill(i):
+                return False
+    return True
+
+# fill the heap so that later allocations must reuse the freed runs
+gc.collect()
+chunks = []
+try:
+    while True:
+        c = [None] * 64
+        chunks.append(c)
+        for i in range(len(c)):
+            c[i] = fill(i)
+except MemoryError:
+    pass
+chunks.pop()
+
+# free runs of every size, then refill them from the size class lists
+for k in range(3):
+    for c in chunks:
+        for i in range(k % 2, len(c), 2):
+            c[i] = None
+    gc.collect()
+    print(check(chunks))
+    try:
+        for c in chunks:
+            for i in range(len(c)):
+                if c[i] is None:
+                    c[i] = fill(i)
+    except MemoryError:
+        pass
+    print(check(chunks))
+
+# shrinking frees a run outside of a sweep
+for c in chunks:
+    for i in range(0, len(c), 3):
+        c[i] = None
+gc.collect()
+for c in chunks:
+    for i in range(0, len(c), 3):
+        b = fill(i) + fill(i)
+        c[i] = b[:len(b) // 2]
+print(check(chunks))
+
+chunks = None
+gc.collect()
+micropython.mem_info()
@@ -0,0 +1,41 @@
+# test lazy sweeping of the heap in small slices
+
+import gc
+
+try:
+    gc.sweep_slice
+except AttributeError:
+    print('SKIP')
+    raise SystemExit
+
+class A:
+    def __init__(self, i):
+        self.i = i
+
+# check configuration of the slice size
+gc.sweep_slice(0)
+print(gc.sweep_slice())
+gc.sweep_slice(1)
+print(gc.sweep_slice() > 0)
+
+# allocate interleaved live and dead objects, then collect and allocate while
+# the sweep is still outstanding
+keep = []
+for i in range(200):
+    keep.append(A(i))
+    [i] * 3
+gc.threshold(1)
+for i in range(200):
+    keep.append((i, str(i)))
+gc.threshold(-1)
+print(sum(a.i for a in keep[:200]), sum(t[0] for t in keep[200:]))
+print(''.join(t[1] for t in keep[200:210]))
+
+gc.collect()
+print(sum(a.i for a in keep[:200]))
+
+gc.sweep_slice(16384)
+
+if hasattr(gc, 'pause_stats'):
+    last, mx = gc.pause_stats()
+    print(last <= mx)
@@ -0,0 +1,47 @@
+# test that readinto() on streams doesn't use the heap
+try:
+    import uio
+    import array
+    from micropython import heap_lock, heap_unlock
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# cycle through the buffers until the stream is exhausted
+def read_loop(f, bufs):
+    total = 0
+    i = 0
+    while True:
+        n = f.readinto(bufs[i % len(bufs)])
+        if not n:
+            return total
+        total += n
+        i += 1
+
+buf = bytearray(7)
+ar = array.array('b', [0] * 5)
+mv = memoryview(buf)
+bufs = (buf, ar, mv[2:], mv[:3])
+data = b"0123456789" * 10
+
+f = uio.BytesIO(data)
+heap_lock()
+n = read_loop(f, bufs)
+heap_unlock()
+print(n, buf)
+
+try:
+    f = uio.BufferedReader(uio.BytesIO(data), 16)
+except AttributeError:
+    f = uio.BytesIO(data)
+heap_lock()
+n = read_loop(f, bufs)
+heap_unlock()
+print(n, buf)
+
+# a limited length read into part of the buffer
+f = uio.BytesIO(data)
+heap_lock()
+n = f.readinto(buf, 2)
+heap_unlock()
+print(n, buf)
@@ -0,0 +1,35 @@
+# mp_obj_str_get_str on strings built with += while the heap is locked
+import micropython
+
+try:
+    import ustruct as struct
+except ImportError:
+    import struct
+
+def test():
+    fmt = '<'
+    fmt += 'B' * 40
+    older = fmt
+    fmt += 'I' * 8
+    n1 = n2 = n3 = 0
+
+    # the most recently built string is null terminated
+    micropython.heap_lock()
+    n1 = struct.calcsize(fmt)
+    micropython.heap_unlock()
+
+    # an older one sharing its buffer may need a terminated copy, but only once
+    micropython.heap_lock()
+    try:
+        n2 = struct.calcsize(older)
+    except MemoryError:
+        pass
+    micropython.heap_unlock()
+    n2 = struct.calcsize(older)
+    micropython.heap_lock()
+    n3 = struct.calcsize(older)
+    micropython.heap_unlock()
+
+    print(n1, n2, n3)
+
+test()
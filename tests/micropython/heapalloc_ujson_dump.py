@@ -0,0 +1,30 @@
+# test that ujson.dump() to a stream doesn't use the heap
+try:
+    import ujson
+    import uio
+    from micropython import heap_lock, heap_unlock
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+data = [{"id": [i, "name%d" % i, None, True]} for i in range(20)]
+compact = (',', ':')
+
+# a stream which already has room for the output, so writes don't allocate
+s = uio.BytesIO()
+s.write(bytes(1000))
+s.seek(0)
+
+n = 0
+heap_lock()
+ujson.dump(data, s)
+n = s.seek(0, 1)
+heap_unlock()
+print(s.getvalue()[:n])
+
+s.seek(0)
+heap_lock()
+ujson.dump(data, s, separators=compact)
+n = s.seek(0, 1)
+heap_unlock()
+print(s.getvalue()[:n])
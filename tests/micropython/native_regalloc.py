@@ -0,0 +1,66 @@
+# test register allocation of locals and the small int fast paths in native code
+
+# more locals than registers, with the most used ones not the first
+@micropython.native
+def f(n):
+    a = 0
+    b = 1
+    c = 2
+    d = 3
+    e = 4
+    g = 5
+    h = 6
+    for i in range(n):
+        h += 1
+        g = g + h
+        e = e - i
+        d += e
+        c = c + d
+        b -= c
+    return a, b, c, d, e, g, h
+print(f(10))
+
+# a local updated inside a try must keep its value in the handler
+@micropython.native
+def f(x):
+    y = 0
+    try:
+        y = x
+        raise ValueError
+    except ValueError:
+        return y
+print(f(5))
+
+# add and subtract that overflow a small int
+@micropython.native
+def f(a, b):
+    return a + b, a - b, b - a
+print(f(1 << 61, 1 << 61))
+print(f(-(1 << 61), 1 << 61))
+print(f(3, -4))
+
+# comparisons, for small ints and other objects
+@micropython.native
+def f(a, b):
+    return a < b, a > b, a == b, a <= b, a >= b, a != b
+print(f(1, 2))
+print(f(-2, -2))
+print(f(1.5, 1))
+print(f('a', 'b'))
+
+# conditions on comparison results and other objects
+@micropython.native
+def f(x):
+    if x:
+        return 1
+    return 0
+print(f(1 < 2), f(1 > 2), f([]), f([1]), f(None))
+
+# viper with arguments in registers and a pointer index
+@micropython.viper
+def f(src:ptr8, n:int) -> int:
+    s = 0
+    for i in range(n):
+        s += src[i] + src[0]
+    return s
+print(f(bytearray(b'1234'), 4))
@@ -0,0 +1,138 @@
+# test viper loops over pointers that the emitter may vectorise
+# each result is checked against the same loop run as ordinary Python
+
+@micropython.viper
+def add8(d:ptr8, s:ptr8, t:ptr8, n:int):
+    for i in range(n):
+        d[i] = s[i] + t[i]
+
+@micropython.viper
+def sub16_k(d:ptr16, s:ptr16, k:int, n:int):
+    for i in range(n):
+        d[i] = s[i] - k
+
+@micropython.viper
+def xor32_inplace(d:ptr32, k:int, n:int):
+    for i in range(n):
+        d[i] ^= k
+
+@micropython.viper
+def and8(d:ptr8, s:ptr8, t:ptr8, n:int):
+    for i in range(n):
+        d[i] = s[i] & t[i]
+
+@micropython.viper
+def or16(d:ptr16, s:ptr16, n:int):
+    for i in range(n):
+        d[i] |= s[i]
+
+@micropython.viper
+def copy8(d:ptr8, s:ptr8, a:int, b:int):
+    for i in range(a, b):
+        d[i] = s[i]
+
+@micropython.viper
+def copy8_overlap(b:ptr8, d_off:int, s_off:int, n:int):
+    d = ptr8(int(b) + d_off)
+    s = ptr8(int(b) + s_off)
+    for i in range(n):
+        d[i] = s[i]
+
+@micropython.viper
+def sum8(s:ptr8, n:int) -> int:
+    acc = 0
+    for i in range(n):
+        acc += s[i]
+    return acc
+
+@micropython.viper
+def last_index(d:ptr8, n:int) -> int:
+    i = -1
+    for i in range(n):
+        d[i] += 1
+    return i
+
+def add8_py(d, s, t, n):
+    for i in range(n):
+        d[i] = (s[i] + t[i]) & 0xff
+
+def sub16_k_py(d, s, k, n):
+    for i in range(n):
+        d[i] = (s[i] - k) & 0xffff
+
+def xor32_inplace_py(d, k, n):
+    for i in range(n):
+        d[i] = (d[i] ^ k) & 0xffffffff
+
+def and8_py(d, s, t, n):
+    for i in range(n):
+        d[i] = s[i] & t[i]
+
+def or16_py(d, s, n):
+    for i in range(n):
+        d[i] |= s[i]
+
+def copy8_py(d, s, a, b):
+    for i in range(a, b):
+        d[i] = s[i]
+
+def sum8_py(s, n):
+    acc = 0
+    for i in range(n):
+        acc += s[i]
+    return acc
+
+import array
+
+def data(typecode, n, seed):
+    return array.array(typecode, [(seed * 97 + i * 31) * 0x01010101 & 0xffffffff for i in range(n)])
+
+ok = True
+for n in range(0, 41):
+    for typecode, ops in (
+        ('B', ((add8, add8_py, 2), (and8, and8_py, 2))),
+        ('H', ((or16, or16_py, 1),)),
+    ):
+        for f, f_py, n_src in ops:
+            d1 = data(typecode, n, 1)
+            d2 = data(typecode, n, 1)
+            srcs = [data(typecode, n, 2 + j) for j in range(n_src)]
+            f(d1, *(srcs + [n]))
+            f_py(d2, *(srcs + [n]))
+            ok = ok and d1 == d2
+    for k in (0, 1, 0x1234, -7):
+        d1 = data('H', n, 1)
+        d2 = data('H', n, 1)
+        s = data('H', n, 2)
+        sub16_k(d1, s, k, n)
+        sub16_k_py(d2, s, k, n)
+        ok = ok and d1 == d2
+        d1 = data('I', n, 3)
+        d2 = data('I', n, 3)
+        xor32_inplace(d1, k, n)
+        xor32_inplace_py(d2, k, n)
+        ok = ok and d1 == d2
+    s = data('B', n, 4)
+    ok = ok and sum8(s, n) == sum8_py(s, n)
+print(ok)
+
+# overlapping source and destination must behave as the scalar loop does
+for off in range(-20, 21):
+    b1 = bytearray(range(80))
+    b2 = bytearray(range(80))
+    d, s = (off, 0) if off >= 0 else (0, -off)
+    copy8_overlap(b1, d, s, 50)
+    for i in range(50):
+        b2[d + i] = b2[s + i]
+    if b1 != b2:
+        print('overlap', off)
+
+# a range with a start, and the final value of the loop variable
+b1 = bytearray(range(64))
+b2 = bytearray(range(64))
+copy8(b1, bytearray(range(100, 164)), 3, 60)
+copy8_py(b2, bytearray(range(100, 164)), 3, 60)
+print(b1 == b2)
+b = bytearray(40)
+print(last_index(b, 40), last_index(b, 0), sum(b))
+print(sum8(bytearray(b'\xff' * 1000), 1000))
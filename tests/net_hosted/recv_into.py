@@ -0,0 +1,53 @@
+# test receiving into a preallocated buffer, without using the heap
+
+try:
+    import usocket as socket
+except:
+    import socket
+
+try:
+    from micropython import heap_lock, heap_unlock
+except (ImportError, AttributeError):
+    heap_lock = heap_unlock = lambda:0
+
+addr = socket.getaddrinfo('127.0.0.1', 8124)[0][-1]
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.bind(addr)
+s.connect(addr)
+
+buf = bytearray(8)
+mv = memoryview(buf)
+tail = mv[4:]
+
+# full buffer, length limit, and a memoryview slice
+for i in range(3):
+    s.send(b'packet%d' % i)
+n0 = n1 = n2 = 0
+heap_lock()
+n0 = s.recv_into(buf)
+n1 = s.recv_into(buf, 3)
+n2 = s.recv_into(tail)
+heap_unlock()
+print(n0, n1, n2, buf)
+
+# steady-state receive loop
+total = 0
+i = 0
+while i < 10:
+    s.send(b'abcdefgh')
+    heap_lock()
+    total += s.recv_into(mv)
+    heap_unlock()
+    i += 1
+print(total, buf)
+
+s.send(b'xyz')
+n, peer = s.recvfrom_into(buf)
+print(n, buf)
+
+try:
+    s.recv_into(buf, 9)
+except ValueError:
+    print('ValueError')
+
+s.close()
@@ -0,0 +1,44 @@
+# stress test for allocating small objects from several threads at once
+#
+# Run with an argument, eg "micropython stress_alloc.py bench", to instead
+# print allocation throughput for an increasing number of threads.
+
+import sys
+try:
+    import utime as time
+except ImportError:
+    import time
+import _thread
+
+def thread_entry(n, res, idx):
+    total = 0
+    for i in range(n):
+        l = [i, i + 1]
+        t = (l, str(i))
+        total += t[0][1] - t[0][0]
+    with lock:
+        res[idx] = total
+        global n_finished
+        n_finished += 1
+
+def run(n_thread, n):
+    global n_finished
+    n_finished = 0
+    res = [0] * n_thread
+    for i in range(n_thread):
+        _thread.start_new_thread(thread_entry, (n, res, i))
+    while n_finished < n_thread:
+        time.sleep(0.01)
+    return res
+
+lock = _thread.allocate_lock()
+
+if len(sys.argv) > 1:
+    n = 50000
+    for n_thread in (1, 2, 4, 8):
+        t = time.ticks_ms()
+        run(n_thread, n)
+        t = time.ticks_diff(time.ticks_ms(), t)
+        print('%d threads: %d allocs/ms' % (n_thread, 3 * n * n_thread // max(t, 1)))
+else:
+    print(run(4, 10000) == [10000] * 4)
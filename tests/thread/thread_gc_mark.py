@@ -0,0 +1,40 @@
+# test marking the heap with several threads
+
+import gc
+
+try:
+    gc.mark_threads
+except AttributeError:
+    print('SKIP')
+    raise SystemExit
+
+# a long chain and a wide list, to overflow the mark stacks and share work
+def build(n):
+    chain = None
+    for i in range(n):
+        chain = (chain, str(i))
+    wide = [[i, {i: str(i)}] for i in range(n)]
+    return chain, wide
+
+def check(data, n):
+    chain, wide = data
+    for i in range(n - 1, -1, -1):
+        chain, s = chain
+        if s != str(i):
+            return False
+    return chain is None and all(w == [i, {i: str(i)}] for i, w in enumerate(wide))
+
+gc.mark_threads(4)
+print(gc.mark_threads())
+data = build(3000)
+for i in range(5):
+    garbage = [build(10) for _ in range(20)]
+    garbage = None
+    gc.collect()
+print(check(data, 3000))
+
+gc.mark_threads(1)
+try:
+    gc.mark_threads(0)
+except ValueError:
+    print('ValueError')